@@ -1813,9 +1813,12 @@ int main(int argc,char **argv) {
   setlocale(LC_ALL, "");      // enable multilanguage errors in file chooser
   setlocale(LC_NUMERIC, "C"); // make sure numeric values are written correctly
 
-  if (!Fl::args(argc,argv,i,arg) || i < argc-1) {
+  if (!Fl::args(argc,argv,i,arg) || (i < argc-1 && (!batch_mode
+        || (code_file_set && *code_file_name != '.')
+        || (header_file_set && *header_file_name != '.')))) {
     static const char *msg =
       "usage: %s <switches> name.fl\n"
+      "       %s <switches> -c[s]|-u name.fl ...\n"
       " -u : update .fl file and exit (may be combined with '-c' or '-cs')\n"
       " -c : write .cxx and .h and exit\n"
       " -cs : write .cxx and .h and strings and exit\n"
@@ -1863,17 +1866,29 @@ int main(int argc,char **argv) {
   }
   undo_resume();
 
-  if (update_file) {            // fluid -u
-    write_file(c,0);
-    if (!compile_file)
+  // In batch mode, write the files and continue with the next .fl file
+  while (batch_mode) {
+    if (update_file)            // fluid -u
+      write_file(c,0);
+    if (compile_file) {         // fluid -c[s]
+      if (compile_strings)
+        write_strings_cb(0,0);
+      write_cb(0,0);
+    }
+    if (++i >= argc)
       exit(0);
-  }
-
-  if (compile_file) {           // fluid -c[s]
-    if (compile_strings)
-      write_strings_cb(0,0);
-    write_cb(0,0);
-    exit(0);
+    c = argv[i];
+    i18n_type = 0;
+    i18n_include = i18n_function = i18n_file = i18n_set = "";
+    if (!header_file_set) header_file_name = ".h";
+    if (!code_file_set) code_file_name = ".cxx";
+    set_filename(c);
+    undo_suspend();
+    if (!read_file(c,0)) {
+      fprintf(stderr,"%s : %s\n", c, strerror(errno));
+      exit(1);
+    }
+    undo_resume();
   }
   set_modflag(0);
   undo_clear();
@@ -126,14 +126,16 @@ void undo_cb(Fl_Widget *, void *) {
 
 // Save current file to undo buffer
 void undo_checkpoint() {
-  int undo_item = main_menubar->find_index(undo_cb);
-  int redo_item = main_menubar->find_index(redo_cb);
   //  printf("undo_checkpoint(): undo_current=%d, undo_paused=%d, modflag=%d\n",
   //         undo_current, undo_paused, modflag);
 
-  // Don't checkpoint if undo_suspend() has been called...
+  // Don't checkpoint if undo_suspend() has been called, e.g. for every
+  // property while reading a file...
   if (undo_paused) return;
 
+  int undo_item = main_menubar->find_index(undo_cb);
+  int redo_item = main_menubar->find_index(redo_cb);
+
   // Save the current UI to a checkpoint file...
   const char *filename = undo_filename(undo_current);
   if (!write_file(filename)) {
@@ -1605,9 +1605,120 @@ void Fl::do_widget_deletion() {
 }
 
 
-static Fl_Widget ***widget_watch = 0;
-static int num_widget_watch = 0;
-static int max_widget_watch = 0;
+// The widget watch list is kept in two hash tables of the same size.
+// Each entry is in the chain of its pointer address, so that watching and
+// releasing a pointer take constant time. The pointers of
+// Fl_Widget_Tracker's (and of Fl_Recording_Surface::cache()) point to the
+// same widget until it is deleted: their entries are also in the chain of
+// that widget, so that clear_widget_pointer() only visits the watchers of
+// the deleted widget, e.g. when a window with many widgets is deleted while
+// many trackers are alive. Pointers watched with Fl::watch_widget_pointer()
+// can be changed at any time, so their entries are kept in a list that
+// clear_widget_pointer() always checks.
+
+struct Fl_Widget_Watch {
+  Fl_Widget **wp;                       // the watched pointer
+  Fl_Widget *w;                         // the widget of a fixed pointer, or NULL
+  Fl_Widget_Watch *wp_next;             // next entry in the chain of wp
+  Fl_Widget_Watch *w_next;              // next entry in the chain of w or the list
+  Fl_Widget_Watch **w_prev;             // link to this entry, NULL if unlinked
+};
+
+static Fl_Widget_Watch **watch_by_wp = 0;
+static Fl_Widget_Watch **watch_by_w = 0;
+static Fl_Widget_Watch *watch_changing = 0; // pointers that can be changed
+static Fl_Widget_Watch *free_widget_watch = 0;
+static unsigned int num_widget_watch = 0;
+static unsigned int max_widget_watch = 0; // size of the tables, a power of 2
+
+static inline unsigned int watch_hash(const void *p) {
+  fl_uintptr_t u = (fl_uintptr_t)p;
+  return (unsigned int)(u ^ (u >> 12)) * 2654435761U;
+}
+
+static inline Fl_Widget_Watch **watch_wp_bucket(Fl_Widget **wp) {
+  return watch_by_wp + (watch_hash(wp) >> 8 & (max_widget_watch - 1));
+}
+
+static inline Fl_Widget_Watch **watch_w_bucket(const Fl_Widget *w) {
+  return watch_by_w + (watch_hash(w) >> 8 & (max_widget_watch - 1));
+}
+
+static void watch_w_link(Fl_Widget_Watch *e, Fl_Widget_Watch **b) {
+  e->w_next = *b;
+  if (*b) (*b)->w_prev = &e->w_next;
+  e->w_prev = b;
+  *b = e;
+}
+
+static void watch_w_unlink(Fl_Widget_Watch *e) {
+  *e->w_prev = e->w_next;
+  if (e->w_next) e->w_next->w_prev = e->w_prev;
+  e->w_prev = 0;
+  e->w = 0;
+}
+
+// Doubles the size of the hash tables and moves all entries.
+static void watch_grow() {
+  unsigned int old_max = max_widget_watch;
+  Fl_Widget_Watch **old_wp = watch_by_wp;
+  max_widget_watch = old_max ? 2 * old_max : 16;
+  watch_by_wp = (Fl_Widget_Watch **)calloc(max_widget_watch, sizeof(Fl_Widget_Watch *));
+  free(watch_by_w);
+  watch_by_w = (Fl_Widget_Watch **)calloc(max_widget_watch, sizeof(Fl_Widget_Watch *));
+  for (unsigned int i = 0; i < old_max; i++) {
+    Fl_Widget_Watch *e, *next;
+    for (e = old_wp[i]; e; e = next) {
+      next = e->wp_next;
+      Fl_Widget_Watch **b = watch_wp_bucket(e->wp);
+      e->wp_next = *b;
+      *b = e;
+      if (e->w) watch_w_link(e, watch_w_bucket(e->w));
+    }
+  }
+  free(old_wp);
+}
+
+// Adds wp to the watch list. If fixed is set, *wp isn't changed while it
+// is watched, except by clear_widget_pointer().
+static void watch_pointer(Fl_Widget **wp, int fixed)
+{
+  Fl_Widget_Watch *e;
+  if (max_widget_watch) {
+    for (e = *watch_wp_bucket(wp); e; e = e->wp_next) {
+      if (e->wp==wp) return;
+    }
+  }
+  if (num_widget_watch==max_widget_watch) watch_grow();
+  if ((e = free_widget_watch) != 0) free_widget_watch = e->wp_next;
+  else e = (Fl_Widget_Watch *)malloc(sizeof(Fl_Widget_Watch));
+  Fl_Widget_Watch **b = watch_wp_bucket(wp);
+  e->wp = wp;
+  e->wp_next = *b;
+  *b = e;
+  e->w = 0;
+  e->w_prev = 0;
+  if (!fixed)
+    watch_w_link(e, &watch_changing);
+  else if (*wp) {
+    e->w = *wp;
+    watch_w_link(e, watch_w_bucket(e->w));
+  }
+  num_widget_watch++;
+#ifdef DEBUG_WATCH
+  printf ("\nwatch_widget_pointer:   (%d/%d) %8p => %8p\n",
+    num_widget_watch,num_widget_watch,wp,*wp);
+  fflush(stdout);
+#endif // DEBUG_WATCH
+}
+
+// Same as Fl::watch_widget_pointer(), for a pointer that is not changed
+// while it is watched, except by Fl::clear_widget_pointer(). Used by
+// Fl_Widget_Tracker and Fl_Recording_Surface::cache().
+void fl_watch_fixed_widget_pointer(Fl_Widget *&w)
+{
+  watch_pointer(&w, 1);
+}
 
 
 /**
@@ -1657,21 +1768,7 @@ static int max_widget_watch = 0;
 */
 void Fl::watch_widget_pointer(Fl_Widget *&w)
 {
-  Fl_Widget **wp = &w;
-  int i;
-  for (i=0; i<num_widget_watch; ++i) {
-    if (widget_watch[i]==wp) return;
-  }
-  if (num_widget_watch==max_widget_watch) {
-    max_widget_watch += 8;
-    widget_watch = (Fl_Widget***)realloc(widget_watch, sizeof(Fl_Widget**)*max_widget_watch);
-  }
-  widget_watch[num_widget_watch++] = wp;
-#ifdef DEBUG_WATCH
-  printf ("\nwatch_widget_pointer:   (%d/%d) %8p => %8p\n",
-    num_widget_watch,num_widget_watch,wp,*wp);
-  fflush(stdout);
-#endif // DEBUG_WATCH
+  watch_pointer(&w, 0);
 }
 
 
@@ -1688,20 +1785,22 @@ void Fl::watch_widget_pointer(Fl_Widget *&w)
 void Fl::release_widget_pointer(Fl_Widget *&w)
 {
   Fl_Widget **wp = &w;
-  int i,j=0;
-  for (i=0; i<num_widget_watch; ++i) {
-    if (widget_watch[i]!=wp) {
-      if (j<i) widget_watch[j] = widget_watch[i]; // fill gap
-      j++;
-    }
+  if (!num_widget_watch) return;
+  Fl_Widget_Watch *e, **ep;
+  for (ep = watch_wp_bucket(wp); (e = *ep) != 0; ep = &e->wp_next) {
+    if (e->wp==wp) { // found widget pointer
 #ifdef DEBUG_WATCH
-    else { // found widget pointer
-      printf("release_widget_pointer: (%d/%d) %8p => %8p\n",
-             i+1, num_widget_watch, wp, *wp);
-    }
+      printf("release_widget_pointer: (%d) %8p => %8p\n",
+             num_widget_watch, wp, *wp);
 #endif //DEBUG_WATCH
+      *ep = e->wp_next;
+      if (e->w_prev) watch_w_unlink(e);
+      e->wp_next = free_widget_watch;
+      free_widget_watch = e;
+      num_widget_watch--;
+      break;
+    }
   }
-  num_widget_watch = j;
 #ifdef DEBUG_WATCH
   printf ("                        num_widget_watch = %d\n\n",num_widget_watch);
   fflush(stdout);
@@ -1718,7 +1817,7 @@ void Fl::release_widget_pointer(Fl_Widget *&w)
 
   \note Internal use only !
 
-  This method searches the widget watch list for pointers to the widget and
+  This method looks up the pointers to the widget in the widget watch list and
   clears each pointer that points to it. Widget pointers can be added to the
   widget watch list by calling Fl::watch_widget_pointer() or by using the
   helper class Fl_Widget_Tracker (recommended).
@@ -1728,13 +1827,18 @@ void Fl::release_widget_pointer(Fl_Widget *&w)
 */
 void Fl::clear_widget_pointer(Fl_Widget const *w)
 {
-  if (w==0L) return;
-  int i;
-  for (i=0; i<num_widget_watch; ++i) {
-    if (widget_watch[i] && *widget_watch[i]==w) {
-      *widget_watch[i] = 0L;
+  if (w==0L || !num_widget_watch) return;
+  Fl_Widget_Watch *e, *next;
+  for (e = *watch_w_bucket(w); e; e = next) {
+    next = e->w_next;
+    if (e->w==w) {
+      watch_w_unlink(e);
+      if (*e->wp==w) *e->wp = 0L;
     }
   }
+  for (e = watch_changing; e; e = e->w_next) {
+    if (*e->wp==w) *e->wp = 0L;
+  }
 }
 
 
@@ -1865,7 +1969,7 @@ void Fl::option(Fl_Option opt, bool val)
 Fl_Widget_Tracker::Fl_Widget_Tracker(Fl_Widget *wi)
 {
   wp_ = wi;
-  Fl::watch_widget_pointer(wp_); // add pointer to watch list
+  fl_watch_fixed_widget_pointer(wp_); // add pointer to watch list
 }
 
 /**
@@ -2048,6 +2152,47 @@ int Fl::get_font_sizes(Fl_Font fnum, int*& sizep) {
   return Fl_Graphics_Driver::default_driver().get_font_sizes(fnum, sizep);
 }
 
+/** Prepares a font so that the first fl_font() call using it is fast.
+ The font is opened, and under X11 with Xft the glyphs of the ASCII
+ characters are loaded, without changing the current font.
+ Call this at program startup or in an idle callback (see Fl::add_idle())
+ for the faces and sizes you will use, so that this work is not done
+ while drawing.
+ \see Fl::font_cache_size(int)
+ */
+void Fl::preload_font(Fl_Font face, Fl_Fontsize size) {
+  Fl_Graphics_Driver::default_driver().preload_font(face, size);
+}
+
+/** Sets how many fonts can stay open at once.
+ Under X11 with Xft, the least recently selected fonts beyond this number
+ are closed, and they are opened again when they are used. A value of 0
+ or less keeps all fonts open. The default is 128.
+ This has no effect on other platforms.
+ */
+void Fl::font_cache_size(int n) {
+  Fl_Graphics_Driver::default_driver().font_cache_size(n);
+}
+
+/** Returns how many fonts can stay open at once, or 0 if there is no limit.
+ \see Fl::font_cache_size(int)
+ */
+int Fl::font_cache_size() {
+  return Fl_Graphics_Driver::default_driver().font_cache_size();
+}
+
+/** Gets the counters of the cache of shaped text.
+ Under X11 with Pango, the layouts of the most recently measured or drawn
+ strings are kept for each font and size, so that drawing the same text
+ again doesn't shape it again. \p hits receives the number of strings
+ found in this cache and \p misses the number of strings that had to be
+ shaped, since program start.
+ \return 0 and both counters set to 0 if the platform has no such cache.
+ */
+int Fl::text_layout_cache_stats(unsigned long *hits, unsigned long *misses) {
+  return Fl_Graphics_Driver::default_driver().text_layout_cache_stats(hits, misses);
+}
+
 /** Current value of the GUI scaling factor for screen number \p n */
 float Fl::screen_scale(int n) {
   if (!Fl::screen_scaling_supported() || n < 0 || n >= Fl::screen_count()) return 1.;
@@ -22,6 +22,8 @@
 #include <FL/Fl_Browser_.H>
 #include <FL/fl_draw.H>
 
+extern int fl_box_flat_inside(Fl_Boxtype); // in fl_boxtype.cxx
+
 
 // This is the base class for browsers.  To be useful it must be
 // subclassed and several virtual functions defined.  The
@@ -124,7 +126,7 @@ void Fl_Browser_::resize(int X, int Y, int W, int H) {
 void Fl_Browser_::redraw_line(void* item) {
   if (!redraw1 || redraw1 == item) {redraw1 = item; damage(FL_DAMAGE_EXPOSE);}
   else if (!redraw2 || redraw2 == item) {redraw2 = item; damage(FL_DAMAGE_EXPOSE);}
-  else damage(FL_DAMAGE_SCROLL);
+  else redraw_lines();
 }
 
 // Figure out top() based on position():
@@ -195,7 +197,7 @@ void Fl_Browser_::position(int pos) {
   if (pos < 0) pos = 0;
   if (pos == position_) return;
   position_ = pos;
-  if (pos != real_position_) redraw_lines();
+  if (pos != real_position_) damage(FL_DAMAGE_SCROLL);
 }
 
 /**
@@ -210,7 +212,7 @@ void Fl_Browser_::hposition(int pos) {
   if (pos < 0) pos = 0;
   if (pos == hposition_) return;
   hposition_ = pos;
-  if (pos != real_hposition_) redraw_lines();
+  if (pos != real_hposition_) damage(FL_DAMAGE_SCROLL);
 }
 
 // Tell whether item is currently displayed:
@@ -330,6 +332,7 @@ void Fl_Browser_::draw() {
   int full_width_ = full_width();
   int full_height_ = full_height();
   int X, Y, W, H; bbox(X, Y, W, H);
+  int X0 = X, Y0 = Y, W0 = W, H0 = H, drawn_hposition = real_hposition_;
   int dont_repeat = 0;
 J1:
   if (damage() & FL_DAMAGE_ALL) { // redraw the box if full redraw
@@ -389,6 +392,13 @@ J1:
   bbox(X, Y, W, H);
 
   fl_push_clip(X, Y, W, H);
+  // if the list was only scrolled, move the lines that are still visible
+  // and draw the others:
+  int scrolled = 0, moved;
+  if ((damage() & (FL_DAMAGE_ALL|FL_DAMAGE_SCROLL)) == FL_DAMAGE_SCROLL && !lines_changed_ &&
+      X == X0 && Y == Y0 && W == W0 && H == H0 &&
+      fl_box_flat_inside(box() ? box() : FL_DOWN_BOX) && lines_moved(H, moved))
+    scrolled = fl_scroll_by_copy(X, Y, W, H, drawn_hposition - hposition_, moved, draw_clip, this);
   // for each line, draw it if full redraw or scrolled.  Erase background
   // if not a full redraw or if it is selected:
   void* l = top();
@@ -396,7 +406,7 @@ J1:
   for (; l && yy < H; l = item_next(l)) {
     int hh = item_height(l);
     if (hh <= 0) continue;
-    if ((damage()&(FL_DAMAGE_SCROLL|FL_DAMAGE_ALL)) || l == redraw1 || l == redraw2) {
+    if ((!scrolled && (damage()&(FL_DAMAGE_SCROLL|FL_DAMAGE_ALL))) || l == redraw1 || l == redraw2) {
       if (item_selected(l)) {
         fl_color(active_r() ? selection_color() : fl_inactive(selection_color()));
         fl_rectf(X, yy+Y, W, hh);
@@ -416,7 +426,7 @@ J1:
     yy += hh;
   }
   // erase the area below last line:
-  if (!(damage()&FL_DAMAGE_ALL) && yy < H) {
+  if (!scrolled && !(damage()&FL_DAMAGE_ALL) && yy < H) {
     fl_push_clip(X, yy+Y, W, H-yy);
     draw_box(box() ? box() : FL_DOWN_BOX, x(), y(), w(), h(), color());
     fl_pop_clip();
@@ -474,6 +484,55 @@ J1:
   }
 
   real_hposition_ = hposition_;
+  drawn_top_ = top_;
+  drawn_offset_ = offset_;
+  lines_changed_ = 0;
+  fl_pop_clip();
+}
+
+// Finds the lines drawn last time: sets dy to how far they moved down
+// since then and returns 1, or returns 0 if they are more than a screen
+// height away or not known.
+int Fl_Browser_::lines_moved(int H, int &dy) {
+  if (!drawn_top_ || !top_) return 0;
+  int d = 0;
+  void *l;
+  for (l = top_; l && d < H + offset_; l = item_next(l)) {
+    if (l == drawn_top_) {dy = d - offset_ + drawn_offset_; return 1;}
+    d += item_height(l);
+  }
+  for (d = 0, l = item_prev(top_); l && d < H + drawn_offset_; l = item_prev(l)) {
+    d += item_height(l);
+    if (l == drawn_top_) {dy = drawn_offset_ - offset_ - d; return 1;}
+  }
+  return 0;
+}
+
+// Draws the lines in the area X,Y,W,H, see fl_scroll_by_copy():
+void Fl_Browser_::draw_clip(void *v, int X, int Y, int W, int H) {
+  Fl_Browser_ *b = (Fl_Browser_*)v;
+  int BX, BY, BW, BH; b->bbox(BX, BY, BW, BH);
+  fl_push_clip(X, Y, W, H);
+  b->draw_box(b->box() ? b->box() : FL_DOWN_BOX, b->x(), b->y(), b->w(), b->h(), b->color());
+  int yy = BY - b->offset_;
+  for (void *l = b->top_; l && yy < Y + H; l = b->item_next(l)) {
+    int hh = b->item_height(l);
+    if (hh <= 0) continue;
+    if (yy + hh > Y) {
+      if (b->item_selected(l)) {
+        fl_color(b->active_r() ? b->selection_color() : fl_inactive(b->selection_color()));
+        fl_rectf(BX, yy, BW, hh);
+      }
+      b->item_draw(l, BX-b->hposition_, yy, BW+b->hposition_, hh);
+      if (l == b->selection_ && Fl::focus() == b) {
+        b->draw_box(FL_BORDER_FRAME, BX, yy, BW, hh, b->color());
+        b->draw_focus(FL_NO_BOX, BX, yy, BW+1, hh+1);
+      }
+      int ww = b->item_width(l);
+      if (ww > b->max_width) {b->max_width = ww; b->max_width_item = l;}
+    }
+    yy += hh;
+  }
   fl_pop_clip();
 }
 
@@ -487,6 +546,7 @@ J1:
 */
 void Fl_Browser_::new_list() {
   top_ = 0;
+  drawn_top_ = 0;
   position_ = real_position_ = 0;
   hposition_ = real_hposition_ = 0;
   selection_ = 0;
@@ -506,6 +566,7 @@ void Fl_Browser_::new_list() {
   \param[in] item The item being deleted.
 */
 void Fl_Browser_::deleting(void* item) {
+  if (item == drawn_top_) drawn_top_ = 0;
   if (displayed(item)) {
     redraw_lines();
     if (item == top_) {
@@ -537,6 +598,7 @@ void Fl_Browser_::replacing(void* a, void* b) {
   redraw_line(a);
   if (a == selection_) selection_ = b;
   if (a == top_) top_ = b;
+  if (a == drawn_top_) drawn_top_ = b;
   if (a == max_width_item) {max_width_item = 0; max_width = 0;}
 }
 
@@ -555,6 +617,7 @@ void Fl_Browser_::swapping(void* a, void* b) {
   else if (b == selection_) selection_ = a;
   if (a == top_) top_ = b;
   else if (b == top_) top_ = a;
+  if (a == drawn_top_ || b == drawn_top_) drawn_top_ = 0;
 }
 
 /**
@@ -961,6 +1024,9 @@ Fl_Browser_::Fl_Browser_(int X, int Y, int W, int H, const char* L)
   hposition_ = real_hposition_ = 0;
   offset_ = 0;
   top_ = 0;
+  drawn_top_ = 0;
+  drawn_offset_ = 0;
+  lines_changed_ = 1;
   when(FL_WHEN_RELEASE_ALWAYS);
   selection_ = 0;
   color(FL_BACKGROUND2_COLOR, FL_SELECTION_COLOR);
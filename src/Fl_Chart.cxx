@@ -164,6 +164,91 @@ static void draw_linechart(int type, int x,int y,int w,int h,
               entries[i].val>=0 ? FL_ALIGN_BOTTOM : FL_ALIGN_TOP);
 }
 
+/* Per pixel column data of a decimated line chart */
+struct Fl_Chart_Column {
+  int n;                        /* number of entries in the column */
+  float lo, hi;                 /* smallest and largest value */
+  float first, last;            /* first and last value */
+  unsigned col;                 /* color of the last entry */
+};
+
+static void draw_decimated(int type, int x,int y,int w,int h,
+                           int numb, FL_CHART_ENTRY entries[], int first,
+                           double min, double max, int autosize, int maxnumb,
+                           Fl_Color textcolor)
+/* Draws a line chart with more entries than pixel columns. The entries are
+   stored in a ring buffer starting at index first. Only the range of values
+   of each column is drawn, so that the drawing cost depends on the width of
+   the chart, not on the number of entries. */
+{
+  int i, k, c;
+  double lh = fl_height();
+  double incr;
+  if (max == min) incr = h-2.0*lh;
+  else incr = (h-2.0*lh)/ (max-min);
+  int zeroh = (int)rint(y+h-lh+min * incr);
+  double bwidth = w/double(autosize?numb:maxnumb);
+  Fl_Chart_Column *cols = (Fl_Chart_Column *)calloc(w + 1, sizeof(Fl_Chart_Column));
+  if (!cols) return;
+  /* Compute the range of each column */
+  for (i=0, k=first; i<numb; i++, k++) {
+      if (k >= numb) k = 0;
+      float v = entries[k].val;
+      c = (int)rint((i+.5)*bwidth);
+      if (c < 0) c = 0;
+      else if (c > w) c = w;
+      Fl_Chart_Column &cc = cols[c];
+      if (!cc.n++) {
+          cc.lo = cc.hi = cc.first = v;
+      } else if (v < cc.lo) cc.lo = v;
+      else if (v > cc.hi) cc.hi = v;
+      cc.last = v;
+      cc.col = entries[k].col;
+  }
+  /* Draw the values */
+  int prevx = 0, prevy = 0, prev = 0;
+  unsigned prevcol = 0;
+  for (c=0; c<=w; c++) {
+      Fl_Chart_Column &cc = cols[c];
+      if (!cc.n) continue;
+      int xc = x + c;
+      int ylo = zeroh - (int)rint(cc.lo*incr);
+      int yhi = zeroh - (int)rint(cc.hi*incr);
+      if (type == FL_LINE_CHART) {
+          if (prev) {
+              fl_color((Fl_Color)prevcol);
+              fl_line(prevx, prevy, xc, zeroh - (int)rint(cc.first*incr));
+          }
+          fl_color((Fl_Color)cc.col);
+          if (ylo != yhi) fl_line(xc, ylo, xc, yhi);
+      } else {
+          fl_color((Fl_Color)cc.col);
+          fl_line(xc, cc.lo < 0.0 ? ylo : zeroh, xc, cc.hi > 0.0 ? yhi : zeroh);
+          if (type == FL_FILLED_CHART) {
+              fl_color(textcolor);
+              if (prev) fl_line(prevx, prevy, xc, zeroh - (int)rint(cc.first*incr));
+              if (ylo != yhi) fl_line(xc, ylo, xc, yhi);
+          }
+      }
+      prev = 1;
+      prevx = xc;
+      prevy = zeroh - (int)rint(cc.last*incr);
+      prevcol = cc.col;
+  }
+  free(cols);
+  /* Draw base line */
+  fl_color(textcolor);
+  fl_line(x,zeroh,x+w,zeroh);
+  /* Draw the labels */
+  for (i=0, k=first; i<numb; i++, k++) {
+      if (k >= numb) k = 0;
+      if (!entries[k].str[0]) continue;
+      fl_draw(entries[k].str,
+              x+(int)rint((i+.5)*bwidth), zeroh - (int)rint(entries[k].val*incr),0,0,
+              entries[k].val>=0 ? FL_ALIGN_BOTTOM : FL_ALIGN_TOP);
+  }
+}
+
 static void draw_piechart(int x,int y,int w,int h,
                           int numb, FL_CHART_ENTRY entries[], int special,
                           Fl_Color textcolor)
@@ -241,7 +326,18 @@ void Fl_Chart::draw() {
 
     fl_font(textfont(),textsize());
 
-    switch (type()) {
+    int t = type();
+    if ((t == FL_LINE_CHART || t == FL_FILLED_CHART || t == FL_SPIKE_CHART) &&
+        (autosize() ? numb : maxnumb) > ww) {
+        draw_decimated(t,xx,yy,ww,hh, numb, entries, firstnumb, min, max,
+                        autosize(), maxnumb, textcolor());
+        draw_label();
+        fl_pop_clip();
+        return;
+    }
+    unwrap();
+
+    switch (t) {
     case FL_BAR_CHART:
         ww++; // makes the bars fill box correctly
         draw_barchart(xx,yy,ww,hh, numb, entries, min, max,
@@ -287,6 +383,7 @@ Fl_Widget(X,Y,W,H,L) {
   numb       = 0;
   maxnumb    = 0;
   sizenumb   = FL_CHART_MAX;
+  firstnumb  = 0;
   autosize_  = 1;
   min = max  = 0;
   textfont_  = FL_HELVETICA;
@@ -307,36 +404,88 @@ Fl_Chart::~Fl_Chart() {
  */
 void Fl_Chart::clear() {
   numb = 0;
+  firstnumb = 0;
   min = max = 0;
   redraw();
 }
 
+/*
+  Returns the entry receiving a value added at the end of the chart.
+  The array grows geometrically. When the chart holds maxsize() values
+  the oldest entry is reused: the entries then form a ring buffer
+  starting at index firstnumb.
+ */
+FL_CHART_ENTRY *Fl_Chart::new_entry() {
+  if (maxnumb > 0 && numb >= maxnumb) {
+    FL_CHART_ENTRY *e = entries + firstnumb;
+    if (++firstnumb >= numb) firstnumb = 0;
+    return e;
+  }
+  /* Allocate more entries if required */
+  if (numb >= sizenumb) {
+    sizenumb *= 2;
+    if (maxnumb > 0 && sizenumb > maxnumb) sizenumb = maxnumb;
+    entries = (FL_CHART_ENTRY *)realloc(entries, sizeof(FL_CHART_ENTRY) * (sizenumb + 1));
+  }
+  return entries + numb++;
+}
+
+/*
+  Rotates the ring buffer so that the oldest entry is at index 0.
+ */
+void Fl_Chart::unwrap() {
+  if (!firstnumb) return;
+  FL_CHART_ENTRY t;
+  int i, j;
+  for (i = 0, j = firstnumb - 1; i < j; i++, j--) { t = entries[i]; entries[i] = entries[j]; entries[j] = t; }
+  for (i = firstnumb, j = numb - 1; i < j; i++, j--) { t = entries[i]; entries[i] = entries[j]; entries[j] = t; }
+  for (i = 0, j = numb - 1; i < j; i++, j--) { t = entries[i]; entries[i] = entries[j]; entries[j] = t; }
+  firstnumb = 0;
+}
+
 /**
   Add the data value \p val with optional label \p str and color \p col
   to the chart.
+  If the chart holds maxsize() values, the first value is removed.
+  This takes constant time.
   \param[in] val data value
   \param[in] str optional data label
   \param[in] col optional data color
  */
 void Fl_Chart::add(double val, const char *str, unsigned col) {
-  /* Allocate more entries if required */
-  if (numb >= sizenumb) {
-    sizenumb += FL_CHART_MAX;
-    entries = (FL_CHART_ENTRY *)realloc(entries, sizeof(FL_CHART_ENTRY) * (sizenumb + 1));
+  FL_CHART_ENTRY *e = new_entry();
+  e->val = float(val);
+  e->col = col;
+  if (str) {
+      strlcpy(e->str,str,FL_CHART_LABEL_MAX + 1);
+  } else {
+      e->str[0] = 0;
   }
-  // Shift entries as needed
-  if (numb >= maxnumb && maxnumb > 0) {
-    memmove(entries, entries + 1, sizeof(FL_CHART_ENTRY) * (numb - 1));
-    numb --;
+  redraw();
+}
+
+/**
+  Adds the \p n data values \p vals without labels to the chart.
+  This is equivalent to calling add(vals[i], 0, col) for each value,
+  but the chart is redrawn only once. If the chart holds maxsize()
+  values, only the last values are kept.
+  \param[in] vals array of data values
+  \param[in] n number of data values
+  \param[in] col optional data color
+  \see add(double, const char*, unsigned)
+ */
+void Fl_Chart::add_values(const double *vals, int n, unsigned col) {
+  if (n <= 0) return;
+  if (maxnumb > 0 && n > maxnumb) {
+    vals += n - maxnumb;
+    n = maxnumb;
+  }
+  for (int i = 0; i < n; i++) {
+    FL_CHART_ENTRY *e = new_entry();
+    e->val = float(vals[i]);
+    e->col = col;
+    e->str[0] = 0;
   }
-  entries[numb].val = float(val);
-  entries[numb].col = col;
-    if (str) {
-        strlcpy(entries[numb].str,str,FL_CHART_LABEL_MAX + 1);
-    } else {
-        entries[numb].str[0] = 0;
-    }
-  numb++;
   redraw();
 }
 
@@ -351,9 +500,10 @@ void Fl_Chart::add(double val, const char *str, unsigned col) {
 void Fl_Chart::insert(int ind, double val, const char *str, unsigned col) {
   int i;
   if (ind < 1 || ind > numb+1) return;
+  unwrap();
   /* Allocate more entries if required */
   if (numb >= sizenumb) {
-    sizenumb += FL_CHART_MAX;
+    sizenumb *= 2;
     entries = (FL_CHART_ENTRY *)realloc(entries, sizeof(FL_CHART_ENTRY) * (sizenumb + 1));
   }
   // Shift entries as needed
@@ -380,12 +530,14 @@ void Fl_Chart::insert(int ind, double val, const char *str, unsigned col) {
  */
 void Fl_Chart::replace(int ind,double val, const char *str, unsigned col) {
   if (ind < 1 || ind > numb) return;
-  entries[ind-1].val = float(val);
-  entries[ind-1].col = col;
+  int k = firstnumb + ind - 1;
+  if (k >= numb) k -= numb;
+  entries[k].val = float(val);
+  entries[k].col = col;
   if (str) {
-      strlcpy(entries[ind-1].str,str,FL_CHART_LABEL_MAX+1);
+      strlcpy(entries[k].str,str,FL_CHART_LABEL_MAX+1);
   } else {
-      entries[ind-1].str[0] = 0;
+      entries[k].str[0] = 0;
   }
   redraw();
 }
@@ -410,6 +562,7 @@ void Fl_Chart::maxsize(int m) {
   int i;
   /* Fill in the new number */
   if (m < 0) return;
+  unwrap();
   maxnumb = m;
   /* Shift entries if required */
   if (numb > maxnumb) {
@@ -72,6 +72,21 @@ void Fl_Double_Window::flush()
 }
 
 
+/**
+ Returns the number of bytes the last flush() copied from the back buffer
+ to the window.
+ Only the damaged part of the window is copied, so this shows how much
+ of the window a redraw really updated, e.g. when a few small widgets of a
+ large window change often. The value is computed on the X11 platform only
+ and is 0 on other platforms.
+ \version 1.4.0
+ */
+unsigned long Fl_Double_Window::copied_bytes() const
+{
+  return Fl_Window_Driver::driver(this)->other_copied;
+}
+
+
 /**
   The destructor <I>also deletes all the children</I>. This allows a
   whole tree to be deleted at once, without having to keep a pointer to
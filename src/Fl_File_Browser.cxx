@@ -22,6 +22,8 @@
 //   Fl_File_Browser::item_draw()       - Draw a list item.
 //   Fl_File_Browser::Fl_File_Browser() - Create a Fl_File_Browser widget.
 //   Fl_File_Browser::load()            - Load a directory into the browser.
+//   Fl_File_Browser::load_async()      - Load a directory in the background.
+//   Fl_File_Browser::cache_size()      - Set the size of the listing cache.
 //   Fl_File_Browser::filter()          - Set the filename filter.
 //
 
@@ -36,8 +38,11 @@
 #include <FL/filename.H>
 #include <FL/fl_string.h>
 #include <FL/Fl_Image.H>        // icon
+#include <FL/fl_utf8.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
+#include <sys/stat.h>
 #include "flstring.h"
 
 //
@@ -372,11 +377,15 @@ Fl_File_Browser::Fl_File_Browser(int        X,  // I - Upper-lefthand X coordina
   iconsize_  = (uchar)(3 * textsize() / 2);
   filetype_  = FILES;
   errmsg_    = NULL;
+  listing_   = NULL;
+  loaded_    = 0;
+  num_dirs_  = 0;
 }
 
 
 // DTOR
 Fl_File_Browser::~Fl_File_Browser() {
+  stop_load();
   errmsg(NULL);       // free()s prev errmsg, if any
 }
 
@@ -392,6 +401,173 @@ void Fl_File_Browser::errmsg(const char* emsg) {
 }
 
 
+//
+// Directory listings...
+//
+// A directory is read into a Fl_File_Listing, which holds the sorted
+// names and the file types that are already known from readdir().
+// Complete listings are kept in a small cache, most recently used first,
+// and are reused until the modification time of the directory changes,
+// so opening the same directory again needs a single stat() call.
+//
+
+struct Fl_File_Listing {
+  Fl_File_Listing *next;        // Next listing in the cache
+  char          *directory;     // Directory name
+  Fl_File_Sort_F *sort;         // Sort function of the names
+  time_t        mtime;          // Modification time of the directory
+  int           cacheable;      // Can the listing be cached once loaded?
+  int           refs;           // Number of users (cache and browsers)
+  int           count;          // Number of names
+  char          **names;        // Names, directories end with '/'
+  char          *text;          // Storage for the names
+  uchar         *types;         // Fl_File_Icon types, ANY if unknown
+};
+
+static Fl_File_Listing *listing_cache = 0;      // Cached listings
+static int listing_cache_size = 4;              // Maximum number of listings
+
+// Number of entries load_async() adds in each idle callback
+static const int LOAD_BATCH = 256;
+
+static void release_listing(Fl_File_Listing *l) {
+  if (--l->refs > 0)
+    return;
+  free(l->directory);
+  free(l->names);
+  free(l->text);
+  free(l->types);
+  delete l;
+}
+
+// Removes the cached listings beyond the first n from the cache.
+static void trim_listing_cache(int n) {
+  Fl_File_Listing **p = &listing_cache;
+  while (*p && n-- > 0)
+    p = &(*p)->next;
+  while (*p) {
+    Fl_File_Listing *l = *p;
+    *p = l->next;
+    release_listing(l);
+  }
+}
+
+// Adds a completely loaded listing to the cache, replacing an older
+// listing of the same directory.
+static void cache_listing(Fl_File_Listing *l) {
+  Fl_File_Listing **p;
+  if (!l->cacheable || listing_cache_size <= 0)
+    return;
+  for (p = &listing_cache; *p; p = &(*p)->next) {
+    if (*p == l)
+      return;
+    if ((*p)->sort == l->sort && !strcmp((*p)->directory, l->directory)) {
+      Fl_File_Listing *old = *p;
+      *p = old->next;
+      release_listing(old);
+      break;
+    }
+  }
+  l->refs ++;
+  l->next = listing_cache;
+  listing_cache = l;
+  trim_listing_cache(listing_cache_size);
+}
+
+// Returns the type of a directory entry if it is known without a stat().
+static uchar entry_type(dirent *de) {
+  size_t len = strlen(de->d_name);
+  if (len && de->d_name[len - 1] == '/')
+    return Fl_File_Icon::DIRECTORY;
+#if defined(DT_REG) && defined(DT_FIFO) && defined(DT_CHR) && defined(DT_BLK)
+  switch (de->d_type) {
+    case DT_REG :
+      return Fl_File_Icon::PLAIN;
+    case DT_FIFO :
+      return Fl_File_Icon::FIFO;
+    case DT_CHR :
+    case DT_BLK :
+      return Fl_File_Icon::DEVICE;
+    default : // links and unknown types need a stat()
+      break;
+  }
+#endif // DT_REG && DT_FIFO && DT_CHR && DT_BLK
+  return Fl_File_Icon::ANY;
+}
+
+// Returns the listing of a directory from the cache, or reads it.
+// Returns NULL and the error of fl_filename_list() in num_files and
+// emsg if the directory can't be read.
+static Fl_File_Listing *get_listing(const char *directory,
+                                    Fl_File_Sort_F *sort,
+                                    int *num_files,
+                                    char *emsg, int emsg_sz) {
+  Fl_File_Listing **p, *l;
+  struct stat   st;
+  char          filename[4096];
+  dirent        **files;
+  int           i, n, size;
+
+  // A listing can be reused as long as the directory is not modified.
+  // The time is only accurate to the second, so a directory that was
+  // modified in the last seconds is read again the next time.
+  int have_mtime = (fl_stat(directory, &st) == 0);
+  time_t now = time(NULL);
+
+  if (have_mtime) {
+    for (p = &listing_cache; (l = *p) != NULL; p = &l->next) {
+      if (l->sort != sort || strcmp(l->directory, directory))
+        continue;
+      *p = l->next;
+      if (l->mtime != st.st_mtime) {
+        release_listing(l);
+        break;
+      }
+      l->next = listing_cache;
+      listing_cache = l;
+      l->refs ++;
+      *num_files = l->count;
+      return l;
+    }
+  }
+
+  n = Fl::system_driver()->file_browser_load_directory(directory,
+                                                       filename, sizeof(filename),
+                                                       &files, sort,
+                                                       emsg, emsg_sz);
+  *num_files = n;
+  if (n <= 0)
+    return NULL;
+
+  l = new Fl_File_Listing;
+  l->next      = NULL;
+  l->directory = fl_strdup(directory);
+  l->sort      = sort;
+  l->mtime     = have_mtime ? st.st_mtime : 0;
+  l->cacheable = have_mtime && st.st_mtime < now - 1;
+  l->refs      = 1;
+  l->count     = n;
+  l->names     = (char **)malloc(n * sizeof(char *));
+  l->types     = (uchar *)malloc(n);
+
+  for (i = 0, size = 0; i < n; i ++)
+    size += (int)strlen(files[i]->d_name) + 1;
+  l->text = (char *)malloc(size);
+
+  for (i = 0, size = 0; i < n; i ++) {
+    int len = (int)strlen(files[i]->d_name) + 1;
+    l->names[i] = l->text + size;
+    memcpy(l->names[i], files[i]->d_name, len);
+    l->types[i] = entry_type(files[i]);
+    size += len;
+    free(files[i]);
+  }
+  free(files);
+
+  return l;
+}
+
+
 /**
   Loads the specified directory into the browser. If icons have been
   loaded then the correct icon is associated with each file in the list.
@@ -402,19 +578,74 @@ void Fl_File_Browser::errmsg(const char* emsg) {
   The sort argument specifies a sort function to be used with
   fl_filename_list().
 
+  Directory listings are cached, see cache_size(), and the file types
+  that readdir() reports are used to avoid a stat() call per file where
+  possible.
+
   Return value is the number of filename entries, or 0 if none.
   On error, 0 is returned, and errmsg() has OS error string if non-NULL.
+
+  \see load_async()
 */
 int                                             // O - Number of files loaded
 Fl_File_Browser::load(const char     *directory,// I - Directory to load
                       Fl_File_Sort_F *sort)     // I - Sort function to use
 {
-  int           i;                              // Looping var
+  int num_files = start_load(directory, sort);
+
+  if (listing_)
+    load_entries(listing_->count);
+
+  return (num_files);
+}
+
+
+/**
+  Loads the specified directory into the browser in the background.
+
+  This works like load(), but only reads and sorts the list of names
+  before it returns, which still takes as long as with load(). The
+  entries are then added to the browser from an idle callback in
+  batches while the application keeps handling events, so the work done
+  for each entry - finding its file type and icon, which may need a
+  stat() of the file, and filtering it - no longer blocks the
+  application. Directories are inserted in front of the files as with
+  load().
+
+  The loading stops when the browser is destroyed, or when load() or
+  load_async() is called again. loading() returns non-zero until the
+  last entry was added.
+
+  \return the number of filename entries that will be loaded, or 0 if none
+  \see load(), loading()
+*/
+int
+Fl_File_Browser::load_async(const char     *directory,
+                            Fl_File_Sort_F *sort)
+{
+  int num_files = start_load(directory, sort);
+
+  if (listing_) {
+    load_entries(LOAD_BATCH);
+    if (listing_)
+      Fl::add_idle(load_idle_cb, this);
+  }
+
+  return (num_files);
+}
+
+
+// Clears the browser and gets the listing of the directory into
+// listing_, or lists the file systems if directory is "".
+int
+Fl_File_Browser::start_load(const char     *directory,
+                            Fl_File_Sort_F *sort)
+{
   int           num_files;                      // Number of files in directory
-  int           num_dirs;                       // Number of directories in list
   char          filename[4096];                 // Current file
   Fl_File_Icon  *icon;                          // Icon to use
 
+  stop_load();
   errmsg(NULL); // clear errors first
 
 //  printf("Fl_File_Browser::load(\"%s\")\n", directory);
@@ -437,43 +668,114 @@ Fl_File_Browser::load(const char     *directory,// I - Directory to load
       icon = Fl_File_Icon::find("any", Fl_File_Icon::DIRECTORY);
     num_files = Fl::system_driver()->file_browser_load_filesystem(this, filename, (int)sizeof(filename), icon);
   } else {
-    dirent **files;        // Files in in directory
     char emsg[1024] = "";
 
     // Build the file list, check for errors
-    num_files = Fl::system_driver()->file_browser_load_directory(directory_,
-                                                                 filename, sizeof(filename),
-                                                                 &files, sort,
-                                                                 emsg, sizeof(emsg));
-    // printf("Fl_File_Browser::load(dir='%s',filename='%s'): failed, emsg='%s'\n", directory_, filename, emsg);
+    listing_ = get_listing(directory_, sort, &num_files, emsg, sizeof(emsg));
+    // printf("Fl_File_Browser::load(dir='%s'): failed, emsg='%s'\n", directory_, emsg);
 
-    if (num_files <= 0) {
+    if (!listing_) {
       errmsg(emsg);
       return 0;
     }
 
-    for (i = 0, num_dirs = 0; i < num_files; i ++) {
-      if (strcmp(files[i]->d_name, "./")) {
-        fl_snprintf(filename, sizeof(filename), "%s/%s", directory_, files[i]->d_name);
-
-        icon = Fl_File_Icon::find(filename);
-        if ((icon && icon->type() == Fl_File_Icon::DIRECTORY) ||
-            Fl::system_driver()->filename_isdir_quick(filename)) {
-          num_dirs ++;
-          insert(num_dirs, files[i]->d_name, icon);
-        } else if (filetype_ == FILES &&
-                   fl_filename_match(files[i]->d_name, pattern_)) {
-          add(files[i]->d_name, icon);
-        }
-      }
+    loaded_   = 0;
+    num_dirs_ = 0;
+    matcher_.pattern(pattern_);
+  }
 
-      free(files[i]);
-    }
+  return (num_files);
+}
 
-    free(files);
+
+// Adds the next n entries of listing_ to the browser.
+void
+Fl_File_Browser::load_entries(int n)
+{
+  Fl_File_Listing *l = listing_;
+  char          filename[4096];                 // Current file
+  Fl_File_Icon  *icon;                          // Icon to use
+  int           type;                           // File type
+
+  for (; n > 0 && loaded_ < l->count; n --, loaded_ ++) {
+    const char *name = l->names[loaded_];
+
+    if (!strcmp(name, "./"))
+      continue;
+
+    fl_snprintf(filename, sizeof(filename), "%s/%s", l->directory, name);
+
+    if (l->types[loaded_] == Fl_File_Icon::ANY)
+      l->types[loaded_] = (uchar)Fl::system_driver()->file_type(filename);
+    type = l->types[loaded_];
+
+    // A known type also tells whether the file is a directory, so only
+    // if the driver doesn't report types another stat() is needed...
+    icon = Fl_File_Icon::find(filename, type);
+    if ((icon && icon->type() == Fl_File_Icon::DIRECTORY) ||
+        type == Fl_File_Icon::DIRECTORY ||
+        (type == Fl_File_Icon::ANY &&
+         Fl::system_driver()->filename_isdir_quick(filename))) {
+      num_dirs_ ++;
+      insert(num_dirs_, name, icon);
+    } else if (filetype_ == FILES &&
+               matcher_.match(name)) {
+      add(name, icon);
+    }
   }
 
-  return (num_files);
+  if (loaded_ >= l->count)
+    stop_load();
+}
+
+
+// Stops load_async() and caches the listing if it was loaded completely.
+void
+Fl_File_Browser::stop_load()
+{
+  if (!listing_)
+    return;
+
+  Fl::remove_idle(load_idle_cb, this);
+  if (loaded_ >= listing_->count)
+    cache_listing(listing_);
+  release_listing(listing_);
+  listing_ = NULL;
+}
+
+
+void
+Fl_File_Browser::load_idle_cb(void *v)
+{
+  ((Fl_File_Browser *)v)->load_entries(LOAD_BATCH);
+}
+
+
+/**
+  Sets the number of directory listings that are cached.
+
+  load() and load_async() keep the listings of the most recently loaded
+  directories, and reuse a listing as long as the modification time of
+  its directory is unchanged. The default is 4; 0 disables the cache.
+
+  \see load()
+*/
+void
+Fl_File_Browser::cache_size(int n)
+{
+  listing_cache_size = n < 0 ? 0 : n;
+  trim_listing_cache(listing_cache_size);
+}
+
+
+/**
+  Returns the number of directory listings that are cached.
+  \see cache_size(int)
+*/
+int
+Fl_File_Browser::cache_size()
+{
+  return listing_cache_size;
 }
 
 
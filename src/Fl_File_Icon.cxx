@@ -32,6 +32,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <ctype.h>
 #include <FL/fl_utf8.h>
 #include "flstring.h"
 #include <FL/Fl.H>
@@ -40,6 +41,7 @@
 #include <FL/Fl_Widget.H>
 #include <FL/fl_draw.H>
 #include <FL/filename.H>
+#include <FL/Fl_Filename_Matcher.H>
 
 //
 // Icon cache...
@@ -48,6 +50,111 @@
 Fl_File_Icon    *Fl_File_Icon::first_ = (Fl_File_Icon *)0;
 
 
+//
+// Pattern index used by Fl_File_Icon::find()...
+//
+// Most icon patterns are of the form "*.ext" or "*.{ext1|ext2|...}";
+// those are entered in a hash table keyed by the (lowercase) extension,
+// so that finding the icon of a file doesn't need to match its name
+// against every pattern.  All other patterns are kept in a short list
+// of Fl_Filename_Matcher objects.  Entries remember the
+// position of their icon in the icon list, so the first matching icon
+// is still the one that is found.  The index is rebuilt lazily after an
+// icon was created or destroyed.
+//
+
+struct Fl_File_Icon_Ext {
+  const char    *ext;                   // Lowercase extension
+  int           pos;                    // Position of icon in list
+  int           next;                   // Next entry in hash bucket or -1
+};
+
+static int              icon_index_valid = 0;   // Index is up to date?
+static Fl_File_Icon     **icon_list = 0;        // Icons in list order
+static int              icon_count = 0;         // Number of icons
+static Fl_File_Icon_Ext *icon_exts = 0;         // Extension entries
+static int              icon_num_exts = 0;      // Number of extension entries
+static int              *icon_buckets = 0;      // Hash buckets
+static int              icon_num_buckets = 0;   // Number of hash buckets
+static int              *icon_others = 0;       // Positions of other patterns
+static Fl_Filename_Matcher *icon_matchers = 0;  // Matchers of other patterns
+static int              icon_num_others = 0;    // Number of other patterns
+static char             *icon_ext_chars = 0;    // Storage for extensions
+
+// Pattern helpers shared with Fl_Filename_Matcher, see filename_match.cxx
+extern unsigned fl_filename_ext_hash(const char *s, int len);
+extern int fl_filename_pattern_exts(const char *p,
+                                    void (*f)(const char *ext, int len, void *data),
+                                    void *data);
+
+// Callbacks for fl_filename_pattern_exts() used by icon_index_build()
+static void icon_count_ext(const char *, int len, void *data) {
+  int *count = (int *)data;
+  count[0] ++;
+  count[1] += len + 1;
+}
+
+static char *icon_ext_ptr;              // Next free extension storage
+static int  icon_ext_pos;               // Position of the current icon
+
+static void icon_add_ext(const char *ext, int len, void *) {
+  Fl_File_Icon_Ext *e = icon_exts + icon_num_exts;
+  int i;
+  for (i = 0; i < len; i ++)
+    icon_ext_ptr[i] = (char)tolower((unsigned char)ext[i]);
+  icon_ext_ptr[len] = '\0';
+  e->ext  = icon_ext_ptr;
+  e->pos  = icon_ext_pos;
+  unsigned b = fl_filename_ext_hash(ext, len) % (unsigned)icon_num_buckets;
+  e->next = icon_buckets[b];
+  icon_buckets[b] = icon_num_exts ++;
+  icon_ext_ptr += len + 1;
+}
+
+// Rebuilds the pattern index from the icon list.
+static void icon_index_build(Fl_File_Icon *first) {
+  Fl_File_Icon  *current;
+  int           count[2] = { 0, 0 };    // Extensions, characters
+  int           i;
+
+  free(icon_list);
+  free(icon_exts);
+  free(icon_buckets);
+  free(icon_others);
+  delete[] icon_matchers;
+  free(icon_ext_chars);
+
+  for (icon_count = 0, current = first; current; current = current->next())
+    icon_count ++;
+  for (current = first; current; current = current->next())
+    fl_filename_pattern_exts(current->pattern(), icon_count_ext, count);
+
+  icon_list        = (Fl_File_Icon **)malloc((icon_count + 1) * sizeof(Fl_File_Icon *));
+  icon_others      = (int *)malloc((icon_count + 1) * sizeof(int));
+  icon_matchers    = new Fl_Filename_Matcher[icon_count + 1];
+  icon_exts        = (Fl_File_Icon_Ext *)malloc((count[0] + 1) * sizeof(Fl_File_Icon_Ext));
+  icon_ext_chars   = (char *)malloc(count[1] + 1);
+  icon_num_buckets = count[0] * 2 + 1;
+  icon_buckets     = (int *)malloc(icon_num_buckets * sizeof(int));
+  for (i = 0; i < icon_num_buckets; i ++)
+    icon_buckets[i] = -1;
+
+  icon_num_exts   = 0;
+  icon_num_others = 0;
+  icon_ext_ptr    = icon_ext_chars;
+  for (icon_ext_pos = 0, current = first; current; icon_ext_pos ++, current = current->next()) {
+    icon_list[icon_ext_pos] = current;
+    if (!fl_filename_pattern_exts(current->pattern(), icon_add_ext, 0))
+    {
+      icon_matchers[icon_num_others].pattern(current->pattern());
+      icon_others[icon_num_others ++] = icon_ext_pos;
+    }
+  }
+
+  icon_index_valid = 1;
+}
+
+
 // Registers the FL_ICON_LABEL drawing function
 Fl_Labeltype fl_define_FL_ICON_LABEL() {
   Fl::set_labeltype(_FL_ICON_LABEL, Fl_File_Icon::labeltype, 0);
@@ -88,6 +195,7 @@ Fl_File_Icon::Fl_File_Icon(const char *p,       /* I - Filename pattern */
   // And add the icon to the list of icons...
   next_  = first_;
   first_ = this;
+  icon_index_valid = 0;
 }
 
 
@@ -113,6 +221,7 @@ Fl_File_Icon::~Fl_File_Icon() {
     else
       first_ = current->next_;
   }
+  icon_index_valid = 0;
 
   // Free any memory used...
   if (alloc_data_)
@@ -164,8 +273,10 @@ Fl_File_Icon *                          // O - Matching file icon or NULL
 Fl_File_Icon::find(const char *filename,// I - Name of file */
                    int        filetype) // I - Enumerated file type
 {
-  Fl_File_Icon  *current;               // Current file in list
   const char    *name;                  // Base name of filename
+  const char    *ext;                   // Extension of filename
+  int           best;                   // Position of best match so far
+  int           i;                      // Looping var
 
 
   // Get file information if needed...
@@ -173,19 +284,46 @@ Fl_File_Icon::find(const char *filename,// I - Name of file */
     filetype = Fl::system_driver()->file_type(filename);
   }
 
+  if (!icon_index_valid)
+    icon_index_build(first_);
+
   // Look at the base name in the filename
   name = fl_filename_name(filename);
+  best = icon_count;
+
+  // Find the first icon for the extension of the file.  A name matches
+  // "*.ext" exactly when the text after its last '.' is "ext", which
+  // contains no '.' nor '/'...
+  if ((ext = strrchr(name, '.')) != NULL) {
+    int len = (int)strlen(++ext);
+    if (len > 0) {
+      for (i = icon_buckets[fl_filename_ext_hash(ext, len) % (unsigned)icon_num_buckets];
+           i >= 0; i = icon_exts[i].next) {
+        Fl_File_Icon_Ext *e = icon_exts + i;
+        int t = icon_list[e->pos]->type_;
+        int j;
+        if (e->pos >= best || (t != filetype && t != ANY))
+          continue;
+        for (j = 0; j < len && tolower((unsigned char)ext[j]) == (unsigned char)e->ext[j]; j ++) {/*empty*/}
+        if (j == len && !e->ext[len])
+          best = e->pos;
+      }
+    }
+  }
 
-  // Loop through the available file types and return any match that
-  // is found...
-  for (current = first_; current != (Fl_File_Icon *)0; current = current->next_)
+  // Then check the other patterns that come before it in the list...
+  for (i = 0; i < icon_num_others && icon_others[i] < best; i ++) {
+    Fl_File_Icon *current = icon_list[icon_others[i]];
     if ((current->type_ == filetype || current->type_ == ANY) &&
-        (fl_filename_match(filename, current->pattern_) ||
-         fl_filename_match(name, current->pattern_)))
+        (icon_matchers[i].match(filename) ||
+         icon_matchers[i].match(name))) {
+      best = icon_others[i];
       break;
+    }
+  }
 
   // Return the match (if any)...
-  return (current);
+  return (best < icon_count ? icon_list[best] : (Fl_File_Icon *)0);
 }
 
 /**
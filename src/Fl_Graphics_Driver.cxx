@@ -655,6 +655,28 @@ const char *Fl_Graphics_Driver::font_name(int num) {return NULL;}
 /** Support for Fl::set_font() */
 void Fl_Graphics_Driver::font_name(int num, const char *name) {}
 
+/** Support for Fl::text_layout_cache_stats() */
+int Fl_Graphics_Driver::text_layout_cache_stats(unsigned long *hits, unsigned long *misses) {
+  if (hits) *hits = 0;
+  if (misses) *misses = 0;
+  return 0;
+}
+
+/** Support for Fl::preload_font() */
+void Fl_Graphics_Driver::preload_font(Fl_Font face, Fl_Fontsize fsize) {
+  Fl_Font_Descriptor *d = font_descriptor();
+  Fl_Font f = font();
+  Fl_Fontsize s = size();
+  font(face, fsize);
+  if (d) {
+    font(f, s);
+  } else { // no font was current, none is after the call
+    font_descriptor(NULL);
+    font_ = f;
+    size_ = s;
+  }
+}
+
 /** Support function for fl_overlay_rect() and scaled GUI.*/
 void Fl_Graphics_Driver::overlay_rect(int x, int y, int w , int h) {
   loop(x, y, x+w-1, y, x+w-1, y+h-1, x, y+h-1);
@@ -22,6 +22,7 @@
 #include <FL/Fl_Group.H>
 #include "Fl_Window_Driver.H"
 #include <FL/Fl_Rect.H>
+#include <FL/Fl_Recording_Surface.H>
 #include <FL/fl_draw.H>
 
 #include <stdlib.h> // malloc etc.
@@ -879,6 +880,10 @@ void Fl_Group::draw() {
 void Fl_Group::update_child(Fl_Widget& widget) const {
   if (widget.damage() && widget.visible() && widget.type() < FL_WINDOW &&
       fl_not_clipped(widget.x(), widget.y(), widget.w(), widget.h())) {
+    if (Fl_Recording_Surface::cache_count_) {
+      Fl_Recording_Surface::draw_child_(this, widget, 1);
+      return;
+    }
     widget.draw();
     widget.clear_damage();
   }
@@ -893,6 +898,10 @@ void Fl_Group::update_child(Fl_Widget& widget) const {
 void Fl_Group::draw_child(Fl_Widget& widget) const {
   if (widget.visible() && widget.type() < FL_WINDOW &&
       fl_not_clipped(widget.x(), widget.y(), widget.w(), widget.h())) {
+    if (Fl_Recording_Surface::cache_count_) {
+      Fl_Recording_Surface::draw_child_(this, widget, 0);
+      return;
+    }
     widget.clear_damage(FL_DAMAGE_ALL);
     widget.draw();
     widget.clear_damage();
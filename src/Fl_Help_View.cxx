@@ -25,9 +25,20 @@
 //   Fl_Help_View::compare_targets() - Compare two targets.
 //   Fl_Help_View::do_align()        - Compute the alignment for a line in
 //                                     a block.
+//   Fl_Help_View::build_display()   - Build the display list of a block.
+//   Fl_Help_View::draw_display()    - Draw the display lists.
 //   Fl_Help_View::draw()            - Draw the Fl_Help_View widget.
 //   Fl_Help_View::format()          - Format the help text.
+//   Fl_Help_View::format_run()      - Format the help text, continuing a layout.
+//   Fl_Help_View::format_scrollbars() - Show the scrollbars the document needs.
 //   Fl_Help_View::format_table()    - Format a table...
+//   Fl_Help_View::get_columns()     - Get the column widths of a table.
+//   Fl_Help_View::check_tables()    - Check the guessed column widths.
+//   Fl_Help_View::format_to()       - Format the text down to a position.
+//   Fl_Help_View::format_cb()       - Format the next part of the text.
+//   Fl_Help_View::format_progress() - Show the progress of the layout.
+//   Fl_Help_View::progressive_layout() - Turn the progressive layout on or off.
+//   Fl_Help_View::formatting()      - Is the text formatted completely?
 //   Fl_Help_View::free_data()       - Free memory used for the document.
 //   Fl_Help_View::get_align()       - Get an alignment attribute.
 //   Fl_Help_View::get_attr()        - Get an attribute value from the string.
@@ -60,6 +71,7 @@
 #include "flstring.h"
 #include <ctype.h>
 #include <errno.h>
+#include <limits.h>
 #include <math.h>
 
 #define MAX_COLUMNS     200
@@ -194,22 +206,6 @@ struct fl_margins {
  * - write a comment for every new function
  */
 
-/*
-The following functions are also used to draw stuff and should be replaced with
-local copies that are much faster when merely counting:
-
-fl_color(Fl_Color);
-fl_rectf(int, int, int, int);
-fl_push_clip(int, int, int, int);
-fl_xyline(int, int, int);
-fl_rect()
-fl_line()
-img->draw()
-*/
-
-// We don't put the offscreen buffer in the help view class because
-// we'd need to include platform.H in the header...
-static Fl_Offscreen fl_help_view_buffer;
 int Fl_Help_View::selection_first = 0;
 int Fl_Help_View::selection_last = 0;
 int Fl_Help_View::selection_push_first = 0;
@@ -225,41 +221,339 @@ Fl_Help_View *Fl_Help_View::current_view = 0L;
 Fl_Color Fl_Help_View::hv_selection_color;
 Fl_Color Fl_Help_View::hv_selection_text_color;
 
-/*
- * This function must be optimized for speed!
+//
+// Display list used by Fl_Help_View::draw()...
+//
+
+/* Fl_Help_View::build_display() parses the text of a block when the block
+ * becomes visible for the first time, and records what has to be drawn:
+ * text runs with their font, color and position, lines, table cells and
+ * images. Positions are document coordinates, i.e. they don't depend on
+ * the scroll position or on the widget position.
+ *
+ * draw_display() replays the lists of the visible blocks. begin_selection()
+ * and extend_selection() use the same lists to find the word under the
+ * mouse, instead of drawing the document into an offscreen buffer, and
+ * find_link() looks up the link rectangles in horizontal bands.
+ *
+ * All lists are discarded by format(), which may change any position.
  */
-void Fl_Help_View::hv_draw(const char *t, int x, int y, int entity_extra_length)
-{
-  if (selected && current_view==this && current_pos<selection_last && current_pos>=selection_first) {
+
+enum {
+  HV_TEXT,                              // text run
+  HV_LINE,                              // underline from x to w
+  HV_HR,                                // horizontal rule from x to w
+  HV_CELL,                              // table cell background and border
+  HV_IMAGE                              // image
+};
+
+// font and color of a text run
+struct HV_Style {
+  Fl_Font       font;
+  Fl_Fontsize   size;
+  Fl_Color      color;
+  int           height,                 // fl_height()
+                descent,                // fl_descent()
+                space;                  // fl_width(' ')
+};
+
+struct HV_Op {
+  uchar         type;                   // HV_TEXT, HV_LINE ...
+  uchar         fill,                   // HV_CELL: draw the background?
+                border;                 // HV_CELL: draw the border?
+  int           style;                  // HV_TEXT: index in the style table
+  int           x, y, w, h;             // position and size
+  Fl_Color      color,                  // color of lines and borders
+                bgcolor;                // HV_CELL: background color
+  int           pos,                    // HV_TEXT: offset of the text in value_
+                len,                    // HV_TEXT: length of the text
+                text,                   // HV_TEXT: offset of the text in the block text
+                extra;                  // HV_TEXT: entity length minus UTF-8 length
+  Fl_Shared_Image *image;               // HV_IMAGE
+};
+
+// display list of one block
+struct HV_Block_Display {
+  HV_Op         *ops;                   // operations in drawing order
+  int           nops, aops;
+  char          *text;                  // nul-terminated text of all text runs
+  int           ntext, atext;
+  Fl_Color      textcolor_in,           // textcolor_ before the block (<FONT> changes it)
+                textcolor_out;          // textcolor_ after the block
+  char          valid;                  // set by Fl_Help_View::build_display()
+};
+
+struct Fl_Help_Display_List {
+  HV_Block_Display *blocks;             // one list per Fl_Help_View block
+  int           nblocks;
+  HV_Style      *styles;                // distinct text styles
+  int           nstyles, astyles;
+  HV_Block_Display *current;            // list being built
+  int           *link_first,            // links overlapping each band of LINK_BAND pixels
+                *link_index,
+                nbands;
+  char          links_valid;
+
+  enum { LINK_BAND = 64 };
+
+  Fl_Help_Display_List() {
+    blocks = 0; nblocks = 0;
+    styles = 0; nstyles = astyles = 0;
+    current = 0;
+    link_first = link_index = 0; nbands = 0;
+    links_valid = 0;
+  }
+  ~Fl_Help_Display_List() { clear(); }
+
+  void clear() {
+    for (int i = 0; i < nblocks; i ++) {
+      free(blocks[i].ops);
+      free(blocks[i].text);
+    }
+    free(blocks); blocks = 0; nblocks = 0;
+    free(styles); styles = 0; nstyles = astyles = 0;
+    current = 0;
+    free(link_first); free(link_index);
+    link_first = link_index = 0; nbands = 0;
+    links_valid = 0;
+  }
+
+  // returns the display list of block n, NULL if it must be built
+  HV_Block_Display *get(int n, int nb, Fl_Color textcolor) {
+    if (nblocks != nb) {
+      // a progressive layout only adds blocks, see Fl_Help_Layout
+      if (nb < nblocks) clear();
+      blocks = (HV_Block_Display *)realloc(blocks, nb * sizeof(HV_Block_Display));
+      memset(blocks + nblocks, 0, (nb - nblocks) * sizeof(HV_Block_Display));
+      nblocks = nb;
+    }
+    HV_Block_Display *d = blocks + n;
+    return (d->valid && d->textcolor_in == textcolor) ? d : 0;
+  }
+
+  void begin(int n, Fl_Color textcolor) {
+    current = blocks + n;
+    current->nops = current->ntext = 0;
+    current->textcolor_in = textcolor;
+    current->valid = 0;
+  }
+
+  void end(Fl_Color textcolor) {
+    current->textcolor_out = textcolor;
+    current->valid = 1;
+    current = 0;
+  }
+
+  HV_Op *add(int type, int x, int y, int w) {
+    HV_Block_Display *d = current;
+    if (d->nops >= d->aops) {
+      d->aops = d->aops ? 2 * d->aops : 16;
+      d->ops = (HV_Op *)realloc(d->ops, d->aops * sizeof(HV_Op));
+    }
+    HV_Op *op = d->ops + d->nops ++;
+    memset(op, 0, sizeof(HV_Op));
+    op->type  = (uchar)type;
+    op->x     = x;
+    op->y     = y;
+    op->w     = w;
+    op->color = fl_color();
+    return op;
+  }
+
+  // index of the style of the current font and color
+  int style() {
+    Fl_Font f = fl_font();
+    Fl_Fontsize s = fl_size();
     Fl_Color c = fl_color();
-    fl_color(hv_selection_color);
-    int w = (int)fl_width(t);
-    if (current_pos+(int)strlen(t)<selection_last)
-      w += (int)fl_width(' ');
-    fl_rectf(x, y+fl_descent()-fl_height(), w, fl_height());
-    fl_color(hv_selection_text_color);
-    fl_draw(t, x, y);
-    fl_color(c);
-  } else {
-    fl_draw(t, x, y);
-  }
-  if (draw_mode) {
-    int w = (int)fl_width(t);
-    if (mouse_x>=x && mouse_x<x+w) {
-      if (mouse_y>=y-fl_height()+fl_descent()&&mouse_y<=y+fl_descent()) {
-        int f = (int) current_pos;
-        int l = (int) (f+strlen(t)); // use 'quote_char' to calculate the true length of the HTML string
-        if (draw_mode==1) {
-          selection_push_first = f;
-          selection_push_last = l;
-        } else {
-          selection_drag_first = f;
-          selection_drag_last = l + entity_extra_length;
-        }
-      }
+    int i;
+    for (i = nstyles - 1; i >= 0; i --)
+      if (styles[i].font == f && styles[i].size == s && styles[i].color == c)
+        return i;
+    if (nstyles >= astyles) {
+      astyles += 16;
+      styles = (HV_Style *)realloc(styles, astyles * sizeof(HV_Style));
     }
+    HV_Style *st = styles + nstyles;
+    st->font    = f;
+    st->size    = s;
+    st->color   = c;
+    st->height  = fl_height();
+    st->descent = fl_descent();
+    st->space   = (int)fl_width(' ');
+    return nstyles ++;
   }
-}
+
+  void text(const char *t, int x, int y, int pos, int extra) {
+    HV_Block_Display *d = current;
+    int len = (int) strlen(t);
+    HV_Op *op = add(HV_TEXT, x, y, (int)fl_width(t));
+    op->style = style();
+    op->pos   = pos;
+    op->len   = len;
+    op->extra = extra;
+    if (d->ntext + len + 1 > d->atext) {
+      d->atext = d->atext ? 2 * d->atext : 256;
+      while (d->ntext + len + 1 > d->atext) d->atext *= 2;
+      d->text = (char *)realloc(d->text, d->atext);
+    }
+    op->text = d->ntext;
+    memcpy(d->text + d->ntext, t, len + 1);
+    d->ntext += len + 1;
+  }
+
+  void line(int type, int x, int y, int x2) {
+    add(type, x, y, x2);
+  }
+
+  void cell(int x, int y, int w, int h, int fill, Fl_Color bgcolor, int border) {
+    HV_Op *op = add(HV_CELL, x, y, w);
+    op->h       = h;
+    op->fill    = (uchar)fill;
+    op->bgcolor = bgcolor;
+    op->border  = (uchar)border;
+  }
+
+  void image(Fl_Shared_Image *img, int x, int y) {
+    HV_Op *op = add(HV_IMAGE, x, y, 0);
+    op->image = img;
+  }
+
+  // sorts the links into bands, so find_link() only tests nearby links
+  void index_links(const Fl_Help_Link *links, int n) {
+    int i, b, last;
+    free(link_first); free(link_index);
+    for (i = 0, nbands = 0; i < n; i ++)
+      if (links[i].h > 0 && (links[i].h - 1) / LINK_BAND >= nbands)
+        nbands = (links[i].h - 1) / LINK_BAND + 1;
+    link_first = (int *)calloc(nbands + 1, sizeof(int));
+    for (i = 0; i < n; i ++) {
+      last = (links[i].h - 1) / LINK_BAND;
+      for (b = links[i].y > 0 ? links[i].y / LINK_BAND : 0; b <= last; b ++)
+        link_first[b + 1] ++;
+    }
+    for (b = 0; b < nbands; b ++)
+      link_first[b + 1] += link_first[b];
+    link_index = (int *)malloc((link_first[nbands] + 1) * sizeof(int));
+    int *fill = (int *)malloc((nbands + 1) * sizeof(int));
+    memcpy(fill, link_first, (nbands + 1) * sizeof(int));
+    for (i = 0; i < n; i ++) {
+      last = (links[i].h - 1) / LINK_BAND;
+      for (b = links[i].y > 0 ? links[i].y / LINK_BAND : 0; b <= last; b ++)
+        link_index[fill[b] ++] = i;
+    }
+    free(fill);
+    links_valid = 1;
+  }
+};
+
+//
+// State of a progressive layout, see Fl_Help_View::format()...
+//
+
+/* format_run() keeps everything it needs to continue the layout in
+ * Fl_Help_Layout, so it can stop between two blocks and continue later
+ * from an idle callback. draw() doesn't draw the last block while the
+ * layout is active, so all blocks that are drawn are complete.
+ *
+ * The first screen is formatted before format() returns. The column widths
+ * of a big table depend on all of its rows, so they are guessed from the
+ * first HV_TABLE_GUESS bytes of the table for the first screen. The first
+ * idle call scans these tables completely, and formats everything again
+ * if a guess was wrong. The widths of all tables are cached, so the tables
+ * aren't scanned again when the layout starts over with a new width.
+ */
+
+#define HV_TABLE_GUESS  32768           // bytes of a table scanned for the first screen
+#define HV_FORMAT_SLICE 65536           // bytes of text formatted per idle call
+
+// a font stack that can be compared
+struct HV_Font_Stack : public Fl_Help_Font_Stack {
+  HV_Font_Stack &operator=(const Fl_Help_Font_Stack &s) {
+    Fl_Help_Font_Stack::operator=(s);
+    return *this;
+  }
+  int same(const HV_Font_Stack &s) const {
+    if (nfonts_ != s.nfonts_) return 0;
+    for (size_t i = 0; i <= nfonts_; i ++)
+      if (elts_[i].f != s.elts_[i].f || elts_[i].s != s.elts_[i].s ||
+          elts_[i].c != s.elts_[i].c) return 0;
+    return 1;
+  }
+};
+
+// column widths of a table, see Fl_Help_View::get_columns()
+struct HV_Table_Widths {
+  const char    *table;                 // start of the table
+  int           hsize;                  // hsize_ of the layout
+  HV_Font_Stack before,                 // fonts before and after format_table()
+                after;
+  char          provisional;            // only the start of the table was scanned
+  int           table_width,
+                columns[MAX_COLUMNS];
+};
+
+struct Fl_Help_Layout {
+  char          progressive,            // see Fl_Help_View::progressive_layout()
+                active,                 // the layout isn't complete
+                first_pass,             // formatting the first screen
+                provisional,            // some column widths are guesses
+                fresh,                  // start with the first block
+                initial;                // initial_load of format()
+  int           width,                  // hsize_, scrollbar size, colors and
+                scrollsize;             // text color of the layout, see resize()
+  Fl_Color      color, defcolor;
+  int           length;                 // length of the text
+  HV_Table_Widths *tables;              // column widths of the tables
+  int           ntables, atables;
+
+  // the state of Fl_Help_View::format_run() between two calls
+  int           done;
+  Fl_Help_Block *block;
+  int           cells[MAX_COLUMNS];
+  int           row;
+  const char    *ptr;
+  char          linkdest[1024];
+  int           xx, yy, ww, hh;
+  int           line, links;
+  Fl_Font       font;
+  Fl_Fontsize   fsize;
+  Fl_Color      fcolor;
+  unsigned char border;
+  int           talign, newalign, head, pre, needspace;
+  int           table_width, table_offset;
+  int           column, columns[MAX_COLUMNS];
+  Fl_Color      tc, rc;
+  fl_margins    margins;
+  Fl_Help_Font_Stack fstack;            // fstack_, which draw() uses too
+  Fl_Color      textcolor,              // textcolor_, which draw() uses too
+                textcolor_end;          // textcolor_ after the layout
+
+  Fl_Help_Layout() {
+    progressive = active = first_pass = provisional = fresh = initial = 0;
+    width = scrollsize = -1;
+    length = 0;
+    tables = 0; ntables = atables = 0;
+    block = 0; ptr = 0;
+  }
+  ~Fl_Help_Layout() { free(tables); }
+
+  // returns the cached widths of a table, or NULL
+  HV_Table_Widths *find(const char *table, int hsize, const HV_Font_Stack &before) {
+    for (int i = 0; i < ntables; i ++)
+      if (tables[i].table == table && tables[i].hsize == hsize &&
+          tables[i].before.same(before))
+        return tables + i;
+    return 0;
+  }
+
+  HV_Table_Widths *add() {
+    if (ntables >= atables) {
+      atables = atables ? 2 * atables : 16;
+      tables = (HV_Table_Widths *)realloc(tables, atables * sizeof(HV_Table_Widths));
+    }
+    return tables + ntables ++;
+  }
+};
 
 #define DEBUG_EDIT_BUFFER 0
 
@@ -632,12 +926,13 @@ Fl_Help_View::do_align(Fl_Help_Block *block,    // I - Block to add to
   return (line);
 }
 
-/** Draws the Fl_Help_View widget. */
+/** Builds the display list of block \p n, see Fl_Help_Display_List. */
 void
-Fl_Help_View::draw()
+Fl_Help_View::build_display(int n)
 {
-  int                   i;              // Looping var
-  const Fl_Help_Block   *block;         // Pointer to current block
+  const Fl_Help_Block   *block = blocks_ + n;
+                                        // Block to build
+  Fl_Help_Display_List  *dl = display_; // Display list
   const char            *ptr,           // Pointer to text in block
                         *attrs;         // Pointer to start of element attributes
   HV_Edit_Buffer        buf;            // Text buffer
@@ -649,529 +944,645 @@ Fl_Help_View::draw()
   Fl_Color              fcolor;         // current font color
   int                   head, pre,      // Flags for text
                         needspace;      // Do we need whitespace?
-  Fl_Boxtype            b = box() ? box() : FL_DOWN_BOX;
-                                        // Box to draw...
   int                   underline,      // Underline text?
                         xtra_ww;        // Extra width for underlined space between words
 
   DEBUG_FUNCTION(__LINE__,__FUNCTION__);
 
-  // Draw the scrollbar(s) and box first...
-  ww = w();
-  hh = h();
-  i  = 0;
+  dl->begin(n, textcolor_);
+  current_pos = (int) (block->start - value_);
+  ww = 0;
+
+  line      = 0;
+  xx        = block->line[line];
+  yy        = block->y;
+  hh        = 0;
+  pre       = 0;
+  head      = 0;
+  needspace = 0;
+  underline = 0;
+
+  initfont(font, fsize, fcolor);
+  // byte length difference between html entity (encoded by &...;) and
+  // UTF-8 encoding of same character
+  int entity_extra_length = 0;
+  for (ptr = block->start, buf.clear(); ptr < block->end;)
+  {
+    if ((*ptr == '<' || isspace((*ptr)&255)) && buf.size() > 0)
+    {
+      if (!head && !pre)
+      {
+        // Check width...
+        ww = buf.width();
 
-  draw_box(b, x(), y(), ww, hh, bgcolor_);
+        if (needspace && xx > block->x)
+          xx += (int)fl_width(' ');
 
-  if ( hscrollbar_.visible() || scrollbar_.visible() ) {
-    int scrollsize = scrollbar_size_ ? scrollbar_size_ : Fl::scrollbar_size();
-    int hor_vis = hscrollbar_.visible();
-    int ver_vis = scrollbar_.visible();
-    // Scrollbar corner
-    int scorn_x = x() + ww - (ver_vis?scrollsize:0) - Fl::box_dw(b) + Fl::box_dx(b);
-    int scorn_y = y() + hh - (hor_vis?scrollsize:0) - Fl::box_dh(b) + Fl::box_dy(b);
-    if ( hor_vis ) {
-      if ( hscrollbar_.h() != scrollsize ) {            // scrollsize changed?
-        hscrollbar_.resize(x(), scorn_y, scorn_x - x(), scrollsize);
-        init_sizes();
-      }
-      draw_child(hscrollbar_);
-      hh -= scrollsize;
-    }
-    if ( ver_vis ) {
-      if ( scrollbar_.w() != scrollsize ) {             // scrollsize changed?
-        scrollbar_.resize(scorn_x, y(), scrollsize, scorn_y - y());
-        init_sizes();
+        if ((xx + ww) > block->w)
+        {
+          if (line < 31)
+            line ++;
+          xx = block->line[line];
+          yy += hh;
+          hh = 0;
+        }
+
+        dl->text(buf.c_str(), xx, yy, current_pos, entity_extra_length);
+        buf.clear();
+        entity_extra_length = 0;
+        if (underline) {
+          xtra_ww = isspace((*ptr)&255)?(int)fl_width(' '):0;
+          dl->line(HV_LINE, xx, yy, xx + ww + xtra_ww);
+        }
+        current_pos = (int) (ptr-value_);
+
+        xx += ww;
+        if ((fsize + 2) > hh)
+          hh = fsize + 2;
+
+        needspace = 0;
       }
-      draw_child(scrollbar_);
-      ww -= scrollsize;
-    }
-    if ( hor_vis && ver_vis ) {
-      // Both scrollbars visible? Draw little gray box in corner
-      fl_color(FL_GRAY);
-      fl_rectf(scorn_x, scorn_y, scrollsize, scrollsize);
-    }
-  }
+      else if (pre)
+      {
+        while (isspace((*ptr)&255))
+        {
+          if (*ptr == '\n')
+          {
+            dl->text(buf.c_str(), xx, yy, current_pos, 0);
+            if (underline) dl->line(HV_LINE, xx, yy, xx + buf.width());
+            buf.clear();
+            current_pos = (int) (ptr-value_);
+            if (line < 31)
+              line ++;
+            xx = block->line[line];
+            yy += hh;
+            hh = fsize + 2;
+          }
+          else if (*ptr == '\t')
+          {
+            // Do tabs every 8 columns...
+            buf.add(' '); // add at least one space
+            while (buf.size() & 7)
+              buf.add(' ');
+          }
+          else {
+            buf.add(' ');
+          }
+          if ((fsize + 2) > hh)
+            hh = fsize + 2;
 
-  if (!value_)
-    return;
+          ptr ++;
+        }
 
-  if (current_view == this && selected) {
-    hv_selection_color      = FL_SELECTION_COLOR;
-    hv_selection_text_color = fl_contrast(textcolor_, FL_SELECTION_COLOR);
-  }
-  current_pos = 0;
+        if (buf.size() > 0)
+        {
+          dl->text(buf.c_str(), xx, yy, current_pos, 0);
+          ww = buf.width();
+          buf.clear();
+          if (underline) dl->line(HV_LINE, xx, yy, xx + ww);
+          xx += ww;
+          current_pos = (int) (ptr-value_);
+        }
 
-  // Clip the drawing to the inside of the box...
-  fl_push_clip(x() + Fl::box_dx(b), y() + Fl::box_dy(b),
-               ww - Fl::box_dw(b), hh - Fl::box_dh(b));
-  fl_color(textcolor_);
+        needspace = 0;
+      }
+      else
+      {
+        buf.clear();
 
-  // Draw all visible blocks...
-  for (i = 0, block = blocks_; i < nblocks_; i ++, block ++)
-    if ((block->y + block->h) >= topline_ && block->y < (topline_ + h()))
+        while (isspace((*ptr)&255))
+          ptr ++;
+        current_pos = (int) (ptr-value_);
+      }
+    }
+
+    if (*ptr == '<')
     {
-      line      = 0;
-      xx        = block->line[line];
-      yy        = block->y - topline_;
-      hh        = 0;
-      pre       = 0;
-      head      = 0;
-      needspace = 0;
-      underline = 0;
+      ptr ++;
 
-      initfont(font, fsize, fcolor);
-      // byte length difference between html entity (encoded by &...;) and
-      // UTF-8 encoding of same character
-      int entity_extra_length = 0;
-      for (ptr = block->start, buf.clear(); ptr < block->end;)
+      if (strncmp(ptr, "!--", 3) == 0)
       {
-        if ((*ptr == '<' || isspace((*ptr)&255)) && buf.size() > 0)
+        // Comment...
+        ptr += 3;
+        if ((ptr = strstr(ptr, "-->")) != NULL)
         {
-          if (!head && !pre)
-          {
-            // Check width...
-            ww = buf.width();
+          ptr += 3;
+          continue;
+        }
+        else
+          break;
+      }
 
-            if (needspace && xx > block->x)
-              xx += (int)fl_width(' ');
+      while (*ptr && *ptr != '>' && !isspace((*ptr)&255))
+        buf.add(*ptr++);
 
-            if ((xx + ww) > block->w)
-            {
-              if (line < 31)
-                line ++;
-              xx = block->line[line];
-              yy += hh;
-              hh = 0;
-            }
+      attrs = ptr;
+      while (*ptr && *ptr != '>')
+        ptr ++;
 
-            hv_draw(buf.c_str(), xx + x() - leftline_, yy + y(), entity_extra_length);
-            buf.clear();
-            entity_extra_length = 0;
-            if (underline) {
-              xtra_ww = isspace((*ptr)&255)?(int)fl_width(' '):0;
-              fl_xyline(xx + x() - leftline_, yy + y() + 1,
-                        xx + x() - leftline_ + ww + xtra_ww);
-            }
-            current_pos = (int) (ptr-value_);
+      if (*ptr == '>')
+        ptr ++;
 
-            xx += ww;
-            if ((fsize + 2) > hh)
-              hh = fsize + 2;
+      // end of command reached, set the supposed start of printed eord here
+      current_pos = (int) (ptr-value_);
+      if (buf.cmp("HEAD"))
+        head = 1;
+      else if (buf.cmp("BR"))
+      {
+        if (line < 31)
+          line ++;
+        xx = block->line[line];
+        yy += hh;
+        hh = 0;
+      }
+      else if (buf.cmp("HR"))
+      {
+        dl->line(HV_HR, block->x, yy, block->w);
 
-            needspace = 0;
-          }
-          else if (pre)
-          {
-            while (isspace((*ptr)&255))
-            {
-              if (*ptr == '\n')
-              {
-                hv_draw(buf.c_str(), xx + x() - leftline_, yy + y());
-                if (underline) fl_xyline(xx + x() - leftline_, yy + y() + 1,
-                                         xx + x() - leftline_ + buf.width());
-                buf.clear();
-                current_pos = (int) (ptr-value_);
-                if (line < 31)
-                  line ++;
-                xx = block->line[line];
-                yy += hh;
-                hh = fsize + 2;
-              }
-              else if (*ptr == '\t')
-              {
-                // Do tabs every 8 columns...
-                buf.add(' '); // add at least one space
-                while (buf.size() & 7)
-                  buf.add(' ');
-              }
-              else {
-                buf.add(' ');
-              }
-              if ((fsize + 2) > hh)
-                hh = fsize + 2;
+        if (line < 31)
+          line ++;
+        xx = block->line[line];
+        yy += 2 * fsize;//hh;
+        hh = 0;
+      }
+      else if (buf.cmp("CENTER") ||
+               buf.cmp("P") ||
+               buf.cmp("H1") ||
+               buf.cmp("H2") ||
+               buf.cmp("H3") ||
+               buf.cmp("H4") ||
+               buf.cmp("H5") ||
+               buf.cmp("H6") ||
+               buf.cmp("UL") ||
+               buf.cmp("OL") ||
+               buf.cmp("DL") ||
+               buf.cmp("LI") ||
+               buf.cmp("DD") ||
+               buf.cmp("DT") ||
+               buf.cmp("PRE"))
+      {
+        if (tolower(buf[0]) == 'h')
+        {
+          font  = FL_HELVETICA_BOLD;
+          fsize = textsize_ + '7' - buf[1];
+        }
+        else if (buf.cmp("DT"))
+        {
+          font  = textfont_ | FL_ITALIC;
+          fsize = textsize_;
+        }
+        else if (buf.cmp("PRE"))
+        {
+          font  = FL_COURIER;
+          fsize = textsize_;
+          pre   = 1;
+        }
 
-              ptr ++;
-            }
+        if (buf.cmp("LI"))
+        {
+          // draw bullet (&bull;) Unicode: U+2022, UTF-8 (hex): e2 80 a2
+          unsigned char bullet[4] = { 0xe2, 0x80, 0xa2, 0x00 };
+          dl->text((char *)bullet, xx - fsize, yy, current_pos, 0);
+        }
 
-            if (buf.size() > 0)
-            {
-              hv_draw(buf.c_str(), xx + x() - leftline_, yy + y());
-              ww = buf.width();
-              buf.clear();
-              if (underline) fl_xyline(xx + x() - leftline_, yy + y() + 1,
-                                       xx + x() - leftline_ + ww);
-              xx += ww;
-              current_pos = (int) (ptr-value_);
-            }
+        pushfont(font, fsize);
+        buf.clear();
+      }
+      else if (buf.cmp("A") &&
+               get_attr(attrs, "HREF", attr, sizeof(attr)) != NULL)
+      {
+        fl_color(linkcolor_);
+        underline = 1;
+      }
+      else if (buf.cmp("/A"))
+      {
+        fl_color(textcolor_);
+        underline = 0;
+      }
+      else if (buf.cmp("FONT"))
+      {
+        if (get_attr(attrs, "COLOR", attr, sizeof(attr)) != NULL) {
+          textcolor_ = get_color(attr, textcolor_);
+        }
 
-            needspace = 0;
-          }
-          else
-          {
-            buf.clear();
+        if (get_attr(attrs, "FACE", attr, sizeof(attr)) != NULL) {
+          if (!strncasecmp(attr, "helvetica", 9) ||
+              !strncasecmp(attr, "arial", 5) ||
+              !strncasecmp(attr, "sans", 4)) font = FL_HELVETICA;
+          else if (!strncasecmp(attr, "times", 5) ||
+                   !strncasecmp(attr, "serif", 5)) font = FL_TIMES;
+          else if (!strncasecmp(attr, "symbol", 6)) font = FL_SYMBOL;
+          else font = FL_COURIER;
+        }
 
-            while (isspace((*ptr)&255))
-              ptr ++;
-            current_pos = (int) (ptr-value_);
+        if (get_attr(attrs, "SIZE", attr, sizeof(attr)) != NULL) {
+          if (isdigit(attr[0] & 255)) {
+            // Absolute size
+            fsize = (int)(textsize_ * pow(1.2, atof(attr) - 3.0));
+          } else {
+            // Relative size
+            fsize = (int)(fsize * pow(1.2, atof(attr) - 3.0));
           }
         }
 
-        if (*ptr == '<')
-        {
-          ptr ++;
+        pushfont(font, fsize);
+      }
+      else if (buf.cmp("/FONT"))
+      {
+        popfont(font, fsize, textcolor_);
+      }
+      else if (buf.cmp("U"))
+        underline = 1;
+      else if (buf.cmp("/U"))
+        underline = 0;
+      else if (buf.cmp("B") ||
+               buf.cmp("STRONG"))
+        pushfont(font |= FL_BOLD, fsize);
+      else if (buf.cmp("TD") ||
+               buf.cmp("TH"))
+      {
+        if (tolower(buf[1]) == 'h')
+          pushfont(font |= FL_BOLD, fsize);
+        else
+          pushfont(font = textfont_, fsize);
 
-          if (strncmp(ptr, "!--", 3) == 0)
-          {
-            // Comment...
-            ptr += 3;
-            if ((ptr = strstr(ptr, "-->")) != NULL)
-            {
-              ptr += 3;
-              continue;
-            }
-            else
-              break;
-          }
+        // the border has the text color after a background was drawn
+        if (block->bgcolor != bgcolor_)
+          fl_color(textcolor_);
 
-          while (*ptr && *ptr != '>' && !isspace((*ptr)&255))
-            buf.add(*ptr++);
+        dl->cell(block->x - 4, block->y - fsize - 3,
+                 block->w - block->x + 7, block->h + fsize - 5,
+                 block->bgcolor != bgcolor_, block->bgcolor, block->border);
+      }
+      else if (buf.cmp("I") ||
+               buf.cmp("EM"))
+        pushfont(font |= FL_ITALIC, fsize);
+      else if (buf.cmp("CODE") ||
+               buf.cmp("TT"))
+        pushfont(font = FL_COURIER, fsize);
+      else if (buf.cmp("KBD"))
+        pushfont(font = FL_COURIER_BOLD, fsize);
+      else if (buf.cmp("VAR"))
+        pushfont(font = FL_COURIER_ITALIC, fsize);
+      else if (buf.cmp("/HEAD"))
+        head = 0;
+      else if (buf.cmp("/H1") ||
+               buf.cmp("/H2") ||
+               buf.cmp("/H3") ||
+               buf.cmp("/H4") ||
+               buf.cmp("/H5") ||
+               buf.cmp("/H6") ||
+               buf.cmp("/B") ||
+               buf.cmp("/STRONG") ||
+               buf.cmp("/I") ||
+               buf.cmp("/EM") ||
+               buf.cmp("/CODE") ||
+               buf.cmp("/TT") ||
+               buf.cmp("/KBD") ||
+               buf.cmp("/VAR"))
+        popfont(font, fsize, fcolor);
+      else if (buf.cmp("/PRE"))
+      {
+        popfont(font, fsize, fcolor);
+        pre = 0;
+      }
+      else if (buf.cmp("IMG"))
+      {
+        Fl_Shared_Image *img = 0;
+        int         width, height;
+        char        wattr[8], hattr[8];
 
-          attrs = ptr;
-          while (*ptr && *ptr != '>')
-            ptr ++;
 
-          if (*ptr == '>')
-            ptr ++;
+        get_attr(attrs, "WIDTH", wattr, sizeof(wattr));
+        get_attr(attrs, "HEIGHT", hattr, sizeof(hattr));
+        width  = get_length(wattr);
+        height = get_length(hattr);
 
-          // end of command reached, set the supposed start of printed eord here
-          current_pos = (int) (ptr-value_);
-          if (buf.cmp("HEAD"))
-            head = 1;
-          else if (buf.cmp("BR"))
-          {
-            if (line < 31)
-              line ++;
-            xx = block->line[line];
-            yy += hh;
-            hh = 0;
-          }
-          else if (buf.cmp("HR"))
-          {
-            fl_line(block->x + x(), yy + y(), block->w + x(),
-                    yy + y());
+        if (get_attr(attrs, "SRC", attr, sizeof(attr))) {
+          img = get_image(attr, width, height);
+          if (!width) width = img->w();
+          if (!height) height = img->h();
+        }
 
-            if (line < 31)
-              line ++;
-            xx = block->line[line];
-            yy += 2 * fsize;//hh;
-            hh = 0;
+        if (!width || !height) {
+          if (get_attr(attrs, "ALT", attr, sizeof(attr)) == NULL) {
+            strcpy(attr, "IMG");
           }
-          else if (buf.cmp("CENTER") ||
-                   buf.cmp("P") ||
-                   buf.cmp("H1") ||
-                   buf.cmp("H2") ||
-                   buf.cmp("H3") ||
-                   buf.cmp("H4") ||
-                   buf.cmp("H5") ||
-                   buf.cmp("H6") ||
-                   buf.cmp("UL") ||
-                   buf.cmp("OL") ||
-                   buf.cmp("DL") ||
-                   buf.cmp("LI") ||
-                   buf.cmp("DD") ||
-                   buf.cmp("DT") ||
-                   buf.cmp("PRE"))
-          {
-            if (tolower(buf[0]) == 'h')
-            {
-              font  = FL_HELVETICA_BOLD;
-              fsize = textsize_ + '7' - buf[1];
-            }
-            else if (buf.cmp("DT"))
-            {
-              font  = textfont_ | FL_ITALIC;
-              fsize = textsize_;
-            }
-            else if (buf.cmp("PRE"))
-            {
-              font  = FL_COURIER;
-              fsize = textsize_;
-              pre   = 1;
-            }
+        }
 
-            if (buf.cmp("LI"))
-            {
-              // draw bullet (&bull;) Unicode: U+2022, UTF-8 (hex): e2 80 a2
-              unsigned char bullet[4] = { 0xe2, 0x80, 0xa2, 0x00 };
-              hv_draw((char *)bullet, xx - fsize + x() - leftline_, yy + y());
-            }
+        ww = width;
 
-            pushfont(font, fsize);
-            buf.clear();
-          }
-          else if (buf.cmp("A") &&
-                   get_attr(attrs, "HREF", attr, sizeof(attr)) != NULL)
-          {
-            fl_color(linkcolor_);
-            underline = 1;
-          }
-          else if (buf.cmp("/A"))
-          {
-            fl_color(textcolor_);
-            underline = 0;
-          }
-          else if (buf.cmp("FONT"))
-          {
-            if (get_attr(attrs, "COLOR", attr, sizeof(attr)) != NULL) {
-              textcolor_ = get_color(attr, textcolor_);
-            }
+        if (needspace && xx > block->x)
+          xx += (int)fl_width(' ');
 
-            if (get_attr(attrs, "FACE", attr, sizeof(attr)) != NULL) {
-              if (!strncasecmp(attr, "helvetica", 9) ||
-                  !strncasecmp(attr, "arial", 5) ||
-                  !strncasecmp(attr, "sans", 4)) font = FL_HELVETICA;
-              else if (!strncasecmp(attr, "times", 5) ||
-                       !strncasecmp(attr, "serif", 5)) font = FL_TIMES;
-              else if (!strncasecmp(attr, "symbol", 6)) font = FL_SYMBOL;
-              else font = FL_COURIER;
-            }
+        if ((xx + ww) > block->w)
+        {
+          if (line < 31)
+            line ++;
 
-            if (get_attr(attrs, "SIZE", attr, sizeof(attr)) != NULL) {
-              if (isdigit(attr[0] & 255)) {
-                // Absolute size
-                fsize = (int)(textsize_ * pow(1.2, atof(attr) - 3.0));
-              } else {
-                // Relative size
-                fsize = (int)(fsize * pow(1.2, atof(attr) - 3.0));
-              }
-            }
+          xx = block->line[line];
+          yy += hh;
+          hh = 0;
+        }
 
-            pushfont(font, fsize);
-          }
-          else if (buf.cmp("/FONT"))
-          {
-            popfont(font, fsize, textcolor_);
-          }
-          else if (buf.cmp("U"))
-            underline = 1;
-          else if (buf.cmp("/U"))
-            underline = 0;
-          else if (buf.cmp("B") ||
-                   buf.cmp("STRONG"))
-            pushfont(font |= FL_BOLD, fsize);
-          else if (buf.cmp("TD") ||
-                   buf.cmp("TH"))
-          {
-            int tx, ty, tw, th;
+        if (img) {
+          dl->image(img, xx, yy - fl_height() + fl_descent() + 2);
+        }
 
-            if (tolower(buf[1]) == 'h')
-              pushfont(font |= FL_BOLD, fsize);
-            else
-              pushfont(font = textfont_, fsize);
+        xx += ww;
+        if ((height + 2) > hh)
+          hh = height + 2;
 
-            tx = block->x - 4 - leftline_;
-            ty = block->y - topline_ - fsize - 3;
-            tw = block->w - block->x + 7;
-            th = block->h + fsize - 5;
+        needspace = 0;
+      }
+      buf.clear();
+    }
+    else if (*ptr == '\n' && pre)
+    {
+      dl->text(buf.c_str(), xx, yy, current_pos, 0);
+      buf.clear();
 
-            if (tx < 0)
-            {
-              tw += tx;
-              tx  = 0;
-            }
+      if (line < 31)
+        line ++;
+      xx = block->line[line];
+      yy += hh;
+      hh = fsize + 2;
+      needspace = 0;
 
-            if (ty < 0)
-            {
-              th += ty;
-              ty  = 0;
-            }
+      ptr ++;
+      current_pos = (int) (ptr-value_);
+    }
+    else if (isspace((*ptr)&255))
+    {
+      if (pre)
+      {
+        if (*ptr == ' ')
+          buf.add(' ');
+        else
+        {
+          // Do tabs every 8 columns...
+          buf.add(' '); // at least one space
+          while (buf.size() & 7)
+            buf.add(' ');
+        }
+      }
 
-            tx += x();
-            ty += y();
+      ptr ++;
+      if (!pre) current_pos = (int) (ptr-value_);
+      needspace = 1;
+    }
+    else if (*ptr == '&') // process html entity
+    {
+      ptr ++;
 
-            if (block->bgcolor != bgcolor_)
-            {
-              fl_color(block->bgcolor);
-              fl_rectf(tx, ty, tw, th);
-              fl_color(textcolor_);
-            }
+      int qch = quote_char(ptr);
 
-            if (block->border)
-              fl_rect(tx, ty, tw, th);
-          }
-          else if (buf.cmp("I") ||
-                   buf.cmp("EM"))
-            pushfont(font |= FL_ITALIC, fsize);
-          else if (buf.cmp("CODE") ||
-                   buf.cmp("TT"))
-            pushfont(font = FL_COURIER, fsize);
-          else if (buf.cmp("KBD"))
-            pushfont(font = FL_COURIER_BOLD, fsize);
-          else if (buf.cmp("VAR"))
-            pushfont(font = FL_COURIER_ITALIC, fsize);
-          else if (buf.cmp("/HEAD"))
-            head = 0;
-          else if (buf.cmp("/H1") ||
-                   buf.cmp("/H2") ||
-                   buf.cmp("/H3") ||
-                   buf.cmp("/H4") ||
-                   buf.cmp("/H5") ||
-                   buf.cmp("/H6") ||
-                   buf.cmp("/B") ||
-                   buf.cmp("/STRONG") ||
-                   buf.cmp("/I") ||
-                   buf.cmp("/EM") ||
-                   buf.cmp("/CODE") ||
-                   buf.cmp("/TT") ||
-                   buf.cmp("/KBD") ||
-                   buf.cmp("/VAR"))
-            popfont(font, fsize, fcolor);
-          else if (buf.cmp("/PRE"))
-          {
-            popfont(font, fsize, fcolor);
-            pre = 0;
-          }
-          else if (buf.cmp("IMG"))
-          {
-            Fl_Shared_Image *img = 0;
-            int         width, height;
-            char        wattr[8], hattr[8];
+      if (qch < 0)
+        buf.add('&');
+      else {
+        int utf8l = buf.size();
+        buf.add(qch);
+        utf8l = buf.size() - utf8l; // length of added UTF-8 text
+        const char *oldptr = ptr;
+        ptr = strchr(ptr, ';') + 1;
+        entity_extra_length += int(ptr - (oldptr-1)) - utf8l; // extra length between html entity and UTF-8
+      }
 
+      if ((fsize + 2) > hh)
+        hh = fsize + 2;
+    }
+    else
+    {
+      buf.add(*ptr++);
 
-            get_attr(attrs, "WIDTH", wattr, sizeof(wattr));
-            get_attr(attrs, "HEIGHT", hattr, sizeof(hattr));
-            width  = get_length(wattr);
-            height = get_length(hattr);
+      if ((fsize + 2) > hh)
+        hh = fsize + 2;
+    }
+  }
 
-            if (get_attr(attrs, "SRC", attr, sizeof(attr))) {
-              img = get_image(attr, width, height);
-              if (!width) width = img->w();
-              if (!height) height = img->h();
-            }
+  if (buf.size() > 0 && !pre && !head)
+  {
+    ww = buf.width();
 
-            if (!width || !height) {
-              if (get_attr(attrs, "ALT", attr, sizeof(attr)) == NULL) {
-                strcpy(attr, "IMG");
-              }
-            }
+    if (needspace && xx > block->x)
+      xx += (int)fl_width(' ');
 
-            ww = width;
+    if ((xx + ww) > block->w)
+    {
+      if (line < 31)
+        line ++;
+      xx = block->line[line];
+      yy += hh;
+      hh = 0;
+    }
+  }
 
-            if (needspace && xx > block->x)
-              xx += (int)fl_width(' ');
+  if (buf.size() > 0 && !head)
+  {
+    dl->text(buf.c_str(), xx, yy, current_pos, 0);
+    if (underline) dl->line(HV_LINE, xx, yy, xx + ww);
+    current_pos = (int) (ptr-value_);
+  }
 
-            if ((xx + ww) > block->w)
-            {
-              if (line < 31)
-                line ++;
+  dl->end(textcolor_);
+} // build_display()
 
-              xx = block->line[line];
-              yy += hh;
-              hh = 0;
-            }
 
-            if (img) {
-              img->draw(xx + x() - leftline_,
-                        yy + y() - fl_height() + fl_descent() + 2);
-            }
+/*
+ * Draws the visible blocks, or finds the word under the mouse if
+ * draw_mode is set. This function must be optimized for speed!
+ */
+void
+Fl_Help_View::draw_display()
+{
+  int                   i, j;           // Looping vars
+  const Fl_Help_Block   *block;         // Pointer to current block
+  HV_Block_Display      *d;             // Display list of the block
+  const HV_Op           *op;            // Current operation
+  const HV_Style        *st = 0;        // Style of the current text run
+  int                   style = -1;     // Index of st
+  int                   X, Y, W, H;     // Position and size on the screen
+  int                   sel = (selected && current_view == this);
+  int                   top = y(), bottom = y() + h();
+                                        // Text outside of these is clipped
+  int                   n = layout_->active ? nblocks_ - 1 : nblocks_;
+                                        // The last block may be incomplete
+
+  for (i = 0, block = blocks_; i < n; i ++, block ++) {
+    if ((block->y + block->h) < topline_ || block->y >= (topline_ + h()))
+      continue;
 
-            xx += ww;
-            if ((height + 2) > hh)
-              hh = height + 2;
+    if ((d = display_->get(i, nblocks_, textcolor_)) == NULL) {
+      build_display(i);
+      d = display_->blocks + i;
+      style = -1; // the style table may have moved
+    }
+    textcolor_ = d->textcolor_out;
+
+    for (j = d->nops, op = d->ops; j > 0; j --, op ++) {
+      X = op->x + x() - leftline_;
+      Y = op->y - topline_ + y();
+
+      if (op->type == HV_TEXT) {
+        if (op->style != style) {
+          style = op->style;
+          st = display_->styles + style;
+          if (!draw_mode) fl_font(st->font, st->size);
+        }
 
-            needspace = 0;
+        if (draw_mode) {
+          // Find the word under the mouse...
+          if (mouse_x >= X && mouse_x < X + op->w &&
+              mouse_y >= Y - st->height + st->descent && mouse_y <= Y + st->descent) {
+            if (draw_mode == 1) {
+              selection_push_first = op->pos;
+              selection_push_last  = op->pos + op->len;
+            } else {
+              selection_drag_first = op->pos;
+              selection_drag_last  = op->pos + op->len + op->extra;
+            }
           }
-          buf.clear();
+          continue;
         }
-        else if (*ptr == '\n' && pre)
-        {
-          hv_draw(buf.c_str(), xx + x() - leftline_, yy + y());
-          buf.clear();
 
-          if (line < 31)
-            line ++;
-          xx = block->line[line];
-          yy += hh;
-          hh = fsize + 2;
-          needspace = 0;
+        if (Y + st->height < top || Y - st->height > bottom)
+          continue;
 
-          ptr ++;
-          current_pos = (int) (ptr-value_);
+        if (sel && op->pos < selection_last && op->pos >= selection_first) {
+          W = op->w;
+          if (op->pos + op->len < selection_last)
+            W += st->space;
+          fl_color(hv_selection_color);
+          fl_rectf(X, Y + st->descent - st->height, W, st->height);
+          fl_color(hv_selection_text_color);
+        } else {
+          fl_color(st->color);
         }
-        else if (isspace((*ptr)&255))
-        {
-          if (pre)
+        fl_draw(d->text + op->text, op->len, X, Y);
+        continue;
+      }
+
+      if (draw_mode)
+        continue;
+
+      switch (op->type) {
+        case HV_LINE :
+          fl_color(op->color);
+          fl_xyline(X, Y + 1, op->w + x() - leftline_);
+          break;
+        case HV_HR :
+          fl_color(op->color);
+          fl_line(op->x + x(), Y, op->w + x(), Y);
+          break;
+        case HV_CELL :
+          // Cells are clipped to the top left corner of the widget...
+          X = op->x - leftline_;
+          Y = op->y - topline_;
+          W = op->w;
+          H = op->h;
+
+          if (X < 0)
+          {
+            W += X;
+            X  = 0;
+          }
+
+          if (Y < 0)
+          {
+            H += Y;
+            Y  = 0;
+          }
+
+          X += x();
+          Y += y();
+
+          if (op->fill)
+          {
+            fl_color(op->bgcolor);
+            fl_rectf(X, Y, W, H);
+          }
+
+          if (op->border)
           {
-            if (*ptr == ' ')
-              buf.add(' ');
-            else
-            {
-              // Do tabs every 8 columns...
-              buf.add(' '); // at least one space
-              while (buf.size() & 7)
-                buf.add(' ');
-            }
+            fl_color(op->color);
+            fl_rect(X, Y, W, H);
           }
+          break;
+        case HV_IMAGE :
+          op->image->draw(X, Y);
+          break;
+      }
+    }
+  }
+} // draw_display()
 
-          ptr ++;
-          if (!pre) current_pos = (int) (ptr-value_);
-          needspace = 1;
-        }
-        else if (*ptr == '&') // process html entity
-        {
-          ptr ++;
 
-          int qch = quote_char(ptr);
+/** Discards the display lists of all blocks. */
+void
+Fl_Help_View::free_display()
+{
+  display_->clear();
+}
 
-          if (qch < 0)
-            buf.add('&');
-          else {
-            int utf8l = buf.size();
-            buf.add(qch);
-            utf8l = buf.size() - utf8l; // length of added UTF-8 text
-            const char *oldptr = ptr;
-            ptr = strchr(ptr, ';') + 1;
-            entity_extra_length += int(ptr - (oldptr-1)) - utf8l; // extra length between html entity and UTF-8
-          }
 
-          if ((fsize + 2) > hh)
-            hh = fsize + 2;
-        }
-        else
-        {
-          buf.add(*ptr++);
+/** Draws the Fl_Help_View widget. */
+void
+Fl_Help_View::draw()
+{
+  int                   ww, hh;         // Current sizes
+  Fl_Boxtype            b = box() ? box() : FL_DOWN_BOX;
+                                        // Box to draw...
 
-          if ((fsize + 2) > hh)
-            hh = fsize + 2;
-        }
-      }
+  DEBUG_FUNCTION(__LINE__,__FUNCTION__);
 
-      if (buf.size() > 0 && !pre && !head)
-      {
-        ww = buf.width();
+  // Draw the scrollbar(s) and box first...
+  ww = w();
+  hh = h();
 
-        if (needspace && xx > block->x)
-          xx += (int)fl_width(' ');
+  draw_box(b, x(), y(), ww, hh, bgcolor_);
 
-        if ((xx + ww) > block->w)
-        {
-          if (line < 31)
-            line ++;
-          xx = block->line[line];
-          yy += hh;
-          hh = 0;
-        }
+  if ( hscrollbar_.visible() || scrollbar_.visible() ) {
+    int scrollsize = scrollbar_size_ ? scrollbar_size_ : Fl::scrollbar_size();
+    int hor_vis = hscrollbar_.visible();
+    int ver_vis = scrollbar_.visible();
+    // Scrollbar corner
+    int scorn_x = x() + ww - (ver_vis?scrollsize:0) - Fl::box_dw(b) + Fl::box_dx(b);
+    int scorn_y = y() + hh - (hor_vis?scrollsize:0) - Fl::box_dh(b) + Fl::box_dy(b);
+    if ( hor_vis ) {
+      if ( hscrollbar_.h() != scrollsize ) {            // scrollsize changed?
+        hscrollbar_.resize(x(), scorn_y, scorn_x - x(), scrollsize);
+        init_sizes();
       }
-
-      if (buf.size() > 0 && !head)
-      {
-        hv_draw(buf.c_str(), xx + x() - leftline_, yy + y());
-        if (underline) fl_xyline(xx + x() - leftline_, yy + y() + 1,
-                                 xx + x() - leftline_ + ww);
-        current_pos = (int) (ptr-value_);
+      draw_child(hscrollbar_);
+      hh -= scrollsize;
+    }
+    if ( ver_vis ) {
+      if ( scrollbar_.w() != scrollsize ) {             // scrollsize changed?
+        scrollbar_.resize(scorn_x, y(), scrollsize, scorn_y - y());
+        init_sizes();
       }
+      draw_child(scrollbar_);
+      ww -= scrollsize;
+    }
+    if ( hor_vis && ver_vis ) {
+      // Both scrollbars visible? Draw little gray box in corner
+      fl_color(FL_GRAY);
+      fl_rectf(scorn_x, scorn_y, scrollsize, scrollsize);
     }
+  }
+
+  if (!value_)
+    return;
+
+  if (current_view == this && selected) {
+    hv_selection_color      = FL_SELECTION_COLOR;
+    hv_selection_text_color = fl_contrast(textcolor_, FL_SELECTION_COLOR);
+  }
+  // Clip the drawing to the inside of the box...
+  fl_push_clip(x() + Fl::box_dx(b), y() + Fl::box_dy(b),
+               ww - Fl::box_dw(b), hh - Fl::box_dh(b));
+
+  draw_display();
 
   fl_pop_clip();
 } // draw()
@@ -1215,6 +1626,9 @@ Fl_Help_View::find(const char *s,               // I - String to find
   // Range check input and value...
   if (!s || !value_) return -1;
 
+  // The text must be completely formatted...
+  format_to(INT_MAX);
+
   if (p < 0 || p >= (int)strlen(value_)) p = 0;
 
   // Look for the string...
@@ -1268,95 +1682,212 @@ Fl_Help_View::find(const char *s,               // I - String to find
   return (-1);
 }
 
-/** Formats the help text. */
+/**
+  Formats the help text.
+
+  If progressive_layout() is on, only the text up to the bottom of the
+  view is formatted now, and the rest is formatted by an idle callback,
+  see format_run().
+*/
 void Fl_Help_View::format() {
+  Fl_Help_Layout *st = layout_;         // Layout state
+  Fl_Boxtype    b = box() ? box() : FL_DOWN_BOX;
+                                        // Box to draw...
+
+  DEBUG_FUNCTION(__LINE__,__FUNCTION__);
+
+  // All positions may change...
+  free_display();
+  Fl::remove_idle(format_cb, this);
+  st->ntables = 0;
+
+  // Reset document width...
+  int scrollsize = scrollbar_size_ ? scrollbar_size_ : Fl::scrollbar_size();
+  hsize_ = w() - scrollsize - Fl::box_dw(b);
+
+  st->width      = hsize_;
+  st->scrollsize = scrollsize;
+  st->color      = color();
+  st->defcolor   = textcolor();
+  st->length     = value_ ? (int)strlen(value_) : 0;
+  st->fresh      = 1;
+  st->initial    = initial_load;
+  st->active     = st->progressive && value_;
+  st->first_pass = 1;
+  st->provisional = 0;
+
+  if (format_run(topline_ + h(), 0))
+    return;
+
+  // Show what we have, and format the rest when there is nothing else to do...
+  st->first_pass = 0;
+  format_progress();
+  Fl::add_idle(format_cb, this);
+}
+
+
+/**
+  Formats the help text, continuing where the last call stopped.
+
+  If the layout is progressive, this stops as soon as the current block
+  starts below \p stop_y, or after \p budget bytes of text if \p budget
+  isn't 0, but never inside a table row. The blocks before the current one
+  are then complete and can be drawn. Otherwise all of the text is formatted.
+
+  \return 1 if the text is completely formatted, 0 otherwise
+*/
+int Fl_Help_View::format_run(int stop_y, int budget) {
+  Fl_Help_Layout *st = layout_;         // Layout state
   int           i;              // Looping var
-  int           done;           // Are we done yet?
-  Fl_Help_Block *block,         // Current block
+  int           &done = st->done;
+                                // Are we done yet?
+  Fl_Help_Block *&block = st->block,
+                                // Current block
                 *cell;          // Current table cell
-  int           cells[MAX_COLUMNS],
+  int           (&cells)[MAX_COLUMNS] = st->cells;
                                 // Cells in the current row...
-                row;            // Current table row (block number)
-  const char    *ptr,           // Pointer into block
+  int           &row = st->row; // Current table row (block number)
+  const char    *&ptr = st->ptr,
+                                // Pointer into block
                 *start,         // Pointer to start of element
-                *attrs;         // Pointer to start of element attributes
+                *attrs,         // Pointer to start of element attributes
+                *slice;         // Where this call started
+  int           resumed = 0;    // Continuing a layout?
+  Fl_Color      draw_textcolor = textcolor_;
+                                // textcolor_ of draw()
   HV_Edit_Buffer buf;           // Text buffer
   char          attr[1024],     // Attribute buffer
                 wattr[1024],    // Width attribute buffer
                 hattr[1024],    // Height attribute buffer
-                linkdest[1024]; // Link destination
-  int           xx, yy, ww, hh; // Size of current text fragment
-  int           line;           // Current line in block
-  int           links;          // Links for current line
-  Fl_Font       font;
-  Fl_Fontsize   fsize;          // Current font and size
-  Fl_Color      fcolor;         // Current font color
-  unsigned char border;         // Draw border?
-  int           talign,         // Current alignment
-                newalign,       // New alignment
-                head,           // In the <HEAD> section?
-                pre,            // <PRE> text?
-                needspace;      // Do we need whitespace?
-  int           table_width,    // Width of table
-                table_offset;   // Offset of table
-  int           column,         // Current table column number
-                columns[MAX_COLUMNS];
+                (&linkdest)[1024] = st->linkdest;
+                                // Link destination
+  int           &xx = st->xx, &yy = st->yy, &ww = st->ww, &hh = st->hh;
+                                // Size of current text fragment
+  int           &line = st->line;
+                                // Current line in block
+  int           &links = st->links;
+                                // Links for current line
+  Fl_Font       &font = st->font;
+  Fl_Fontsize   &fsize = st->fsize;
+                                // Current font and size
+  Fl_Color      &fcolor = st->fcolor;
+                                // Current font color
+  unsigned char &border = st->border;
+                                // Draw border?
+  int           &talign = st->talign,
+                                // Current alignment
+                &newalign = st->newalign,
+                                // New alignment
+                &head = st->head,
+                                // In the <HEAD> section?
+                &pre = st->pre, // <PRE> text?
+                &needspace = st->needspace;
+                                // Do we need whitespace?
+  int           &table_width = st->table_width,
+                                // Width of table
+                &table_offset = st->table_offset;
+                                // Offset of table
+  int           &column = st->column,
+                                // Current table column number
+                (&columns)[MAX_COLUMNS] = st->columns;
                                 // Column widths
-  Fl_Color      tc, rc;         // Table/row background color
-  Fl_Boxtype    b = box() ? box() : FL_DOWN_BOX;
-                                // Box to draw...
-  fl_margins    margins;        // Left margin stack...
+  Fl_Color      &tc = st->tc, &rc = st->rc;
+                                // Table/row background color
+  fl_margins    &margins = st->margins;
+                                // Left margin stack...
 
   DEBUG_FUNCTION(__LINE__,__FUNCTION__);
 
-  // Reset document width...
-  int scrollsize = scrollbar_size_ ? scrollbar_size_ : Fl::scrollbar_size();
-  hsize_ = w() - scrollsize - Fl::box_dw(b);
+  // The links will change...
+  display_->links_valid = 0;
+
+  slice = ptr;
+
+  if (!st->fresh) {
+    // Check the column widths that were guessed from the start of big
+    // tables, and start again if one of them was wrong...
+    if (st->provisional && !st->first_pass && check_tables()) {
+      st->fresh = 1;
+      hsize_    = st->width;
+      if (budget) {
+        budget = 0;
+        stop_y = topline_ + h();
+      }
+      free_display();
+    } else {
+      // Continue with the fonts and colors of the last call; draw()
+      // uses textcolor_ too...
+      fstack_ = st->fstack;
+      fstack_.top(font, fsize, fcolor);
+      fl_font(font, fsize);
+      draw_textcolor = textcolor_;
+      textcolor_     = st->textcolor;
+      resumed        = 1;
+    }
+  }
 
-  done = 0;
-  while (!done)
+  for (;;)
   {
-    // Reset state variables...
-    done       = 1;
-    nblocks_   = 0;
-    nlinks_    = 0;
-    ntargets_  = 0;
-    size_      = 0;
-    bgcolor_   = color();
-    textcolor_ = textcolor();
-    linkcolor_ = fl_contrast(FL_BLUE, color());
-
-    tc = rc = bgcolor_;
-
-    strcpy(title_, "Untitled");
-
-    if (!value_)
-      return;
-
-    // Setup for formatting...
-    initfont(font, fsize, fcolor);
-
-    line         = 0;
-    links        = 0;
-    xx           = margins.clear();
-    yy           = fsize + 2;
-    ww           = 0;
-    column       = 0;
-    border       = 0;
-    hh           = 0;
-    block        = add_block(value_, xx, yy, hsize_, 0);
-    row          = 0;
-    head         = 0;
-    pre          = 0;
-    talign       = LEFT;
-    newalign     = LEFT;
-    needspace    = 0;
-    linkdest[0]  = '\0';
-    table_offset = 0;
+    if (st->fresh)
+    {
+      // Reset state variables...
+      st->fresh  = 0;
+      done       = 1;
+      nblocks_   = 0;
+      nlinks_    = 0;
+      ntargets_  = 0;
+      size_      = 0;
+      bgcolor_   = color();
+      textcolor_ = textcolor();
+      linkcolor_ = fl_contrast(FL_BLUE, color());
+
+      tc = rc = bgcolor_;
+
+      strcpy(title_, "Untitled");
+
+      if (!value_) {
+        st->active = 0;
+        return 1;
+      }
+
+      // Setup for formatting...
+      initfont(font, fsize, fcolor);
+
+      line         = 0;
+      links        = 0;
+      xx           = margins.clear();
+      yy           = fsize + 2;
+      ww           = 0;
+      column       = 0;
+      border       = 0;
+      hh           = 0;
+      block        = add_block(value_, xx, yy, hsize_, 0);
+      row          = 0;
+      head         = 0;
+      pre          = 0;
+      talign       = LEFT;
+      newalign     = LEFT;
+      needspace    = 0;
+      linkdest[0]  = '\0';
+      table_offset = 0;
+      ptr          = value_;
+      slice        = ptr;
+    }
 
     // Html text character loop
-    for (ptr = value_, buf.clear(); *ptr;)
+    for (buf.clear(); *ptr;)
     {
+      // Stop when enough has been done; all blocks before the current one
+      // are complete outside of table rows...
+      if (st->active && !row && !buf.size() &&
+          (block->y > stop_y || (budget && ptr - slice > budget)))
+      {
+        st->fstack    = fstack_;
+        st->textcolor = textcolor_;
+        if (resumed) textcolor_ = draw_textcolor;
+        return 0;
+      }
+
       // End of word?
       if ((*ptr == '<' || isspace((*ptr)&255)) && buf.size() > 0)
       {
@@ -1559,7 +2090,7 @@ void Fl_Help_View::format() {
 
             block->h += fsize + 2;
 
-            format_table(&table_width, columns, start);
+            get_columns(&table_width, columns, start);
 
             if ((xx + table_width) > hsize_) {
 #ifdef DEBUG
@@ -2018,14 +2549,33 @@ void Fl_Help_View::format() {
 
     block->end = ptr;
     size_      = yy + hh;
+
+    if (done)
+      break;
+
+    // Start again with the new width...
+    st->fresh = 1;
+    free_display();
   }
 
 //  printf("margins.depth_=%d\n", margins.depth_);
 
+  st->active        = 0;
+  st->textcolor_end = textcolor_;
+
   if (ntargets_ > 1)
     qsort(targets_, ntargets_, sizeof(Fl_Help_Target),
           (compare_func_t)compare_targets);
 
+  format_scrollbars();
+  return 1;
+}
+
+
+/** Shows the scrollbars the document needs, and scrolls it into the view. */
+void Fl_Help_View::format_scrollbars() {
+  Fl_Boxtype    b = box() ? box() : FL_DOWN_BOX;
+                                // Box to draw...
   int dx = Fl::box_dw(b) - Fl::box_dx(b);
   int dy = Fl::box_dh(b) - Fl::box_dy(b);
   int ss = scrollbar_size_ ? scrollbar_size_ : Fl::scrollbar_size();
@@ -2059,7 +2609,14 @@ void Fl_Help_View::format() {
     }
   }
 
-  // Reset scrolling if it needs to be...
+  // Reset scrolling if it needs to be; size_ is only a guess while the
+  // layout isn't complete...
+  if (layout_->active) {
+    scrollbar_.value(topline_, h() - ss, 0, size_);
+    hscrollbar_.value(leftline_, w() - ss, 0, hsize_);
+    return;
+  }
+
   if (scrollbar_.visible()) {
     int temph = h() - Fl::box_dh(b);
     if (hscrollbar_.visible()) temph -= ss;
@@ -2075,13 +2632,22 @@ void Fl_Help_View::format() {
 }
 
 
-/** Formats a table */
-void
+/**
+  Formats a table.
+
+  If \p limit isn't NULL, the table is only scanned up to the first row
+  after \p limit, and the column widths are a guess.
+
+  \return 1 if the whole table was scanned, 0 otherwise
+*/
+int
 Fl_Help_View::format_table(int        *table_width,     // O - Total table width
                            int        *columns,         // O - Column widths
-                           const char *table)           // I - Pointer to start of table
+                           const char *table,           // I - Pointer to start of table
+                           const char *limit)           // I - Where to stop scanning or NULL
 {
-  int           column,                                 // Current column
+  int           complete = 1,                           // Scanned the whole table?
+                column,                                 // Current column
                 num_columns,                            // Number of columns
                 colspan,                                // COLSPAN attribute
                 width,                                  // Current width
@@ -2256,6 +2822,11 @@ Fl_Help_View::format_table(int        *table_width,     // O - Total table width
         if (buf.cmp("/TABLE"))
           break;
 
+        if (limit && ptr >= limit) {
+          complete = 0;
+          break;
+        }
+
         needspace = 0;
         column    = -1;
         width     = 0;
@@ -2418,7 +2989,7 @@ Fl_Help_View::format_table(int        *table_width,     // O - Total table width
 #endif // DEBUG
 
   if (num_columns == 0)
-    return;
+    return complete;
 
   // Add up the widths...
   for (column = 0, width = 0; column < num_columns; column ++)
@@ -2494,12 +3065,228 @@ Fl_Help_View::format_table(int        *table_width,     // O - Total table width
   for (column = 0; column < num_columns; column ++)
     printf("    columns[%d] = %d\n", column, columns[column]);
 #endif // DEBUG
+
+  return complete;
+}
+
+
+/**
+  Gets the column widths of a table for format_run().
+
+  A progressive layout caches the widths, and guesses the widths of big
+  tables for the first screen, see Fl_Help_Layout.
+*/
+void
+Fl_Help_View::get_columns(int        *table_width,      // O - Total table width
+                          int        *columns,          // O - Column widths
+                          const char *table)            // I - Pointer to start of table
+{
+  Fl_Help_Layout        *st = layout_;  // Layout state
+  HV_Table_Widths       *t;             // Cached widths
+  HV_Font_Stack         before;         // Fonts before the table
+  Fl_Font               font;
+  Fl_Fontsize           fsize;          // Current font and size
+  Fl_Color              fcolor;         // Current font color
+
+  if (!st->active) {
+    format_table(table_width, columns, table);
+    return;
+  }
+
+  before = fstack_;
+
+  if ((t = st->find(table, hsize_, before)) != NULL) {
+    // Same fonts and colors as after format_table()...
+    *table_width = t->table_width;
+    memcpy(columns, t->columns, sizeof(t->columns));
+    fstack_ = t->after;
+    fstack_.top(font, fsize, fcolor);
+    fl_font(font, fsize);
+    fl_color(fcolor);
+    return;
+  }
+
+  int complete = format_table(table_width, columns, table,
+                              st->first_pass ? table + HV_TABLE_GUESS : 0);
+
+  t = st->add();
+  t->table       = table;
+  t->hsize       = hsize_;
+  t->before      = before;
+  t->after       = fstack_;
+  t->provisional = !complete;
+  t->table_width = *table_width;
+  memcpy(t->columns, columns, sizeof(t->columns));
+
+  if (!complete) st->provisional = 1;
+}
+
+
+/**
+  Scans the tables whose column widths were guessed for the first screen.
+
+  \return 1 if a guess of the current layout was wrong, 0 otherwise
+*/
+int
+Fl_Help_View::check_tables()
+{
+  Fl_Help_Layout        *st = layout_;  // Layout state
+  HV_Table_Widths       *t;             // Cached widths
+  HV_Font_Stack         after;          // Fonts after the table
+  int                   i,              // Looping var
+                        changed = 0,    // Was a guess wrong?
+                        hsize = hsize_, // Width of the layout
+                        table_width,    // Width of table
+                        columns[MAX_COLUMNS];
+                                        // Column widths
+
+  for (i = st->ntables, t = st->tables; i > 0; i --, t ++) {
+    if (!t->provisional)
+      continue;
+
+    fstack_ = t->before;
+    hsize_  = t->hsize;
+    format_table(&table_width, columns, t->table);
+    after = fstack_;
+
+    // Only tables of this width are used by the current layout...
+    if (t->hsize == hsize &&
+        (table_width != t->table_width ||
+         memcmp(columns, t->columns, sizeof(columns)) ||
+         !after.same(t->after)))
+      changed = 1;
+
+    t->provisional = 0;
+    t->table_width = table_width;
+    memcpy(t->columns, columns, sizeof(columns));
+    t->after       = after;
+  }
+
+  st->provisional = 0;
+  hsize_          = hsize;
+
+  return changed;
+}
+
+
+/** Formats the text down to \p yy, if the layout isn't complete. */
+void
+Fl_Help_View::format_to(int yy)
+{
+  Fl_Help_Layout        *st = layout_;  // Layout state
+  char                  il = initial_load;
+
+  if (!st->active || st->block->y > yy)
+    return;
+
+  initial_load = st->initial;
+  int complete = format_run(yy, 0);
+  initial_load = il;
+
+  if (complete)
+    Fl::remove_idle(format_cb, this);
+  else
+    format_progress();
+}
+
+
+/** Formats the next part of the text, see progressive_layout(). */
+void
+Fl_Help_View::format_cb(void *v)
+{
+  Fl_Help_View          *hv = (Fl_Help_View *)v;
+  char                  il = initial_load;
+
+  initial_load = hv->layout_->initial;
+  int complete = hv->format_run(INT_MAX, HV_FORMAT_SLICE);
+  initial_load = il;
+
+  if (complete)
+    Fl::remove_idle(format_cb, v);
+  else
+    hv->format_progress();
+}
+
+
+/**
+  Updates the scrollbars while the layout goes on, and shows the new blocks.
+  The document height is estimated from the part that is formatted.
+*/
+void
+Fl_Help_View::format_progress()
+{
+  Fl_Help_Layout        *st = layout_;  // Layout state
+  int                   done = (int)(st->ptr - value_);
+                                        // Bytes formatted so far
+
+  size_ = st->block->y;
+  if (done > 0 && done < st->length)
+    size_ = (int)((double)size_ * st->length / done);
+
+  format_scrollbars();
+  redraw();
+}
+
+
+/**
+  Turns the progressive layout on or off.
+
+  By default, value(), load(), resize(), textfont() and textsize() format
+  all of the text before they return, which takes a long time for big
+  documents. A progressive layout only formats the text down to the bottom
+  of the view before they return, so the first screen can be drawn at once.
+  The rest of the text is formatted in steps by an idle callback (see
+  Fl::add_idle()), and the scrollbar uses an estimated document height
+  until the layout is complete. A resize() that doesn't change the width
+  doesn't format the text again.
+
+  Methods that need more of the layout, like topline(), find() and
+  topline(const char*), format as much of the text as they need first.
+  Note that a single block of text, like a long \<PRE\> section, is always
+  formatted at once.
+
+  Turning the progressive layout off completes the current layout.
+
+  \param[in] on non-zero to turn the progressive layout on
+  \see formatting()
+*/
+void
+Fl_Help_View::progressive_layout(int on)
+{
+  layout_->progressive = (char)(on != 0);
+  if (!on) format_to(INT_MAX);
+}
+
+
+/**
+  Returns non-zero if the progressive layout is on.
+  \see progressive_layout(int)
+*/
+int
+Fl_Help_View::progressive_layout() const
+{
+  return layout_->progressive;
+}
+
+
+/**
+  Returns non-zero while the text isn't completely formatted.
+  This can only happen if progressive_layout() is on.
+*/
+int
+Fl_Help_View::formatting() const
+{
+  return layout_->active;
 }
 
 
 /** Frees memory used for the document. */
 void
 Fl_Help_View::free_data() {
+  // Stop the layout...
+  Fl::remove_idle(format_cb, this);
+  layout_->active = 0;
+
   // Release all images...
   if (value_) {
     const char  *ptr,           // Pointer into block
@@ -2571,6 +3358,8 @@ Fl_Help_View::free_data() {
   }
 
   // Free all of the arrays...
+  free_display();
+
   if (nblocks_) {
     free(blocks_);
 
@@ -2869,6 +3658,23 @@ Fl_Help_Link *Fl_Help_View::find_link(int xx, int yy)
 {
   int           i;
   Fl_Help_Link  *linkp;
+  Fl_Help_Display_List *dl = display_;
+
+  if (!dl->links_valid)
+    dl->index_links(links_, nlinks_);
+
+  if (yy >= 0 && yy / dl->LINK_BAND < dl->nbands) {
+    // Only test the links in the band of yy, in document order...
+    int b = yy / dl->LINK_BAND;
+    for (i = dl->link_first[b]; i < dl->link_first[b + 1]; i ++) {
+      linkp = links_ + dl->link_index[i];
+      if (xx >= linkp->x && xx < linkp->w &&
+          yy >= linkp->y && yy < linkp->h)
+        return linkp;
+    }
+    return 0L;
+  }
+
   for (i = nlinks_, linkp = links_; i > 0; i --, linkp ++) {
     if (xx >= linkp->x && xx < linkp->w &&
         yy >= linkp->y && yy < linkp->h)
@@ -2964,16 +3770,12 @@ char Fl_Help_View::begin_selection()
 {
   clear_global_selection();
 
-  if (!fl_help_view_buffer) fl_help_view_buffer = fl_create_offscreen(1, 1);
-
   mouse_x = Fl::event_x();
   mouse_y = Fl::event_y();
   draw_mode = 1;
 
-    current_view = this;
-    fl_begin_offscreen(fl_help_view_buffer);
-    draw();
-    fl_end_offscreen();
+  current_view = this;
+  draw_display();
 
   draw_mode = 0;
 
@@ -2996,9 +3798,7 @@ char Fl_Help_View::extend_selection()
   mouse_y = Fl::event_y();
   draw_mode = 2;
 
-    fl_begin_offscreen(fl_help_view_buffer);
-    draw();
-    fl_end_offscreen();
+  draw_display();
 
   draw_mode = 0;
 
@@ -3249,6 +4049,8 @@ Fl_Help_View::Fl_Help_View(int        xx,       // I - Left position
   ablocks_      = 0;
   nblocks_      = 0;
   blocks_       = (Fl_Help_Block *)0;
+  display_      = new Fl_Help_Display_List;
+  layout_       = new Fl_Help_Layout;
 
   link_         = (Fl_Help_Func *)0;
 
@@ -3294,6 +4096,8 @@ Fl_Help_View::~Fl_Help_View()
 {
   clear_selection();
   free_data();
+  delete display_;
+  delete layout_;
 }
 
 
@@ -3462,7 +4266,19 @@ Fl_Help_View::resize(int xx,    // I - New left position
                      y() + h() - scrollsize - Fl::box_dh(b) + Fl::box_dy(b),
                      w() - scrollsize - Fl::box_dw(b), scrollsize);
 
-  format();
+  // The layout only depends on the width and the colors...
+  Fl_Help_Layout *st = layout_;
+  if (!value_ || w() - scrollsize - Fl::box_dw(b) != st->width ||
+      scrollsize != st->scrollsize || color() != st->color ||
+      textcolor() != st->defcolor) {
+    format();
+  } else if (st->active) {
+    format_to(topline_ + h());
+    if (st->active) format_scrollbars();
+  } else {
+    textcolor_ = st->textcolor_end;
+    format_scrollbars();
+  }
 }
 
 
@@ -3477,6 +4293,8 @@ Fl_Help_View::topline(const char *n)    // I - Target name
                 *target;                // Pointer to matching target
 
 
+  format_to(INT_MAX);
+
   if (ntargets_ == 0)
     return;
 
@@ -3503,6 +4321,8 @@ Fl_Help_View::topline(int top)  // I - Top line number
   if (!value_)
     return;
 
+  format_to(top + h());
+
   int scrollsize = scrollbar_size_ ? scrollbar_size_ : Fl::scrollbar_size();
   if (size_ < (h() - scrollsize) || top < 0)
     top = 0;
@@ -23,6 +23,7 @@
 
 #include <FL/Fl.H>
 #include <FL/Fl_Menu_.H>
+#include <FL/fl_utf8.h>
 #include "flstring.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -278,6 +279,167 @@ int Fl_Menu_::value(const Fl_Menu_Item* m) {
   return 0;
 }
 
+////////////////////////////////////////////////////////////////
+// Index of the item shortcuts of a menu
+
+// Same as in Fl_Menu.cxx: skips submenu contents, but not invisible items.
+static const Fl_Menu_Item* next_visible_or_not(const Fl_Menu_Item* m) {
+  int nest = 0;
+  do {
+    if (!m->text) {
+      if (!nest) return m;
+      nest--;
+    } else if (m->flags&FL_SUBMENU) {
+      nest++;
+    }
+    m++;
+  }
+  while (nest);
+  return m;
+}
+
+/*
+  The index lists all items with a shortcut and all submenu titles in the
+  order Fl_Menu_Item::test_shortcut() gives them priority: first the items
+  of a menu level, then the contents of each of its submenus. The items
+  with a shortcut are also linked in hash chains by their lower case key,
+  so that the matching item with the lowest position wins, as in the
+  recursive search. The active state of the items is checked when the
+  index is searched, so it needn't be rebuilt when items are deactivated.
+*/
+class Fl_Menu_::Shortcut_Index {
+  struct Node {
+    const Fl_Menu_Item *item;
+    int parent;         // submenu title, or -1
+    int next;           // next node with the same hash, or -1
+  };
+  Node *nodes;
+  int count, alloc;
+  int *buckets, nbuckets;
+
+  static unsigned hash_key(unsigned key) {
+    return (unsigned)fl_tolower(key & FL_KEY_MASK);
+  }
+  int add(const Fl_Menu_Item *item, int parent) {
+    if (count >= alloc) {
+      alloc = alloc ? 2 * alloc : 64;
+      nodes = (Node*)realloc(nodes, alloc * sizeof(Node));
+    }
+    nodes[count].item = item;
+    nodes[count].parent = parent;
+    nodes[count].next = -1;
+    return count++;
+  }
+  void add_menu(const Fl_Menu_Item *m, int parent) {
+    int first = count;
+    const Fl_Menu_Item *i;
+    for (i = m; i && i->text; i = next_visible_or_not(i)) {
+      if (i->shortcut_ || i->submenu()) add(i, parent);
+    }
+    int last = count;
+    for (int n = first; n < last; n++) {
+      i = nodes[n].item;
+      if (i->submenu())
+        add_menu((i->flags & FL_SUBMENU) ? i + 1 : (const Fl_Menu_Item*)i->user_data_, n);
+    }
+  }
+  int usable(int n) const { // the item and all its submenu titles are active
+    for (; n >= 0; n = nodes[n].parent)
+      if (!nodes[n].item->active()) return 0;
+    return 1;
+  }
+  int find(unsigned key) const {
+    for (int n = buckets[hash_key(key) & (nbuckets - 1)]; n >= 0; n = nodes[n].next) {
+      if (Fl::test_shortcut(nodes[n].item->shortcut_) && usable(n)) return n;
+    }
+    return -1;
+  }
+public:
+  const Fl_Menu_Item *menu;     // the menu array the index was built for
+  Shortcut_Index() : nodes(0), count(0), alloc(0), buckets(0), nbuckets(0), menu(0) { }
+  ~Shortcut_Index() { free(nodes); free(buckets); }
+  void build(const Fl_Menu_Item *m) {
+    count = 0;
+    menu = m;
+    add_menu(m, -1);
+    for (nbuckets = 16; nbuckets < count; nbuckets *= 2) { }
+    buckets = (int*)realloc(buckets, nbuckets * sizeof(int));
+    int n;
+    for (n = 0; n < nbuckets; n++) buckets[n] = -1;
+    // link the chains from the end, so that they are sorted by priority
+    for (n = count - 1; n >= 0; n--) {
+      if (!nodes[n].item->shortcut_) continue;
+      int *b = buckets + (hash_key(nodes[n].item->shortcut_) & (nbuckets - 1));
+      nodes[n].next = *b;
+      *b = n;
+    }
+  }
+  const Fl_Menu_Item *find() const {
+    // Fl::test_shortcut() compares the key of a shortcut with the key code,
+    // with the first character of the text of the event, and for ctrl-keys
+    // with that character xor 0x40; these keys name the chains to search
+    unsigned c = fl_utf8decode(Fl::event_text(), Fl::event_text() + Fl::event_length(), 0);
+    int m1 = find(Fl::event_key());
+    int m2 = find(c);
+    int m3 = (Fl::event_state() & FL_CTRL) ? find(c ^ 0x40) : -1;
+    int n = m1;
+    if (m2 >= 0 && (n < 0 || m2 < n)) n = m2;
+    if (m3 >= 0 && (n < 0 || m3 < n)) n = m3;
+    return n >= 0 ? nodes[n].item : 0;
+  }
+};
+
+/**
+  Returns the menu item with the entered shortcut (key value).
+
+  This searches the complete menu() for a shortcut that matches the
+  entered key value.  It must be called for a FL_KEYBOARD or FL_SHORTCUT
+  event.
+
+  If a match is found, the menu's callback will be called.
+
+  \return matched Fl_Menu_Item or NULL.
+  \see shortcut_index(int)
+*/
+const Fl_Menu_Item* Fl_Menu_::test_shortcut() {
+  if (!shortcut_index_ || !menu_) return picked(menu()->test_shortcut());
+  if (shortcut_index_->menu != menu_) shortcut_index_->build(menu_);
+  return picked(shortcut_index_->find());
+}
+
+/**
+  Makes test_shortcut() use an index of the item shortcuts.
+
+  test_shortcut() searches all items of the menu and its submenus for
+  each keystroke. This is fast enough for usual menus, but menus with
+  thousands of items may slow down keyboard input. With the index,
+  only items with the key of the keystroke are tested. The result is
+  the same.
+
+  The index is updated when the menu is changed by methods of Fl_Menu_,
+  such as add(), insert(), remove(), shortcut() and mode(), but not
+  when shortcuts of items or the structure of a menu array given to
+  menu() are changed otherwise. Call shortcut_index(1) after such
+  changes to rebuild the index.
+
+  \param[in] on non-zero to use the index, 0 to search the menu
+  \since 1.4.0
+*/
+void Fl_Menu_::shortcut_index(int on) {
+  if (on) {
+    if (!shortcut_index_) shortcut_index_ = new Shortcut_Index;
+    shortcut_index_changed_();
+  } else {
+    delete shortcut_index_;
+    shortcut_index_ = 0;
+  }
+}
+
+// Marks the shortcut index as outdated, it is rebuilt by the next test_shortcut().
+void Fl_Menu_::shortcut_index_changed_() {
+  if (shortcut_index_) shortcut_index_->menu = 0;
+}
+
 /**
  When user picks a menu item, call this.  It will do the callback.
  Unfortunately this also casts away const for the checkboxes, but this
@@ -388,6 +550,7 @@ Fl_Menu_::Fl_Menu_(int X,int Y,int W,int H,const char* l)
   when(FL_WHEN_RELEASE_ALWAYS);
   value_ = menu_ = 0;
   alloc = 0;
+  shortcut_index_ = 0;
   selection_color(FL_SELECTION_COLOR);
   textfont(FL_HELVETICA);
   textsize(FL_NORMAL_SIZE);
@@ -440,6 +603,7 @@ void Fl_Menu_::copy(const Fl_Menu_Item* m, void* ud) {
 
 Fl_Menu_::~Fl_Menu_() {
   clear();
+  delete shortcut_index_;
 }
 
 // Fl_Menu::add() uses this to indicate the owner of the dynamically-
@@ -464,6 +628,7 @@ void Fl_Menu_::clear() {
   }
   menu_ = 0;
   value_ = 0;
+  shortcut_index_changed_();
 }
 
 /**
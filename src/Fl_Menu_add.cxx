@@ -402,6 +402,7 @@ int Fl_Menu_::insert(
   int value_offset = (int) (value_-menu_);
   menu_ = local_array; // in case it reallocated it
   if (value_) value_ = menu_+value_offset;
+  shortcut_index_changed_();
   return r;
 }
 
@@ -484,6 +485,7 @@ void Fl_Menu_::remove(int i) {
   }
   // MRS: "n" is the menu size(), which includes the trailing NULL entry...
   memmove(item, next_item, (menu_+n-next_item)*sizeof(Fl_Menu_Item));
+  shortcut_index_changed_();
 }
 
 /**
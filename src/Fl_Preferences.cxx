@@ -24,6 +24,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <sys/stat.h>
 #include <FL/fl_utf8.h>
 #include <FL/fl_string.h>
 #include "flstring.h"
@@ -839,10 +840,52 @@ char Fl_Preferences::getUserdataPath( char *path, int pathlen ) {
  Writes all preferences to disk. This function works only with
  the base preferences group. This function is rarely used as
  deleting the base preferences flushes automatically.
+
+ If a flush delay was set, the file is written when the delay
+ expires instead.
+
+ \see flush_delay(double)
  */
 void Fl_Preferences::flush() {
-  if ( rootNode && node->dirty() )
-    rootNode->write();
+  if ( rootNode && node->dirty() ) {
+    if ( rootNode->flushDelay() > 0.0 )
+      rootNode->scheduleFlush();
+    else
+      rootNode->write();
+  }
+}
+
+/**
+ Writes changes to disk automatically, a while after they were made.
+
+ Once a delay is set, the first change to the preferences database
+ starts a timer, and the file is written when the timer expires.
+ All changes that are made in the meantime, and all calls of flush(),
+ are written together. This keeps the file on disk current without
+ writing it for every single change, and needs a running FLTK event
+ loop. Deleting the base preferences still writes all changes at once.
+
+ Setting the delay to 0 (the default) turns automatic writing off and
+ writes pending changes immediately.
+
+ The file is always written to a temporary file first, which then
+ replaces the previous file, so that a crash while writing never
+ leaves a truncated preferences file behind.
+
+ \param[in] seconds delay between the first change and writing the file
+ \see flush()
+ */
+void Fl_Preferences::flush_delay(double seconds) {
+  if ( rootNode )
+    rootNode->flushDelay( seconds );
+}
+
+/**
+ Returns the delay set by flush_delay(double), or 0 if changes are
+ only written by flush() and when deleting the base preferences.
+ */
+double Fl_Preferences::flush_delay() {
+  return rootNode ? rootNode->flushDelay() : 0.0;
 }
 
 //-----------------------------------------------------------------------------
@@ -909,7 +952,9 @@ Fl_Preferences::RootNode::RootNode( Fl_Preferences *prefs, Root root, const char
   filename_(0L),
   vendor_(0L),
   application_(0L),
-  root_(root)
+  root_(root),
+  flushDelay_(0.0),
+  flushPending_(0)
 {
   char *filename = Fl::system_driver()->preference_rootnode(prefs, root, vendor, application);
   filename_    = filename ? fl_strdup(filename) : 0L;
@@ -925,7 +970,9 @@ Fl_Preferences::RootNode::RootNode( Fl_Preferences *prefs, const char *path, con
   filename_(0L),
   vendor_(0L),
   application_(0L),
-  root_(Fl_Preferences::USER)
+  root_(Fl_Preferences::USER),
+  flushDelay_(0.0),
+  flushPending_(0)
 {
 
   if (!vendor)
@@ -950,12 +997,18 @@ Fl_Preferences::RootNode::RootNode( Fl_Preferences *prefs )
   filename_(0L),
   vendor_(0L),
   application_(0L),
-  root_(Fl_Preferences::USER)
+  root_(Fl_Preferences::USER),
+  flushDelay_(0.0),
+  flushPending_(0)
 {
 }
 
 // destroy the root node and all depending nodes
 Fl_Preferences::RootNode::~RootNode() {
+  if ( flushPending_ )
+    Fl::remove_timeout( flushTimeoutCB, this );
+  flushDelay_ = 0.0;
+  flushPending_ = 0;
   if ( prefs_->node->dirty() )
     write();
   if ( filename_ ) {
@@ -1034,14 +1087,39 @@ int Fl_Preferences::RootNode::write() {
   if ( ((root_&Fl_Preferences::ROOT_MASK)==Fl_Preferences::SYSTEM) && !(fileAccess_ & Fl_Preferences::SYSTEM_WRITE_OK) )
     return -1;
   fl_make_path_for_file(filename_);
-  FILE *f = fl_fopen( filename_, "wb" );
-  if ( !f )
+  // write a temporary file and replace the old file only when it is complete,
+  // so that a crash or a full disk never leaves a truncated file behind
+  size_t len = strlen( filename_ ) + 5;
+  char *tmpname = (char*)malloc( len );
+  snprintf( tmpname, len, "%s.tmp", filename_ );
+  FILE *f = fl_fopen( tmpname, "wb" );
+  if ( !f ) {
+    free( tmpname );
     return -1;
+  }
   fprintf( f, "; FLTK preferences file format 1.0\n" );
   fprintf( f, "; vendor: %s\n", vendor_ );
   fprintf( f, "; application: %s\n", application_ );
   prefs_->node->write( f );
-  fclose( f );
+  int err = ferror( f );
+  if ( fclose( f ) != 0 ) err = 1;
+  if ( !err ) {
+    struct stat st;             // keep the permissions of the old file
+    if ( fl_stat( filename_, &st ) == 0 )
+      fl_chmod( tmpname, st.st_mode & 07777 );
+    if ( fl_rename( tmpname, filename_ ) != 0 ) {
+      // some systems can't rename over an existing file
+      fl_unlink( filename_ );
+      err = fl_rename( tmpname, filename_ );
+    }
+  }
+  if ( err ) {
+    fl_unlink( tmpname );
+    free( tmpname );
+    prefs_->node->setDirty();   // try again next time
+    return -1;
+  }
+  free( tmpname );
   if (Fl::system_driver()->preferences_need_protection_check()) {
     // unix: make sure that system prefs are user-readable
     if (strncmp(filename_, "/etc/fltk/", 10) == 0) {
@@ -1110,6 +1188,37 @@ char Fl_Preferences::RootNode::getPath( char *path, int pathlen ) {
   return ret;
 }
 
+// start the timer that writes the file after a change, see flush_delay()
+void Fl_Preferences::RootNode::scheduleFlush() {
+  if ( flushDelay_ > 0.0 && !flushPending_ ) {
+    flushPending_ = 1;
+    Fl::add_timeout( flushDelay_, flushTimeoutCB, this );
+  }
+}
+
+// write all changes made since the timer was started
+void Fl_Preferences::RootNode::flushTimeoutCB( void *v ) {
+  RootNode *r = (RootNode*)v;
+  r->flushPending_ = 0;
+  if ( r->prefs_->node->dirty() )
+    r->write();
+}
+
+// set the delay for writing changes, 0 writes pending changes now
+void Fl_Preferences::RootNode::flushDelay( double seconds ) {
+  if ( flushPending_ ) {
+    Fl::remove_timeout( flushTimeoutCB, this );
+    flushPending_ = 0;
+  }
+  flushDelay_ = seconds > 0.0 ? seconds : 0.0;
+  if ( prefs_->node->dirty() ) {
+    if ( flushDelay_ > 0.0 )
+      scheduleFlush();
+    else
+      write();
+  }
+}
+
 // create a node that represents a group
 // - path must be a single word, prferable alnum(), dot and underscore only. Space is ok.
 Fl_Preferences::Node::Node( const char *path ) {
@@ -1122,6 +1231,10 @@ Fl_Preferences::Node::Node( const char *path ) {
   indexed_ = 0;
   index_ = 0;
   nIndex_ = NIndex_ = 0;
+  entryHash_ = 0;
+  NEntryHash_ = 0;
+  childHash_ = 0;
+  nChildHash_ = NChildHash_ = 0;
 }
 
 void Fl_Preferences::Node::deleteAllChildren() {
@@ -1131,7 +1244,8 @@ void Fl_Preferences::Node::deleteAllChildren() {
     delete nd;
   }
   child_ = 0L;
-  dirty_ = 1;
+  deleteChildHash();
+  setDirty();
   updateIndex();
 }
 
@@ -1152,7 +1266,8 @@ void Fl_Preferences::Node::deleteAllEntries() {
     nEntry_ = 0;
     NEntry_ = 0;
   }
-  dirty_ = 1;
+  deleteEntryHash();
+  setDirty();
 }
 
 // delete this and all depending nodes
@@ -1160,6 +1275,7 @@ Fl_Preferences::Node::~Node() {
   deleteAllChildren();
   deleteAllEntries();
   deleteIndex();
+  deleteChildHash();
   if ( path_ ) {
     free( path_ );
     path_ = 0L;
@@ -1176,6 +1292,14 @@ char Fl_Preferences::Node::dirty() {
   return 0;
 }
 
+// mark this node as changed, and have the file written later if a flush
+// delay is set
+void Fl_Preferences::Node::setDirty() {
+  dirty_ = 1;
+  RootNode *r = findRoot();
+  if ( r ) r->scheduleFlush();
+}
+
 // recursively clear all dirty flags
 void Fl_Preferences::Node::clearDirtyFlags() {
   Fl_Preferences::Node *nd = this;
@@ -1227,6 +1351,7 @@ void Fl_Preferences::Node::setParent( Node *pn ) {
   sprintf( nameBuffer, "%s/%s", pn->path_, path_ );
   free( path_ );
   path_ = fl_strdup( nameBuffer );
+  pn->addChildHash( this );
 }
 
 // find the corresponding root node
@@ -1253,18 +1378,17 @@ Fl_Preferences::Node *Fl_Preferences::Node::addChild( const char *path ) {
 // create and set, or change an entry within this node
 void Fl_Preferences::Node::set( const char *name, const char *value )
 {
-  for ( int i=0; i<nEntry_; i++ ) {
-    if ( strcmp( name, entry_[i].name ) == 0 ) {
-      if ( !value ) return; // annotation
-      if ( strcmp( value, entry_[i].value ) != 0 ) {
-        if ( entry_[i].value )
-          free( entry_[i].value );
-        entry_[i].value = fl_strdup( value );
-        dirty_ = 1;
-      }
-      lastEntrySet = i;
-      return;
+  int i = getEntry( name );
+  if ( i >= 0 ) {
+    if ( !value ) return; // annotation
+    if ( strcmp( value, entry_[i].value ) != 0 ) {
+      if ( entry_[i].value )
+        free( entry_[i].value );
+      entry_[i].value = fl_strdup( value );
+      setDirty();
     }
+    lastEntrySet = i;
+    return;
   }
   if ( NEntry_==nEntry_ ) {
     NEntry_ = NEntry_ ? NEntry_*2 : 10;
@@ -1274,7 +1398,8 @@ void Fl_Preferences::Node::set( const char *name, const char *value )
   entry_[ nEntry_ ].value = value?fl_strdup(value):0;
   lastEntrySet = nEntry_;
   nEntry_++;
-  dirty_ = 1;
+  addEntryHash( nEntry_-1 );
+  setDirty();
 }
 
 // create or set a value (or annotation) from a single line in the file buffer
@@ -1318,6 +1443,16 @@ const char *Fl_Preferences::Node::get( const char *name ) {
 
 // find the index of an entry, returns -1 if no such entry
 int Fl_Preferences::Node::getEntry( const char *name ) {
+  if ( nEntry_ > HASH_MIN_SIZE && !entryHash_ )
+    createEntryHash();
+  if ( entryHash_ ) {
+    unsigned h = hashName( name, (int) strlen( name ) );
+    for ( ;; h++ ) {
+      int i = entryHash_[ h & (NEntryHash_-1) ];
+      if ( i < 0 ) return -1;
+      if ( strcmp( name, entry_[i].name ) == 0 ) return i;
+    }
+  }
   for ( int i=0; i<nEntry_; i++ ) {
     if ( strcmp( name, entry_[i].name ) == 0 ) {
       return i;
@@ -1332,7 +1467,8 @@ char Fl_Preferences::Node::deleteEntry( const char *name ) {
   if ( ix == -1 ) return 0;
   memmove( entry_+ix, entry_+ix+1, (nEntry_-ix-1) * sizeof(Entry) );
   nEntry_--;
-  dirty_ = 1;
+  deleteEntryHash(); // the indices have changed, rebuilt when needed
+  setDirty();
   return 1;
 }
 
@@ -1346,17 +1482,23 @@ Fl_Preferences::Node *Fl_Preferences::Node::find( const char *path ) {
       return this;
     if ( path[ len ] == '/' ) {
       Node *nd;
-      for ( nd = child_; nd; nd = nd->next_ ) {
-        Node *nn = nd->find( path );
-        if ( nn ) return nn;
-      }
       const char *s = path+len+1;
       const char *e = strchr( s, '/' );
+      int n = e ? (int)(e-s) : (int) strlen( s );
+      if ( n < (int)sizeof(nameBuffer)-1 ) {
+        nd = findChild( s, n );
+        if ( nd ) return nd->find( path );
+      } else { // names this long are truncated, compare the whole path
+        for ( nd = child_; nd; nd = nd->next_ ) {
+          Node *nn = nd->find( path );
+          if ( nn ) return nn;
+        }
+      }
       if (e) strlcpy( nameBuffer, s, e-s+1 );
       else strlcpy( nameBuffer, s, sizeof(nameBuffer));
       nd = new Node( nameBuffer );
       nd->setParent( this );
-      dirty_ = 1;
+      setDirty();
       return nd->find( path );
     }
   }
@@ -1392,6 +1534,13 @@ Fl_Preferences::Node *Fl_Preferences::Node::search( const char *path, int offset
     if ( len > 0 && path[ len ] == 0 )
       return this;
     if ( len <= 0 || path[ len ] == '/' ) {
+      const char *s = len <= 0 ? path : path+len+1;
+      const char *e = strchr( s, '/' );
+      int n = e ? (int)(e-s) : (int) strlen( s );
+      if ( n < (int)sizeof(nameBuffer)-1 ) {
+        Node *nd = findChild( s, n );
+        return nd ? nd->search( path, offset ) : 0;
+      }
       for ( Node *nd = child_; nd; nd = nd->next_ ) {
         Node *nn = nd->search( path, offset );
         if ( nn ) return nn;
@@ -1466,7 +1615,8 @@ char Fl_Preferences::Node::remove() {
         break;
       }
     }
-    parent()->dirty_ = 1;
+    parent()->deleteChildHash();
+    parent()->setDirty();
     parent()->updateIndex();
   }
   delete this;
@@ -1500,6 +1650,105 @@ void Fl_Preferences::Node::deleteIndex() {
   indexed_ = 0;
 }
 
+// Groups with more than HASH_MIN_SIZE entries or children find them by
+// name through open addressing hash tables. The tables are built when
+// they are first needed and deleted when an entry or child is removed.
+
+unsigned Fl_Preferences::Node::hashName( const char *name, int len ) {
+  unsigned h = 2166136261U;
+  while ( len-- > 0 ) h = ( h ^ (unsigned char)*name++ ) * 16777619U;
+  return h;
+}
+
+// build the hash table of all entries
+void Fl_Preferences::Node::createEntryHash() {
+  deleteEntryHash();
+  NEntryHash_ = 64;
+  while ( NEntryHash_ < 4*nEntry_ ) NEntryHash_ *= 2;
+  entryHash_ = (int*)malloc( NEntryHash_ * sizeof(int) );
+  for ( int i=0; i<NEntryHash_; i++ ) entryHash_[i] = -1;
+  for ( int i=0; i<nEntry_; i++ ) {
+    const char *name = entry_[i].name;
+    unsigned h = hashName( name, (int) strlen( name ) );
+    while ( entryHash_[ h & (NEntryHash_-1) ] >= 0 ) h++;
+    entryHash_[ h & (NEntryHash_-1) ] = i;
+  }
+}
+
+// add the new entry ix to the hash table, if the group needs one
+void Fl_Preferences::Node::addEntryHash( int ix ) {
+  if ( !entryHash_ && nEntry_ <= HASH_MIN_SIZE ) return;
+  if ( !entryHash_ || 2*nEntry_ > NEntryHash_ ) {
+    createEntryHash();
+    return;
+  }
+  const char *name = entry_[ix].name;
+  unsigned h = hashName( name, (int) strlen( name ) );
+  while ( entryHash_[ h & (NEntryHash_-1) ] >= 0 ) h++;
+  entryHash_[ h & (NEntryHash_-1) ] = ix;
+}
+
+void Fl_Preferences::Node::deleteEntryHash() {
+  if ( entryHash_ ) free( entryHash_ );
+  entryHash_ = 0;
+  NEntryHash_ = 0;
+}
+
+// build the hash table of all child groups
+void Fl_Preferences::Node::createChildHash() {
+  deleteChildHash();
+  for ( Node *nd = child_; nd; nd = nd->next_ ) nChildHash_++;
+  NChildHash_ = 64;
+  while ( NChildHash_ < 4*nChildHash_ ) NChildHash_ *= 2;
+  childHash_ = (Node**)calloc( NChildHash_, sizeof(Node*) );
+  for ( Node *nd = child_; nd; nd = nd->next_ ) {
+    const char *name = nd->name();
+    unsigned h = hashName( name, (int) strlen( name ) );
+    while ( childHash_[ h & (NChildHash_-1) ] ) h++;
+    childHash_[ h & (NChildHash_-1) ] = nd;
+  }
+}
+
+// add the new child group nd to the hash table if there is one
+void Fl_Preferences::Node::addChildHash( Node *nd ) {
+  if ( !childHash_ ) return;
+  if ( 2*(nChildHash_+1) > NChildHash_ ) {
+    createChildHash();
+    return;
+  }
+  const char *name = nd->name();
+  unsigned h = hashName( name, (int) strlen( name ) );
+  while ( childHash_[ h & (NChildHash_-1) ] ) h++;
+  childHash_[ h & (NChildHash_-1) ] = nd;
+  nChildHash_++;
+}
+
+void Fl_Preferences::Node::deleteChildHash() {
+  if ( childHash_ ) free( childHash_ );
+  childHash_ = 0;
+  nChildHash_ = NChildHash_ = 0;
+}
+
+// find the child group with the given name of len characters
+Fl_Preferences::Node *Fl_Preferences::Node::findChild( const char *name, int len ) {
+  if ( !childHash_ ) {
+    int n = 0;
+    for ( Node *nd = child_; nd; nd = nd->next_, n++ ) {
+      const char *nn = nd->name();
+      if ( strncmp( nn, name, len ) == 0 && nn[len] == 0 ) return nd;
+    }
+    if ( n > HASH_MIN_SIZE ) createChildHash(); // for the next search
+    return 0;
+  }
+  unsigned h = hashName( name, len );
+  for ( ;; h++ ) {
+    Node *nd = childHash_[ h & (NChildHash_-1) ];
+    if ( !nd ) return 0;
+    const char *nn = nd->name();
+    if ( strncmp( nn, name, len ) == 0 && nn[len] == 0 ) return nd;
+  }
+}
+
 /**
  \brief Create a plugin.
 
@@ -0,0 +1,788 @@
+//
+// Implementation of class Fl_Recording_Surface in the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2021 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+// A drawing surface storing the calls to the graphics driver in memory
+// to send them again to another graphics driver, and the cache that draws
+// widgets through such recordings when they are only exposed.
+
+#include <config.h>
+#include <FL/Fl_Recording_Surface.H>
+#include <FL/Fl_Image_Surface.H>
+#include <FL/Fl_Image.H>
+#include <FL/Fl_Graphics_Driver.H>
+#include <FL/Fl_Group.H>
+#include <FL/Fl.H>
+#include <FL/fl_draw.H>
+#include <stdlib.h>
+#include <string.h>
+
+// Each command is an opcode byte followed by its arguments, stored
+// without padding. Coordinates are stored after the origin of the
+// surface was applied, vertices after the transformation matrix was
+// applied, so that the replay needs no state but the target driver's.
+enum {
+  REC_POINT = 1, REC_RECT, REC_FOCUS_RECT, REC_RECTF, REC_COLORED_RECTF,
+  REC_LINE, REC_LINE3, REC_XYLINE, REC_XYLINE4, REC_XYLINE5,
+  REC_YXLINE, REC_YXLINE4, REC_YXLINE5, REC_LOOP3, REC_LOOP4,
+  REC_POLYGON3, REC_POLYGON4, REC_PUSH_CLIP, REC_PUSH_NO_CLIP, REC_POP_CLIP,
+  REC_CLIP_NONE, REC_BEGIN_POINTS, REC_BEGIN_LINE, REC_BEGIN_LOOP,
+  REC_BEGIN_POLYGON, REC_BEGIN_COMPLEX_POLYGON, REC_VERTEX, REC_END_POINTS,
+  REC_END_LINE, REC_END_LOOP, REC_END_POLYGON, REC_END_COMPLEX_POLYGON,
+  REC_GAP, REC_MATRIX, REC_POP_MATRIX, REC_CIRCLE, REC_ARC, REC_ARCI, REC_PIE,
+  REC_LINE_STYLE, REC_COLOR, REC_COLOR_RGB, REC_FONT, REC_DRAW, REC_DRAWF,
+  REC_DRAW_ANGLE, REC_RTL_DRAW, REC_OVERRIDE_SCALE, REC_RESTORE_SCALE,
+  REC_ANTIALIAS
+};
+
+static inline int get_int(const uchar *&p) {
+  int v;
+  memcpy(&v, p, sizeof(int));
+  p += sizeof(int);
+  return v;
+}
+
+static inline double get_double(const uchar *&p) {
+  double v;
+  memcpy(&v, p, sizeof(double));
+  p += sizeof(double);
+  return v;
+}
+
+static inline void get_ints(const uchar *&p, int *v, int n) {
+  memcpy(v, p, n * sizeof(int));
+  p += n * sizeof(int);
+}
+
+#define REC_TRANSLATE_MAX 16
+
+class Fl_Recording_Graphics_Driver : public Fl_Graphics_Driver {
+  uchar *buf_;
+  int len_, alloc_;
+  int complete_;
+  int tstack_[2 * REC_TRANSLATE_MAX], tsp_;
+  uchar *room(int n) {
+    if (len_ + n > alloc_) {
+      alloc_ = alloc_ ? 2 * alloc_ : 1024;
+      if (alloc_ < len_ + n) alloc_ = len_ + n;
+      buf_ = (uchar*)realloc(buf_, alloc_);
+    }
+    uchar *p = buf_ + len_;
+    len_ += n;
+    return p;
+  }
+  void op(int c) { *room(1) = (uchar)c; }
+  void put_int(int v) { memcpy(room(sizeof(int)), &v, sizeof(int)); }
+  void put_double(double v) { memcpy(room(sizeof(double)), &v, sizeof(double)); }
+  void put_str(const char *s, int n) { put_int(n); memcpy(room(n), s, n); }
+  void ints(int c, int n, const int *v) {
+    uchar *p = room(1 + n * (int)sizeof(int));
+    *p = (uchar)c;
+    memcpy(p + 1, v, n * sizeof(int));
+  }
+  int untransformed() { return m.a == 1 && m.b == 0 && m.c == 0 && m.d == 1; }
+  void matrix_() {
+    op(REC_MATRIX);
+    put_double(m.a); put_double(m.b); put_double(m.c); put_double(m.d);
+    put_double(m.x + dx); put_double(m.y + dy);
+  }
+  static Fl_Graphics_Driver *display() {
+    return Fl_Display_Device::display_device()->driver();
+  }
+public:
+  int dx, dy; // origin of the surface and translations
+  Fl_Recording_Graphics_Driver() {
+    buf_ = 0;
+    len_ = alloc_ = 0;
+    complete_ = 1;
+    tsp_ = 0;
+    dx = dy = 0;
+  }
+  ~Fl_Recording_Graphics_Driver() { free(buf_); }
+  void clear() { len_ = 0; complete_ = 1; }
+  int complete() { return complete_; }
+  int size() { return len_; }
+  void sync();
+  void translate_surface(int x, int y);
+  void untranslate_surface();
+  void replay(Fl_Graphics_Driver *d);
+  // --- drawing
+  void point(int x, int y) { int v[2] = {x + dx, y + dy}; ints(REC_POINT, 2, v); }
+  void rect(int x, int y, int w, int h) { int v[4] = {x + dx, y + dy, w, h}; ints(REC_RECT, 4, v); }
+  void focus_rect(int x, int y, int w, int h) { int v[4] = {x + dx, y + dy, w, h}; ints(REC_FOCUS_RECT, 4, v); }
+  void rectf(int x, int y, int w, int h) { int v[4] = {x + dx, y + dy, w, h}; ints(REC_RECTF, 4, v); }
+  void colored_rectf(int x, int y, int w, int h, uchar r, uchar g, uchar b) {
+    int v[7] = {x + dx, y + dy, w, h, r, g, b};
+    ints(REC_COLORED_RECTF, 7, v);
+    color_ = fl_rgb_color(r, g, b);
+  }
+  void line(int x, int y, int x1, int y1) {
+    int v[4] = {x + dx, y + dy, x1 + dx, y1 + dy};
+    ints(REC_LINE, 4, v);
+  }
+  void line(int x, int y, int x1, int y1, int x2, int y2) {
+    int v[6] = {x + dx, y + dy, x1 + dx, y1 + dy, x2 + dx, y2 + dy};
+    ints(REC_LINE3, 6, v);
+  }
+  void xyline(int x, int y, int x1) { int v[3] = {x + dx, y + dy, x1 + dx}; ints(REC_XYLINE, 3, v); }
+  void xyline(int x, int y, int x1, int y2) {
+    int v[4] = {x + dx, y + dy, x1 + dx, y2 + dy};
+    ints(REC_XYLINE4, 4, v);
+  }
+  void xyline(int x, int y, int x1, int y2, int x3) {
+    int v[5] = {x + dx, y + dy, x1 + dx, y2 + dy, x3 + dx};
+    ints(REC_XYLINE5, 5, v);
+  }
+  void yxline(int x, int y, int y1) { int v[3] = {x + dx, y + dy, y1 + dy}; ints(REC_YXLINE, 3, v); }
+  void yxline(int x, int y, int y1, int x2) {
+    int v[4] = {x + dx, y + dy, y1 + dy, x2 + dx};
+    ints(REC_YXLINE4, 4, v);
+  }
+  void yxline(int x, int y, int y1, int x2, int y3) {
+    int v[5] = {x + dx, y + dy, y1 + dy, x2 + dx, y3 + dy};
+    ints(REC_YXLINE5, 5, v);
+  }
+  void loop(int x0, int y0, int x1, int y1, int x2, int y2) {
+    int v[6] = {x0 + dx, y0 + dy, x1 + dx, y1 + dy, x2 + dx, y2 + dy};
+    ints(REC_LOOP3, 6, v);
+  }
+  void loop(int x0, int y0, int x1, int y1, int x2, int y2, int x3, int y3) {
+    int v[8] = {x0 + dx, y0 + dy, x1 + dx, y1 + dy, x2 + dx, y2 + dy, x3 + dx, y3 + dy};
+    ints(REC_LOOP4, 8, v);
+  }
+  void polygon(int x0, int y0, int x1, int y1, int x2, int y2) {
+    int v[6] = {x0 + dx, y0 + dy, x1 + dx, y1 + dy, x2 + dx, y2 + dy};
+    ints(REC_POLYGON3, 6, v);
+  }
+  void polygon(int x0, int y0, int x1, int y1, int x2, int y2, int x3, int y3) {
+    int v[8] = {x0 + dx, y0 + dy, x1 + dx, y1 + dy, x2 + dx, y2 + dy, x3 + dx, y3 + dy};
+    ints(REC_POLYGON4, 8, v);
+  }
+  // --- clipping: the clip of the replay is unknown, so everything is drawn
+  void push_clip(int x, int y, int w, int h) { int v[4] = {x + dx, y + dy, w, h}; ints(REC_PUSH_CLIP, 4, v); }
+  int clip_box(int x, int y, int w, int h, int &X, int &Y, int &W, int &H) {
+    X = x; Y = y; W = w; H = h;
+    return 0;
+  }
+  int not_clipped(int x, int y, int w, int h) { return 1; }
+  void push_no_clip() { op(REC_PUSH_NO_CLIP); }
+  void pop_clip() { op(REC_POP_CLIP); }
+  void clip_region(Fl_Region r);
+  Fl_Region clip_region() { return 0; }
+  // --- complex shapes
+  void begin_points() { op(REC_BEGIN_POINTS); }
+  void begin_line() { op(REC_BEGIN_LINE); }
+  void begin_loop() { op(REC_BEGIN_LOOP); }
+  void begin_polygon() { op(REC_BEGIN_POLYGON); }
+  void begin_complex_polygon() { op(REC_BEGIN_COMPLEX_POLYGON); }
+  void transformed_vertex(double xf, double yf) {
+    op(REC_VERTEX);
+    put_double(xf + dx); put_double(yf + dy);
+  }
+  void vertex(double x, double y) {
+    transformed_vertex(x*m.a + y*m.c + m.x, x*m.b + y*m.d + m.y);
+  }
+  void end_points() { op(REC_END_POINTS); }
+  void end_line() { op(REC_END_LINE); }
+  void end_loop() { op(REC_END_LOOP); }
+  void end_polygon() { op(REC_END_POLYGON); }
+  void end_complex_polygon() { op(REC_END_COMPLEX_POLYGON); }
+  void gap() { op(REC_GAP); }
+  void circle(double x, double y, double r);
+  void arc(double x, double y, double r, double start, double end);
+  void arc(int x, int y, int w, int h, double a1, double a2);
+  void pie(int x, int y, int w, int h, double a1, double a2);
+  void line_style(int style, int width = 0, char *dashes = 0);
+  void color(Fl_Color c) {
+    color_ = c;
+    op(REC_COLOR);
+    put_int((int)c);
+  }
+  Fl_Color color() { return color_; }
+  void color(uchar r, uchar g, uchar b) {
+    int v[3] = {r, g, b};
+    ints(REC_COLOR_RGB, 3, v);
+    color_ = fl_rgb_color(r, g, b);
+  }
+  // --- text is measured with the fonts of the display
+  void font(Fl_Font face, Fl_Fontsize fsize) {
+    Fl_Graphics_Driver::font(face, fsize);
+    display()->font(face, fsize);
+    int v[2] = {face, fsize};
+    ints(REC_FONT, 2, v);
+  }
+  void draw(const char *str, int n, int x, int y) {
+    int v[2] = {x + dx, y + dy};
+    ints(REC_DRAW, 2, v);
+    put_str(str, n);
+  }
+  void draw(const char *str, int n, float x, float y) {
+    op(REC_DRAWF);
+    put_double(x + dx); put_double(y + dy);
+    put_str(str, n);
+  }
+  void draw(int angle, const char *str, int n, int x, int y) {
+    int v[3] = {angle, x + dx, y + dy};
+    ints(REC_DRAW_ANGLE, 3, v);
+    put_str(str, n);
+  }
+  void rtl_draw(const char *str, int n, int x, int y) {
+    int v[2] = {x + dx, y + dy};
+    ints(REC_RTL_DRAW, 2, v);
+    put_str(str, n);
+  }
+  double width(const char *str, int n) { return display()->width(str, n); }
+  double width(unsigned int c) { return display()->width(c); }
+  void text_extents(const char *str, int n, int &DX, int &DY, int &W, int &H) {
+    display()->text_extents(str, n, DX, DY, W, H);
+  }
+  int height() { return display()->height(); }
+  int descent() { return display()->descent(); }
+  float override_scale() {
+    float s = scale();
+    Fl_Graphics_Driver::scale(1);
+    op(REC_OVERRIDE_SCALE);
+    return s;
+  }
+  void restore_scale(float s) {
+    Fl_Graphics_Driver::scale(s);
+    op(REC_RESTORE_SCALE);
+  }
+  void antialias(int state) {
+    op(REC_ANTIALIAS);
+    put_int(state);
+  }
+  int antialias() { return display()->antialias(); }
+protected:
+  // --- images and offscreens can't be recorded
+  void draw_image(const uchar*, int, int, int, int, int, int) { complete_ = 0; }
+  void draw_image_mono(const uchar*, int, int, int, int, int, int) { complete_ = 0; }
+  void draw_image(Fl_Draw_Image_Cb, void*, int, int, int, int, int) { complete_ = 0; }
+  void draw_image_mono(Fl_Draw_Image_Cb, void*, int, int, int, int, int) { complete_ = 0; }
+  void draw_rgb(Fl_RGB_Image*, int, int, int, int, int, int) { complete_ = 0; }
+  void draw_pixmap(Fl_Pixmap*, int, int, int, int, int, int) { complete_ = 0; }
+  void draw_bitmap(Fl_Bitmap*, int, int, int, int, int, int) { complete_ = 0; }
+  void copy_offscreen(int, int, int, int, Fl_Offscreen, int, int) { complete_ = 0; }
+};
+
+// Copies the state of the display driver that drawing code may query.
+void Fl_Recording_Graphics_Driver::sync() {
+  Fl_Graphics_Driver *d = display();
+  font_ = d->font();
+  size_ = d->size();
+  color_ = d->color();
+  Fl_Graphics_Driver::scale(d->scale());
+}
+
+void Fl_Recording_Graphics_Driver::translate_surface(int x, int y) {
+  if (tsp_ < REC_TRANSLATE_MAX) {
+    tstack_[2 * tsp_] = x;
+    tstack_[2 * tsp_ + 1] = y;
+    dx += x;
+    dy += y;
+  } else Fl::warning("Fl_Recording_Surface::translate: translation stack overflow!\n");
+  tsp_++;
+}
+
+void Fl_Recording_Graphics_Driver::untranslate_surface() {
+  if (tsp_ <= 0) return;
+  if (--tsp_ < REC_TRANSLATE_MAX) {
+    dx -= tstack_[2 * tsp_];
+    dy -= tstack_[2 * tsp_ + 1];
+  }
+}
+
+void Fl_Recording_Graphics_Driver::clip_region(Fl_Region r) {
+  if (r) { // the driver owns the region
+    display()->XDestroyRegion(r);
+    complete_ = 0;
+  } else op(REC_CLIP_NONE);
+}
+
+// Circles and arcs keep their shape under the transformation,
+// so the replay applies the same matrix around them.
+void Fl_Recording_Graphics_Driver::circle(double x, double y, double r) {
+  if (untransformed()) {
+    op(REC_CIRCLE);
+    put_double(x + m.x + dx); put_double(y + m.y + dy); put_double(r);
+  } else {
+    matrix_();
+    op(REC_CIRCLE);
+    put_double(x); put_double(y); put_double(r);
+    op(REC_POP_MATRIX);
+  }
+}
+
+void Fl_Recording_Graphics_Driver::arc(double x, double y, double r, double start, double end) {
+  int t = !untransformed();
+  if (t) matrix_();
+  else { x += m.x + dx; y += m.y + dy; }
+  op(REC_ARC);
+  put_double(x); put_double(y); put_double(r);
+  put_double(start); put_double(end);
+  if (t) op(REC_POP_MATRIX);
+}
+
+void Fl_Recording_Graphics_Driver::arc(int x, int y, int w, int h, double a1, double a2) {
+  int v[4] = {x + dx, y + dy, w, h};
+  ints(REC_ARCI, 4, v);
+  put_double(a1); put_double(a2);
+}
+
+void Fl_Recording_Graphics_Driver::pie(int x, int y, int w, int h, double a1, double a2) {
+  int v[4] = {x + dx, y + dy, w, h};
+  ints(REC_PIE, 4, v);
+  put_double(a1); put_double(a2);
+}
+
+void Fl_Recording_Graphics_Driver::line_style(int style, int width, char *dashes) {
+  int v[2] = {style, width};
+  ints(REC_LINE_STYLE, 2, v);
+  if (dashes) put_str(dashes, (int)strlen(dashes) + 1);
+  else put_int(-1);
+}
+
+// Sends all recorded commands to driver d.
+void Fl_Recording_Graphics_Driver::replay(Fl_Graphics_Driver *d) {
+  const uchar *p = buf_, *end = buf_ + len_;
+  float scales[REC_TRANSLATE_MAX];
+  int nscales = 0;
+  int v[8], n;
+  double a, b, c, e, f, g;
+  while (p < end) {
+    switch (*p++) {
+      case REC_POINT: get_ints(p, v, 2); d->point(v[0], v[1]); break;
+      case REC_RECT: get_ints(p, v, 4); d->rect(v[0], v[1], v[2], v[3]); break;
+      case REC_FOCUS_RECT: get_ints(p, v, 4); d->focus_rect(v[0], v[1], v[2], v[3]); break;
+      case REC_RECTF: get_ints(p, v, 4); d->rectf(v[0], v[1], v[2], v[3]); break;
+      case REC_COLORED_RECTF:
+        get_ints(p, v, 7);
+        d->colored_rectf(v[0], v[1], v[2], v[3], (uchar)v[4], (uchar)v[5], (uchar)v[6]);
+        break;
+      case REC_LINE: get_ints(p, v, 4); d->line(v[0], v[1], v[2], v[3]); break;
+      case REC_LINE3: get_ints(p, v, 6); d->line(v[0], v[1], v[2], v[3], v[4], v[5]); break;
+      case REC_XYLINE: get_ints(p, v, 3); d->xyline(v[0], v[1], v[2]); break;
+      case REC_XYLINE4: get_ints(p, v, 4); d->xyline(v[0], v[1], v[2], v[3]); break;
+      case REC_XYLINE5: get_ints(p, v, 5); d->xyline(v[0], v[1], v[2], v[3], v[4]); break;
+      case REC_YXLINE: get_ints(p, v, 3); d->yxline(v[0], v[1], v[2]); break;
+      case REC_YXLINE4: get_ints(p, v, 4); d->yxline(v[0], v[1], v[2], v[3]); break;
+      case REC_YXLINE5: get_ints(p, v, 5); d->yxline(v[0], v[1], v[2], v[3], v[4]); break;
+      case REC_LOOP3: get_ints(p, v, 6); d->loop(v[0], v[1], v[2], v[3], v[4], v[5]); break;
+      case REC_LOOP4:
+        get_ints(p, v, 8);
+        d->loop(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7]);
+        break;
+      case REC_POLYGON3: get_ints(p, v, 6); d->polygon(v[0], v[1], v[2], v[3], v[4], v[5]); break;
+      case REC_POLYGON4:
+        get_ints(p, v, 8);
+        d->polygon(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7]);
+        break;
+      case REC_PUSH_CLIP: get_ints(p, v, 4); d->push_clip(v[0], v[1], v[2], v[3]); break;
+      case REC_PUSH_NO_CLIP: d->push_no_clip(); break;
+      case REC_POP_CLIP: d->pop_clip(); break;
+      case REC_CLIP_NONE: d->clip_region(0); break;
+      case REC_BEGIN_POINTS: d->begin_points(); break;
+      case REC_BEGIN_LINE: d->begin_line(); break;
+      case REC_BEGIN_LOOP: d->begin_loop(); break;
+      case REC_BEGIN_POLYGON: d->begin_polygon(); break;
+      case REC_BEGIN_COMPLEX_POLYGON: d->begin_complex_polygon(); break;
+      case REC_VERTEX:
+        a = get_double(p); b = get_double(p);
+        d->transformed_vertex(a, b);
+        break;
+      case REC_END_POINTS: d->end_points(); break;
+      case REC_END_LINE: d->end_line(); break;
+      case REC_END_LOOP: d->end_loop(); break;
+      case REC_END_POLYGON: d->end_polygon(); break;
+      case REC_END_COMPLEX_POLYGON: d->end_complex_polygon(); break;
+      case REC_GAP: d->gap(); break;
+      case REC_MATRIX:
+        a = get_double(p); b = get_double(p); c = get_double(p);
+        e = get_double(p); f = get_double(p); g = get_double(p);
+        d->push_matrix();
+        d->mult_matrix(a, b, c, e, f, g);
+        break;
+      case REC_POP_MATRIX: d->pop_matrix(); break;
+      case REC_CIRCLE:
+        a = get_double(p); b = get_double(p); c = get_double(p);
+        d->circle(a, b, c);
+        break;
+      case REC_ARC:
+        a = get_double(p); b = get_double(p); c = get_double(p);
+        e = get_double(p); f = get_double(p);
+        d->arc(a, b, c, e, f);
+        break;
+      case REC_ARCI:
+      case REC_PIE:
+        n = p[-1];
+        get_ints(p, v, 4);
+        a = get_double(p); b = get_double(p);
+        if (n == REC_ARCI) d->arc(v[0], v[1], v[2], v[3], a, b);
+        else d->pie(v[0], v[1], v[2], v[3], a, b);
+        break;
+      case REC_LINE_STYLE:
+        get_ints(p, v, 2);
+        n = get_int(p);
+        d->line_style(v[0], v[1], n < 0 ? 0 : (char*)p);
+        if (n > 0) p += n;
+        break;
+      case REC_COLOR: d->color((Fl_Color)get_int(p)); break;
+      case REC_COLOR_RGB: get_ints(p, v, 3); d->color((uchar)v[0], (uchar)v[1], (uchar)v[2]); break;
+      case REC_FONT: get_ints(p, v, 2); d->font((Fl_Font)v[0], (Fl_Fontsize)v[1]); break;
+      case REC_DRAW:
+      case REC_RTL_DRAW:
+        n = p[-1];
+        get_ints(p, v, 2);
+        v[2] = get_int(p);
+        if (n == REC_DRAW) d->draw((const char*)p, v[2], v[0], v[1]);
+        else d->rtl_draw((const char*)p, v[2], v[0], v[1]);
+        p += v[2];
+        break;
+      case REC_DRAWF:
+        a = get_double(p); b = get_double(p);
+        n = get_int(p);
+        d->draw((const char*)p, n, float(a), float(b));
+        p += n;
+        break;
+      case REC_DRAW_ANGLE:
+        get_ints(p, v, 3);
+        n = get_int(p);
+        d->draw(v[0], (const char*)p, n, v[1], v[2]);
+        p += n;
+        break;
+      case REC_OVERRIDE_SCALE:
+        if (nscales < REC_TRANSLATE_MAX) scales[nscales] = d->override_scale();
+        nscales++;
+        break;
+      case REC_RESTORE_SCALE:
+        if (nscales > 0 && --nscales < REC_TRANSLATE_MAX) d->restore_scale(scales[nscales]);
+        break;
+      case REC_ANTIALIAS: d->antialias(get_int(p)); break;
+      default: // can't happen
+        return;
+    }
+  }
+}
+
+
+/**
+ Constructor.
+ \param w,h Size of the drawing area reported by printable_rect().
+ The surface itself is not limited in size.
+ */
+Fl_Recording_Surface::Fl_Recording_Surface(int w, int h) :
+    Fl_Widget_Surface(new Fl_Recording_Graphics_Driver()) {
+  width_ = w;
+  height_ = h;
+}
+
+/** Destructor. */
+Fl_Recording_Surface::~Fl_Recording_Surface() {
+  delete driver();
+}
+
+void Fl_Recording_Surface::set_current() {
+  ((Fl_Recording_Graphics_Driver*)driver())->sync();
+  Fl_Widget_Surface::set_current();
+}
+
+void Fl_Recording_Surface::translate(int x, int y) {
+  ((Fl_Recording_Graphics_Driver*)driver())->translate_surface(x, y);
+}
+
+void Fl_Recording_Surface::untranslate() {
+  ((Fl_Recording_Graphics_Driver*)driver())->untranslate_surface();
+}
+
+void Fl_Recording_Surface::origin(int x, int y) {
+  Fl_Recording_Graphics_Driver *d = (Fl_Recording_Graphics_Driver*)driver();
+  d->dx += x - x_offset;
+  d->dy += y - y_offset;
+  Fl_Widget_Surface::origin(x, y);
+}
+
+void Fl_Recording_Surface::origin(int *x, int *y) {
+  Fl_Widget_Surface::origin(x, y);
+}
+
+int Fl_Recording_Surface::printable_rect(int *w, int *h) {
+  *w = width_;
+  *h = height_;
+  return 0;
+}
+
+/**
+ Draws the recorded graphics to the current drawing surface.
+ Coordinates are not changed: the graphics appear where they were drawn
+ to this surface, unless origin() or translate() were used while recording.
+ */
+void Fl_Recording_Surface::replay() {
+  if (fl_graphics_driver == driver()) return;
+  ((Fl_Recording_Graphics_Driver*)driver())->replay(fl_graphics_driver);
+}
+
+#if USE_PANGO
+extern Fl_RGB_Image *fl_cairo_tiled_image(int W, int H, int tile_size, int threads,
+                                          void (*draw)(Fl_Graphics_Driver*, void*), void *data);
+
+static void replay_tile(Fl_Graphics_Driver *d, void *data) {
+  ((Fl_Recording_Graphics_Driver*)data)->replay(d);
+}
+#endif
+
+/**
+ Draws the recorded graphics into a new image of the size of the surface.
+ The image has a white background, and its origin is that of the surface.
+
+ With the Cairo graphics driver (X11 platform with Pango), the image is
+ split into squares of \p tile_size pixels that are drawn in parallel by
+ up to \p threads threads, or one thread per processor if \p threads is 0.
+ Each square is drawn by its own Cairo context, so that the image doesn't
+ depend on the number of threads. Text is measured again with Pango rather
+ than with the fonts of the display. The calling thread waits until the
+ image is complete. Other platforms draw the recording with an
+ Fl_Image_Surface and ignore both parameters.
+
+ \return a new image that the caller must delete, or NULL if the surface
+ has no size or if the recording is not complete(): an image without the
+ images, offscreens and clip regions that couldn't be recorded would not
+ show what was drawn.
+ */
+Fl_RGB_Image *Fl_Recording_Surface::image(int threads, int tile_size) {
+  if (width_ <= 0 || height_ <= 0 || !complete()) return NULL;
+#if USE_PANGO
+  return fl_cairo_tiled_image(width_, height_, tile_size, threads, replay_tile, driver());
+#else
+  (void)threads; (void)tile_size;
+  Fl_Image_Surface *surf = new Fl_Image_Surface(width_, height_);
+  Fl_Surface_Device::push_current(surf);
+  fl_color(FL_WHITE);
+  fl_rectf(0, 0, width_, height_);
+  ((Fl_Recording_Graphics_Driver*)driver())->replay(fl_graphics_driver);
+  Fl_RGB_Image *img = surf->image();
+  Fl_Surface_Device::pop_current();
+  delete surf;
+  return img;
+#endif
+}
+
+/** Removes all recorded graphics. The memory used is kept for the next recording. */
+void Fl_Recording_Surface::clear() {
+  ((Fl_Recording_Graphics_Driver*)driver())->clear();
+}
+
+/**
+ Returns whether all graphics drawn since the last clear() were recorded.
+ \return 0 if images, offscreens or clip regions were drawn to the surface.
+ */
+int Fl_Recording_Surface::complete() {
+  return ((Fl_Recording_Graphics_Driver*)driver())->complete();
+}
+
+/** Returns the number of bytes used by the recorded graphics. */
+int Fl_Recording_Surface::size() {
+  return ((Fl_Recording_Graphics_Driver*)driver())->size();
+}
+
+
+//
+// The cache of widget recordings, a hash table keyed by widget
+//
+
+struct Fl_Widget_Recording {
+  Fl_Widget *widget;          // watched: 0 after the widget was deleted
+  Fl_Recording_Surface *rec;  // 0 until the widget was drawn
+  int x, y, w, h;             // position of the widget when it was recorded
+  float scale;                // and the scale factor of the display
+  char valid;                 // rec can be replayed
+  char live;                  // the widget draws images: never record it
+  Fl_Widget_Recording *next;
+};
+
+extern void fl_watch_fixed_widget_pointer(Fl_Widget *&w); // in Fl.cxx
+
+int Fl_Recording_Surface::cache_count_ = 0;
+static Fl_Widget_Recording **cache_table = 0;
+static unsigned int cache_table_size = 0;   // a power of 2
+static const Fl_Group *exposed_group = 0;   // group drawn only because it was exposed
+
+static inline Fl_Widget_Recording **cache_bucket(const Fl_Widget *w) {
+  fl_uintptr_t u = (fl_uintptr_t)w;
+  unsigned int h = (unsigned int)(u ^ (u >> 12)) * 2654435761U;
+  return cache_table + (h >> 8 & (cache_table_size - 1));
+}
+
+void Fl_Recording_Surface::cache_free_(Fl_Widget_Recording *e) {
+  Fl::release_widget_pointer(e->widget);
+  delete e->rec;
+  free(e);
+  cache_count_--;
+}
+
+// Returns the link to the entry of widget w, or the null link ending its
+// bucket. Entries of deleted widgets found on the way are removed.
+Fl_Widget_Recording **Fl_Recording_Surface::cache_link_(const Fl_Widget *w) {
+  Fl_Widget_Recording **ep = cache_bucket(w), *e;
+  while ((e = *ep) != 0) {
+    if (e->widget == w) break;
+    if (!e->widget) {
+      *ep = e->next;
+      cache_free_(e);
+    } else ep = &e->next;
+  }
+  return ep;
+}
+
+static void cache_grow() {
+  unsigned int old_size = cache_table_size;
+  Fl_Widget_Recording **old_table = cache_table;
+  cache_table_size = old_size ? 2 * old_size : 16;
+  cache_table = (Fl_Widget_Recording **)calloc(cache_table_size, sizeof(Fl_Widget_Recording *));
+  for (unsigned int i = 0; i < old_size; i++) {
+    Fl_Widget_Recording *e, *next;
+    for (e = old_table[i]; e; e = next) {
+      next = e->next;
+      Fl_Widget_Recording **b = cache_bucket(e->widget);
+      e->next = *b;
+      *b = e;
+    }
+  }
+  free(old_table);
+}
+
+/**
+ Makes a widget draw through a recording while it is only exposed.
+
+ FLTK normally redraws all widgets of a window when the window system
+ asks to refresh it, e.g. when another window stopped covering it.
+ A widget with this cache records what its draw() method draws each time
+ it is redrawn because it changed, and replays the recording instead of
+ calling draw() when it is redrawn only because it was exposed, i.e. when
+ neither the widget nor any of its parents were damaged by anything but
+ FL_DAMAGE_EXPOSE and its position, size and the scale factor of the
+ screen are unchanged. This speeds up exposure of widgets with expensive
+ layout or text measurement, such as large groups, tables or text displays.
+
+ The cache works for widgets drawn by their parent Fl_Group, not for
+ windows. It is only used when drawing to the display.
+ Widgets must call redraw() whenever their look changes, which all FLTK
+ widgets do. Widgets drawing images, or that draw differently depending on
+ the drawing surface, e.g. the blinking cursor of text input widgets,
+ should not use the cache: drawing images stops the recording and the
+ widget is then always drawn directly.
+
+ The recording is freed when the cache is turned off or the widget is
+ deleted.
+ \param widget The widget, or a group whose children are recorded with it.
+ \param on Non-zero to turn the cache on, zero to turn it off.
+ \see cached()
+ */
+void Fl_Recording_Surface::cache(Fl_Widget *widget, int on) {
+  if (!widget) return;
+  Fl_Widget_Recording **ep = cache_table_size ? cache_link_(widget) : 0;
+  if (!on) {
+    Fl_Widget_Recording *e = ep ? *ep : 0;
+    if (e) {
+      *ep = e->next;
+      cache_free_(e);
+    }
+    return;
+  }
+  if (ep && *ep) {
+    (*ep)->live = 0;
+    return;
+  }
+  if ((unsigned int)cache_count_ >= cache_table_size) {
+    for (unsigned int i = 0; i < cache_table_size; i++) { // remove deleted widgets
+      Fl_Widget_Recording **dp = cache_table + i, *d;
+      while ((d = *dp) != 0) {
+        if (d->widget) dp = &d->next;
+        else { *dp = d->next; cache_free_(d); }
+      }
+    }
+    if ((unsigned int)cache_count_ >= cache_table_size) cache_grow();
+  }
+  Fl_Widget_Recording *e = (Fl_Widget_Recording *)calloc(1, sizeof(Fl_Widget_Recording));
+  Fl_Widget_Recording **b = cache_bucket(widget);
+  e->widget = widget;
+  e->next = *b;
+  *b = e;
+  fl_watch_fixed_widget_pointer(e->widget);
+  cache_count_++;
+}
+
+/**
+ Returns whether a widget draws through a recording when it is exposed.
+ \see cache(Fl_Widget*, int)
+ */
+int Fl_Recording_Surface::cached(const Fl_Widget *widget) {
+  return cache_count_ && *cache_link_(widget) != 0;
+}
+
+// Draws a child of a group while some widgets use the cache,
+// from Fl_Group::draw_child() or, if update is true, from update_child().
+void Fl_Recording_Surface::draw_child_(const Fl_Group *parent, Fl_Widget &widget, int update) {
+  int exposed = !(widget.damage() & ~FL_DAMAGE_EXPOSE);
+  if (exposed && !update)
+    exposed = (parent == exposed_group ||
+               !(parent->damage() & ~(FL_DAMAGE_CHILD|FL_DAMAGE_EXPOSE)));
+  Fl_Widget_Recording *e = 0;
+  if (Fl_Surface_Device::surface() == Fl_Display_Device::display_device())
+    e = *cache_link_(&widget);
+  const Fl_Group *save = exposed_group;
+  if (!e || e->live) {
+    if (!update) widget.clear_damage(FL_DAMAGE_ALL);
+    exposed_group = exposed ? widget.as_group() : 0;
+    widget.draw();
+    exposed_group = save;
+    widget.clear_damage();
+    return;
+  }
+  float s = Fl_Display_Device::display_device()->driver()->scale();
+  if (exposed && e->valid && e->x == widget.x() && e->y == widget.y() &&
+      e->w == widget.w() && e->h == widget.h() && e->scale == s) {
+    e->rec->replay();
+    widget.clear_damage();
+    return;
+  }
+  e->valid = 0;
+  if (update && !(widget.damage() & FL_DAMAGE_ALL)) {
+    // keep partial updates fast, record at the next full redraw
+    widget.draw();
+    widget.clear_damage();
+    return;
+  }
+  if (!e->rec) e->rec = new Fl_Recording_Surface(widget.w(), widget.h());
+  else e->rec->clear();
+  widget.clear_damage(FL_DAMAGE_ALL);
+  exposed_group = 0;
+  Fl_Surface_Device::push_current(e->rec);
+  widget.draw();
+  Fl_Surface_Device::pop_current();
+  exposed_group = save;
+  if (e->rec->complete()) {
+    e->x = widget.x(); e->y = widget.y();
+    e->w = widget.w(); e->h = widget.h();
+    e->scale = s;
+    e->valid = 1;
+    e->rec->replay();
+  } else {
+    e->live = 1;
+    delete e->rec;
+    e->rec = 0;
+    widget.draw();
+  }
+  widget.clear_damage();
+}
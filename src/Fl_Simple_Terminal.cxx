@@ -15,13 +15,13 @@
 //     https://www.fltk.org/bugs.php
 //
 
-#include <ctype.h>      /* isdigit */
 #include <string.h>     /* memset */
-#include <stdlib.h>     /* strtol */
+#include <stdlib.h>     /* malloc, abs */
 #include <FL/Fl_Simple_Terminal.H>
 #include <FL/Fl.H>
 #include <stdarg.h>
 #include "flstring.h"
+#include "Fl_System_Driver.H"
 
 #define STE_SIZE sizeof(Fl_Text_Display::Style_Table_Entry)
 
@@ -57,6 +57,73 @@ static const Fl_Text_Display::Style_Table_Entry builtin_stable[] = {
 static const int  builtin_stable_size = sizeof(builtin_stable);
 static const char builtin_normal_index = 17;        // the reset style index used by \033[0m
 
+// States of the ANSI parser
+enum {
+  ANSI_TEXT = 0,        // ordinary text
+  ANSI_ESC,             // after "\033"
+  ANSI_CSI              // in "\033[..", collecting values
+};
+
+// Characters that end a run of ordinary text in ANSI mode
+static const char ansi_special[256] = {
+  1,0,0,0,0,0,0,0, 0,0,1,0,0,0,0,0, 0,0,0,0,0,0,0,0, 0,0,0,1,0,0,0,0, // NUL, \n, \033
+  0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,
+  0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,
+  0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,
+  0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,
+  0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,
+  0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,
+  0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0
+};
+
+// The 16 basic colors of xterm's 256 color palette
+static const uchar xterm_colors[16][3] = {
+  {   0,   0,   0 }, { 205,   0,   0 }, {   0, 205,   0 }, { 205, 205,   0 },
+  {   0,   0, 238 }, { 205,   0, 205 }, {   0, 205, 205 }, { 229, 229, 229 },
+  { 127, 127, 127 }, { 255,   0,   0 }, {   0, 255,   0 }, { 255, 255,   0 },
+  {  92,  92, 255 }, { 255,   0, 255 }, {   0, 255, 255 }, { 255, 255, 255 }
+};
+
+// Get the RGB values of color 'n' of xterm's 256 color palette
+static void xterm_color(int n, uchar &r, uchar &g, uchar &b) {
+  static const uchar cube[6] = { 0, 95, 135, 175, 215, 255 };
+  if ( n < 16 ) {                       // basic colors
+    r = xterm_colors[n][0]; g = xterm_colors[n][1]; b = xterm_colors[n][2];
+  } else if ( n < 232 ) {               // 6x6x6 color cube
+    n -= 16;
+    r = cube[n / 36]; g = cube[(n / 6) % 6]; b = cube[n % 6];
+  } else {                              // gray ramp
+    r = g = b = (uchar)(8 + (n - 232) * 10);
+  }
+}
+
+// Find the style table entry with the color closest to r,g,b
+static int nearest_style(const Fl_Text_Display::Style_Table_Entry *stable, int nstyles,
+                         uchar r, uchar g, uchar b) {
+  int best = 0, bestdist = 0x7fffffff;
+  for ( int i = 0; i < nstyles; i++ ) {
+    uchar sr, sg, sb;
+    Fl::get_color(stable[i].color, sr, sg, sb);
+    int dist = (sr-r)*(sr-r) + (sg-g)*(sg-g) + (sb-b)*(sb-b);
+    if ( dist < bestdist ) { best = i; bestdist = dist; }
+  }
+  return best;
+}
+
+// Find the style table entry with the same color and size as entry 'index'
+// in the bold or regular variant of its font, or 'index' if there is none
+static int bold_style(const Fl_Text_Display::Style_Table_Entry *stable, int nstyles,
+                      int index, int bold) {
+  const Fl_Text_Display::Style_Table_Entry &e = stable[index];
+  Fl_Font font = bold ? (e.font | FL_BOLD) : (e.font & ~FL_BOLD);
+  if ( font == e.font ) return index;
+  for ( int i = 0; i < nstyles; i++ ) {
+    if ( stable[i].font == font && stable[i].color == e.color && stable[i].size == e.size )
+      return i;
+  }
+  return index;
+}
+
 // Count how many times character 'c' appears in string 's'
 static int strcnt(const char *s, char c) {
   int count = 0;
@@ -64,6 +131,10 @@ static int strcnt(const char *s, char c) {
   return count;
 }
 
+// Text appended by other threads, protected by the awake ring lock
+static Fl_Simple_Terminal *async_first = 0;   // terminals with queued text
+static int async_started = 0;                 // async_check_cb() is (being) registered
+
 // Vertical scrollbar callback intercept
 void Fl_Simple_Terminal::vscroll_cb2(Fl_Widget *w, void*) {
   scrolling = 1;
@@ -110,6 +181,18 @@ Fl_Simple_Terminal::Fl_Simple_Terminal(int X,int Y,int W,int H,const char *l) :
   orig_vscroll_cb = mVScrollBar->callback();
   orig_vscroll_data = mVScrollBar->user_data();
   mVScrollBar->callback(vscroll_cb, (void*)this);
+  // Text queued by other threads
+  async_text_ = 0;
+  async_len_ = 0;
+  async_size_ = 0;
+  async_next_ = 0;
+  // create the lock in this thread, before other threads use it
+  Fl::system_driver()->lock_ring();
+  Fl::system_driver()->unlock_ring();
+  // ANSI parser
+  ansi_state_ = ANSI_TEXT;
+  ansi_nvals_ = 0;
+  ansi_val_ = -1;
 }
 
 /**
@@ -117,6 +200,10 @@ Fl_Simple_Terminal::Fl_Simple_Terminal(int X,int Y,int W,int H,const char *l) :
  for the terminal, including text buffer, style buffer, etc.
 */
 Fl_Simple_Terminal::~Fl_Simple_Terminal() {
+  Fl::system_driver()->lock_ring();
+  async_dequeue();              // async_check_cb() must not see this terminal
+  Fl::system_driver()->unlock_ring();
+  if ( async_text_ ) { free(async_text_); async_text_ = 0; }
   buffer(0);    // disassociate buffer /before/ we delete it
   if ( buf  ) { delete buf;  buf  = 0; }
   if ( sbuf ) { delete sbuf; sbuf = 0; }
@@ -237,6 +324,14 @@ bool Fl_Simple_Terminal::ansi() const {
      "\033[46m"     Bright Cyan     FL_COURIER, 14
      "\033[47m"     Bright White    FL_COURIER, 14
 
+ Sequences of several values are handled like xterm's SGR sequences,
+ mapped to the closest entries of the style table: e.g. "\033[1;31m"
+ selects the bold variant of entry 31 if the table has one, and
+ "\033[38;5;196m" the entry with the color closest to xterm color 196.
+ "\033[2J" clears the terminal, other sequences are removed from the text.
+ The parser keeps its state between calls of append(), so a sequence can
+ be split across appended strings, e.g. when piping output of a process.
+
  Here's example code demonstrating the use of ANSI codes to select
  the built-in colors, and how it looks in the terminal:
 
@@ -495,6 +590,58 @@ void Fl_Simple_Terminal::enforce_history_lines() {
   }
 }
 
+/**
+ Executes the ANSI sequence "\033[#;#..m" collected by append().
+
+ A single value selects the style table entry of that index, as
+ described in style_table(). Sequences of several values are handled
+ like the SGR (Select Graphic Rendition) sequences of xterm, as far as
+ the style table allows: 0 resets to the normal style, 1 and 22 select
+ the bold or regular entry of the current color, 38;5;# and 38;2;r;g;b
+ the entry with the color closest to xterm color # or to r,g,b, and
+ 39 the normal style. Other values select the entry of that index.
+ Background colors 48;5;# and 48;2;r;g;b are skipped.
+*/
+void Fl_Simple_Terminal::ansi_sgr() {
+  int nstyles = stable_size_ / STE_SIZE;
+  if ( ansi_nvals_ == 0 ) return;       // "\033[m": no change
+  if ( ansi_nvals_ == 1 ) {
+    current_style_index_ = (ansi_vals_[0] == 0)            // "reset"?
+                             ? normal_style_index_         // use normal color for "reset"
+                             : (ansi_vals_[0] % nstyles);  // use user's value, wrapped to ensure not larger than table
+    return;
+  }
+  int style = current_style_index_;
+  int bold = stable_[style].font & FL_BOLD;
+  for ( int i = 0; i < ansi_nvals_; i++ ) {
+    int v = ansi_vals_[i];
+    switch ( v ) {
+      case 0:  style = normal_style_index_; bold = stable_[style].font & FL_BOLD; break;
+      case 1:  bold = 1; break;
+      case 22: bold = 0; break;
+      case 39: style = normal_style_index_; break;
+      case 38:
+      case 48:
+        if ( i + 2 < ansi_nvals_ && ansi_vals_[i+1] == 5 ) {            // 256 colors
+          if ( v == 38 ) {
+            uchar r, g, b;
+            xterm_color(ansi_vals_[i+2] & 255, r, g, b);
+            style = nearest_style(stable_, nstyles, r, g, b);
+          }
+          i += 2;
+        } else if ( i + 4 < ansi_nvals_ && ansi_vals_[i+1] == 2 ) {     // RGB
+          if ( v == 38 )
+            style = nearest_style(stable_, nstyles, (uchar)ansi_vals_[i+2],
+                                  (uchar)ansi_vals_[i+3], (uchar)ansi_vals_[i+4]);
+          i += 4;
+        }
+        break;
+      default: style = v % nstyles; break;
+    }
+  }
+  current_style_index_ = bold_style(stable_, nstyles, style, bold);
+}
+
 /**
  Appends new string 's' to terminal.
 
@@ -509,94 +656,91 @@ void Fl_Simple_Terminal::enforce_history_lines() {
  \see printf(), vprintf(), text(), clear()
 */
 void Fl_Simple_Terminal::append(const char *s, int len) {
+  if ( len < 0 ) len = (int)strlen(s);
   // Remove ansi codes and adjust style buffer accordingly.
   if ( ansi() ) {
-    int nstyles = stable_size_ / STE_SIZE;
-    if ( len < 0 ) len = (int)strlen(s);
     // New text buffer (after ansi codes parsed+removed)
     char *ntm = (char*)malloc(len+1);       // new text memory
     char *ntp = ntm;
     char *nsm = (char*)malloc(len+1);       // new style memory
     char *nsp = nsm;
-    // ANSI values
-    char astyle = 'A'+current_style_index_; // the running style index
-    const char *esc = 0;
-    const char *sp = s;
-    // Walk user's string looking for codes, modify new text/style text as needed
-    while ( *sp ) {
-      if ( *sp == 033 ) {        // "\033.."
-        esc = sp++;
-        switch (*sp) {
-          case 0:                // "\033<NUL>"? stop
-            continue;
-          case '[': {            // "\033[.."
+    const unsigned char *sp = (const unsigned char*)s;
+    const unsigned char *end = sp + len;
+    // Walk user's string, the parser state is kept across calls so that
+    // ANSI sequences can be split between appended strings
+    while ( sp < end ) {
+      switch ( ansi_state_ ) {
+        case ANSI_TEXT: {
+          // Copy a run of ordinary characters at once
+          const unsigned char *run = sp;
+          while ( sp < end && !ansi_special[*sp] ) ++sp;
+          if ( sp > run ) {
+            memcpy(ntp, run, sp - run);
+            memset(nsp, 'A' + current_style_index_, sp - run);
+            ntp += sp - run;
+            nsp += sp - run;
+          }
+          if ( sp == end ) break;
+          switch ( *sp++ ) {
+            case '\n':                  // keep track of #lines
+              ++lines;
+              *ntp++ = '\n';
+              *nsp++ = 'A' + current_style_index_;
+              break;
+            case 033:                   // "\033.."
+              ansi_state_ = ANSI_ESC;
+              break;
+            default:                    // NUL: skip
+              break;
+          }
+          break;
+        }
+        case ANSI_ESC:
+          if ( *sp == '[' ) {           // "\033[.."
             ++sp;
-            int vals[4], tv=0, seqdone=0;
-            while ( *sp && !seqdone && isdigit(*sp) ) { // "\033[#;#.."
-              char *newsp;
-              long a = strtol(sp, &newsp, 10);
-              sp = newsp;
-              vals[tv++] = (a<0) ? 0 : a;       // prevent negative values
-              if ( tv >= 4 )      // too many #'s specified? abort sequence
-                { seqdone = 1; sp = esc+1; continue; }
-              switch(*sp) {
-                case ';':         // numeric separator
-                  ++sp;
-                  continue;
-                case 'J':         // erase in display
-                  switch (vals[0]) {
-                    case 0:       // \033[0J -- clear to eol
-                      // unsupported
-                      break;
-                    case 1:       // \033[1J -- clear to sol
-                      // unsupported
-                      break;
-                    case 2:       // \033[2J -- clear entire screen
-                      clear();    // clear text buffer
-                      ntp = ntm;  // clear text contents accumulated so far
-                      nsp = nsm;  // clear style contents ""
-                      break;
-                  }
-                  ++sp;
-                  seqdone = 1;
-                  continue;
-                case 'm':         // set color
-                  if ( tv > 0 ) { // at least one value parsed?
-                    current_style_index_ = (vals[0] == 0)            // "reset"?
-                                             ? normal_style_index_   // use normal color for "reset"
-                                             : (vals[0] % nstyles);  // use user's value, wrapped to ensure not larger than table
-                    astyle = 'A' + current_style_index_;             // convert index -> style buffer char
-                  }
-                  ++sp;
-                  seqdone = 1;
-                  continue;
-                case '\0':        // EOS in middle of sequence?
-                  *ntp = 0;       // end of text
-                  *nsp = 0;       // end of style
-                  seqdone = 1;
-                  continue;
-                default:          // un-supported cmd?
-                  seqdone = 1;
-                  sp = esc+1;     // continue parsing just past esc
-                  break;
-              }   // switch
-            }     // while
-          }       // case '['
-        }         // switch
-      }           // \033
-      else {
-        // Non-ANSI character?
-        if ( *sp == '\n' ) ++lines; // keep track of #lines
-        *ntp++ = *sp++;             // pass char thru
-        *nsp++ = astyle;            // use current style
+            ansi_state_ = ANSI_CSI;
+            ansi_nvals_ = 0;
+            ansi_val_ = -1;
+          } else {                      // drop the \033, keep the character
+            ansi_state_ = ANSI_TEXT;
+          }
+          break;
+        case ANSI_CSI: {                // "\033[#;#.."
+          unsigned char c = *sp;
+          if ( c >= '0' && c <= '9' ) {
+            if ( ansi_val_ < 0 ) ansi_val_ = 0;
+            if ( ansi_val_ < 10000 ) ansi_val_ = ansi_val_ * 10 + (c - '0');
+          } else if ( c == ';' ) {      // numeric separator, empty value is 0
+            if ( ansi_nvals_ < ANSI_MAXVALS ) ansi_vals_[ansi_nvals_++] = (ansi_val_ < 0) ? 0 : ansi_val_;
+            ansi_val_ = -1;
+          } else if ( c >= 0x20 && c < 0x40 ) {
+            // other parameter or intermediate characters: ignored
+          } else if ( c >= 0x40 && c < 0x7f ) {
+            // final character: execute the sequence
+            if ( ansi_val_ >= 0 && ansi_nvals_ < ANSI_MAXVALS ) ansi_vals_[ansi_nvals_++] = ansi_val_;
+            ansi_state_ = ANSI_TEXT;
+            if ( c == 'm' ) {           // set color
+              ansi_sgr();
+            } else if ( c == 'J' && ansi_nvals_ > 0 && ansi_vals_[0] == 2 ) {
+              // \033[2J -- clear entire screen
+              clear();                  // clear text buffer
+              ntp = ntm;                // clear text contents accumulated so far
+              nsp = nsm;                // clear style contents ""
+            }                           // other commands are unsupported
+          } else {
+            // not part of a sequence: abort it, keep the character
+            ansi_state_ = ANSI_TEXT;
+            continue;
+          }
+          ++sp;
+          break;
+        }
       }
-    } // while
+    }
     *ntp = 0;
     *nsp = 0;
-    //::printf("  RESULT: ntm='%s'\n", ntm);
-    //::printf("  RESULT: nsm='%s'\n", nsm);
-    buf->append(ntm);           // new text memory
-    sbuf->append(nsm);          // new style memory
+    sbuf->append(nsm);          // new style memory (first, so that the
+    buf->append(ntm);           // display measures the new text in its style)
     free(ntm);
     free(nsm);
   } else {
@@ -608,6 +752,111 @@ void Fl_Simple_Terminal::append(const char *s, int len) {
   enforce_stay_at_bottom();
 }
 
+/**
+ Appends new string 's' to the terminal from any thread.
+
+ Unlike append(), this can be called by worker threads without
+ holding Fl::lock(). The text is only queued, and the main thread
+ appends all text queued until then at once the next time it is
+ about to wait for events: one insertion into the text and style
+ buffers, one history update and one redraw, however many lines
+ the worker threads sent in the meantime.
+
+ The main thread must have called Fl::lock() once to enable
+ multithreading support, see Fl::awake(), and the terminal must
+ not be deleted while other threads can still call this method.
+ Text still queued when the terminal is deleted is discarded.
+
+ \param s string to append.
+
+ \param len optional length of string can be specified if known
+            to save the internals from having to call strlen()
+
+ \see append(), flush_async()
+*/
+void Fl_Simple_Terminal::append_async(const char *s, int len) {
+  if ( len < 0 ) len = (int)strlen(s);
+  if ( len == 0 ) return;
+  Fl::system_driver()->lock_ring();
+  int was_empty = (async_len_ == 0);
+  int start = !async_started;       // first call: register async_check_cb()
+  async_started = 1;
+  if ( async_len_ + len + 1 > async_size_ ) {
+    int size = async_size_ ? async_size_ * 2 : 4096;
+    while ( size < async_len_ + len + 1 ) size *= 2;
+    async_text_ = (char*)realloc(async_text_, size);
+    async_size_ = size;
+  }
+  memcpy(async_text_ + async_len_, s, len);
+  async_len_ += len;
+  async_text_[async_len_] = 0;
+  if ( was_empty ) {                // queue this terminal for async_check_cb()
+    async_next_ = async_first;
+    async_first = this;
+  }
+  Fl::system_driver()->unlock_ring();
+  if ( start ) {
+    // Fl::add_check() must be called by the main thread
+    if ( Fl::awake(async_start_cb) != 0 ) {
+      // awake ring full: register it while holding the FLTK lock instead
+      Fl::lock();
+      if ( !Fl::has_check(async_check_cb) ) Fl::add_check(async_check_cb);
+      Fl::unlock();
+      Fl::awake();
+    }
+  } else if ( was_empty ) {
+    Fl::awake();                    // wake up the main thread, once per batch
+  }
+}
+
+/**
+ Appends the text queued by append_async() to the terminal now.
+
+ This is called automatically by the main thread before it waits
+ for events. It must only be called by the thread holding Fl::lock().
+*/
+void Fl_Simple_Terminal::flush_async() {
+  Fl::system_driver()->lock_ring();
+  async_dequeue();
+  char *text = async_text_;
+  int len = async_len_;
+  async_text_ = 0;
+  async_len_ = 0;
+  async_size_ = 0;
+  Fl::system_driver()->unlock_ring();
+  if ( !text ) return;
+  if ( len > 0 ) append(text, len);
+  free(text);
+}
+
+// Removes this terminal from the terminals with queued text.
+// Must be called with the awake ring locked.
+void Fl_Simple_Terminal::async_dequeue() {
+  if ( async_len_ == 0 ) return;    // not queued
+  Fl_Simple_Terminal **t = &async_first;
+  while ( *t != this ) t = &(*t)->async_next_;
+  *t = async_next_;
+  async_next_ = 0;
+}
+
+// Appends the queued text of all terminals, one terminal at a time,
+// so that a terminal deleted meanwhile is never visited
+void Fl_Simple_Terminal::async_check_cb(void *) {
+  for (;;) {
+    Fl::system_driver()->lock_ring();
+    Fl_Simple_Terminal *t = async_first;
+    Fl::system_driver()->unlock_ring();
+    if ( !t ) break;
+    t->flush_async();               // dequeues t
+  }
+}
+
+void Fl_Simple_Terminal::async_start_cb(void *) {
+  if ( !Fl::has_check(async_check_cb) )
+    Fl::add_check(async_check_cb);
+  async_check_cb(0);
+}
+
 /**
  Replaces the terminal with new text content in string 's'.
 
@@ -697,6 +946,7 @@ void Fl_Simple_Terminal::clear() {
   buf->text("");
   sbuf->text("");
   lines = 0;
+  ansi_state_ = ANSI_TEXT;      // drop an incomplete ANSI sequence
 }
 
 /**
@@ -709,8 +959,10 @@ void Fl_Simple_Terminal::clear() {
  \param count -- number of lines to remove
 */
 void Fl_Simple_Terminal::remove_lines(int start, int count) {
-  int spos = skip_lines(0, start, true);
-  int epos = skip_lines(spos, count, true);
+  // Count lines in the buffer, not wrapped lines of the display,
+  // just like the 'lines' count and history_lines() do
+  int spos = buf->skip_lines(0, start);
+  int epos = buf->skip_lines(spos, count);
   if ( ansi() ) {
     buf->remove(spos, epos);
     sbuf->remove(spos, epos);
@@ -61,7 +61,7 @@ void Fl_Table::row_position(int row) {
   }
   vscrollbar->Fl_Slider::value(newtop);
   table_scrolled();
-  redraw();
+  _redraw_scrolled(tix, tiy, tiw, tih);
   _row_position = row;  // HACK: override what table_scrolled() came up with
 }
 
@@ -80,7 +80,7 @@ void Fl_Table::col_position(int col) {
   }
   hscrollbar->Fl_Slider::value(newleft);
   table_scrolled();
-  redraw();
+  _redraw_scrolled(tix, tiy, tiw, tih);
   _col_position = col;  // HACK: override what table_scrolled() came up with
 }
 
@@ -144,6 +144,8 @@ Fl_Table::Fl_Table(int X, int Y, int W, int H, const char *l) : Fl_Group(X,Y,W,H
   _redraw_botrow    = -1;
   _redraw_leftcol   = -1;
   _redraw_rightcol  = -1;
+  _drawn_hscroll    = 0;
+  _drawn_vscroll    = 0;
   table_w           = 0;
   table_h           = 0;
   toprow            = 0;
@@ -645,9 +647,24 @@ void Fl_Table::table_resized() {
 */
 void Fl_Table::scroll_cb(Fl_Widget*w, void *data) {
   Fl_Table *o = (Fl_Table*)data;
+  int X = o->tix, Y = o->tiy, W = o->tiw, H = o->tih;
   o->recalc_dimensions();       // recalc tix, tiy, etc.
   o->table_scrolled();
-  o->redraw();
+  o->_redraw_scrolled(X, Y, W, H);
+}
+
+// Redraw the table after it was scrolled.
+//    X/Y/W/H are the inner table dimensions before scrolling. If they did
+//    not change, draw() can move the cells already on the screen and only
+//    draw those that were scrolled into view (FL_DAMAGE_SCROLL).
+//
+void Fl_Table::_redraw_scrolled(int X, int Y, int W, int H) {
+  if ( X == tix && Y == tiy && W == tiw && H == tih &&
+       !table->visible() && table->box() == FL_NO_BOX ) {
+    damage(FL_DAMAGE_SCROLL);
+  } else {
+    redraw();
+  }
 }
 
 /**
@@ -1245,10 +1262,113 @@ void Fl_Table::set_selection(int row_top, int col_left, int row_bot, int col_rig
   damage_zone(current_row, current_col, select_row, select_col);
 }
 
+// Draw cells, headers and dead zones that intersect X/Y/W/H.
+//    Cells outside of X/Y/W/H may be drawn too, the caller has to clip.
+//
+void Fl_Table::_draw_cells(int X, int Y, int W, int H) {
+  int scrollsize = _scrollbar_size ? _scrollbar_size : Fl::scrollbar_size();
+  // Find the rows and columns in X/Y/W/H
+  int r1 = toprow, r2, c1 = leftcol, c2;
+  int p = int(row_scroll_position(r1) - vscrollbar->value()) + tiy;
+  for ( ; r1 < botrow && p + row_height(r1) < Y; r1++ ) p += row_height(r1);
+  for ( r2 = r1; r2 < botrow && p + row_height(r2) <= Y + H; r2++ ) p += row_height(r2);
+  p = int(col_scroll_position(c1) - hscrollbar->value()) + tix;
+  for ( ; c1 < rightcol && p + col_width(c1) < X; c1++ ) p += col_width(c1);
+  for ( c2 = c1; c2 < rightcol && p + col_width(c2) <= X + W; c2++ ) p += col_width(c2);
+  int BX,BY,BW,BH;
+  // Draw row headers, if any
+  if ( row_header() ) {
+    get_bounds(CONTEXT_ROW_HEADER, BX, BY, BW, BH);
+    fl_push_clip(BX,BY,BW,BH);
+    for ( int r = r1; r <= r2; r++ ) {
+      _redraw_cell(CONTEXT_ROW_HEADER, r, 0);
+    }
+    fl_pop_clip();
+  }
+  // Draw column headers, if any
+  if ( col_header() ) {
+    get_bounds(CONTEXT_COL_HEADER, BX, BY, BW, BH);
+    fl_push_clip(BX,BY,BW,BH);
+    for ( int c = c1; c <= c2; c++ ) {
+      _redraw_cell(CONTEXT_COL_HEADER, 0, c);
+    }
+    fl_pop_clip();
+  }
+  // Draw all cells.
+  //    This includes cells partially obscured off edges of table.
+  //    No longer do this last; you might think it would be nice
+  //    to draw over dead zones, but on redraws it flickers. Avoid
+  //    drawing over deadzones; prevent deadzones by sizing columns.
+  //
+  fl_push_clip(tix, tiy, tiw, tih); {
+    for ( int r = r1; r <= r2; r++ ) {
+      for ( int c = c1; c <= c2; c++ ) {
+        _redraw_cell(CONTEXT_CELL, r, c);
+      }
+    }
+  }
+  fl_pop_clip();
+  // Draw little rectangle in corner of headers
+  if ( row_header() && col_header() ) {
+    fl_rectf(wix, wiy, row_header_width(), col_header_height(), color());
+  }
+
+  // Table has a boxtype? Close those few dead pixels
+  if ( table->box() ) {
+    if ( col_header() ) {
+      fl_rectf(tox, wiy, Fl::box_dx(table->box()), col_header_height(), color());
+    }
+    if ( row_header() ) {
+      fl_rectf(wix, toy, row_header_width(), Fl::box_dx(table->box()), color());
+    }
+  }
+
+  // Table width smaller than window? Fill remainder with rectangle
+  if ( table_w < tiw ) {
+    fl_rectf(tix + table_w, tiy, tiw - table_w, tih, color());
+    // Col header? fill that too
+    if ( col_header() ) {
+      fl_rectf(tix + table_w,
+               wiy,
+               // get that corner just right..
+               (tiw - table_w + Fl::box_dw(table->box()) -
+                Fl::box_dx(table->box())),
+               col_header_height(),
+               color());
+    }
+  }
+  // Table height smaller than window? Fill remainder with rectangle
+  if ( table_h < tih ) {
+    fl_rectf(tix, tiy + table_h, tiw, tih - table_h, color());
+    if ( row_header() ) {
+      // NOTE:
+      //     Careful with that lower corner; don't use tih; when eg.
+      //     table->box(FL_THIN_UP_FRAME) and hscrollbar hidden,
+      //     leaves a row of dead pixels.
+      //
+      fl_rectf(wix, tiy + table_h, row_header_width(),
+               (wiy+wih) - (tiy+table_h) -
+               ( hscrollbar->visible() ? scrollsize : 0),
+               color());
+    }
+  }
+}
+
+// Draw the cells scrolled into view (fl_scroll_by_copy() callback)
+void Fl_Table::_draw_cells_cb(void *v, int X, int Y, int W, int H) {
+  fl_push_clip(X, Y, W, H);
+  ((Fl_Table*)v)->_draw_cells(X, Y, W, H);
+  fl_pop_clip();
+}
+
 /**
   Draws the entire Fl_Table.
   Lets fltk widgets draw themselves first, followed by the cells
   via calls to draw_cell().
+
+  If the table was only scrolled (FL_DAMAGE_SCROLL), the cells on the
+  screen are moved with fl_scroll_by_copy() and draw_cell() is called
+  only for the cells scrolled into view.
 */
 void Fl_Table::draw() {
     int scrollsize = _scrollbar_size ? _scrollbar_size : Fl::scrollbar_size();
@@ -1262,19 +1382,26 @@ void Fl_Table::draw() {
   draw_cell(CONTEXT_STARTPAGE, 0, 0,            // let user's drawing routine
             tix, tiy, tiw, tih);                // prep new page
 
+  int all = damage() & FL_DAMAGE_ALL;
+  int scrolled = !all && (damage() & FL_DAMAGE_SCROLL);
+
   // Let fltk widgets draw themselves first. Do this after
   // draw_cell(CONTEXT_STARTPAGE) in case user moves widgets around.
   // Use window 'inner' clip to prevent drawing into table border.
   // (unfortunately this clips FLTK's border, so we must draw it explicity below)
   //
   fl_push_clip(wix, wiy, wiw, wih);
-  {
+  if ( scrolled ) {
+    // Only the scrollbars changed, don't erase the cells
+    update_child(*vscrollbar);
+    update_child(*hscrollbar);
+  } else {
     Fl_Group::draw();
   }
   fl_pop_clip();
 
   // Explicitly draw border around widget, if any
-  draw_box(box(), x(), y(), w(), h(), color());
+  if ( !scrolled ) draw_box(box(), x(), y(), w(), h(), color());
 
   // If Fl_Scroll 'table' is hidden, draw its box
   //    Do this after Fl_Group::draw() so we draw over scrollbars
@@ -1288,8 +1415,26 @@ void Fl_Table::draw() {
   // Clip all further drawing to the inner widget dimensions
   fl_push_clip(wix, wiy, wiw, wih);
   {
+    // Only scrolled? Move cells and headers already on the screen
+    if ( scrolled ) {
+      double dx = _drawn_hscroll - hscrollbar->value();
+      double dy = _drawn_vscroll - vscrollbar->value();
+      if ( dx != int(dx) || dy != int(dy) ||
+           !fl_scroll_by_copy(tix, tiy, tiw, tih, int(dx), int(dy), _draw_cells_cb, this) ) {
+        all = 1;
+      } else {
+        if ( row_header() &&
+             !fl_scroll_by_copy(wix, tiy, row_header_width(), tih, 0, int(dy), _draw_cells_cb, this) ) {
+          _draw_cells_cb(this, wix, tiy, row_header_width(), tih);
+        }
+        if ( col_header() &&
+             !fl_scroll_by_copy(tix, wiy, tiw, col_header_height(), int(dx), 0, _draw_cells_cb, this) ) {
+          _draw_cells_cb(this, tix, wiy, tiw, col_header_height());
+        }
+      }
+    }
     // Only redraw a few cells?
-    if ( ! ( damage() & FL_DAMAGE_ALL ) && _redraw_leftcol != -1 ) {
+    if ( ! all && _redraw_leftcol != -1 ) {
       fl_push_clip(tix, tiy, tiw, tih);
       for ( int c = _redraw_leftcol; c <= _redraw_rightcol; c++ ) {
         for ( int r = _redraw_toprow; r <= _redraw_botrow; r++ ) {
@@ -1298,84 +1443,8 @@ void Fl_Table::draw() {
       }
       fl_pop_clip();
     }
-    if ( damage() & FL_DAMAGE_ALL ) {
-      int X,Y,W,H;
-      // Draw row headers, if any
-      if ( row_header() ) {
-        get_bounds(CONTEXT_ROW_HEADER, X, Y, W, H);
-        fl_push_clip(X,Y,W,H);
-        for ( int r = toprow; r <= botrow; r++ ) {
-          _redraw_cell(CONTEXT_ROW_HEADER, r, 0);
-        }
-        fl_pop_clip();
-      }
-      // Draw column headers, if any
-      if ( col_header() ) {
-        get_bounds(CONTEXT_COL_HEADER, X, Y, W, H);
-        fl_push_clip(X,Y,W,H);
-        for ( int c = leftcol; c <= rightcol; c++ ) {
-          _redraw_cell(CONTEXT_COL_HEADER, 0, c);
-        }
-        fl_pop_clip();
-      }
-      // Draw all cells.
-      //    This includes cells partially obscured off edges of table.
-      //    No longer do this last; you might think it would be nice
-      //    to draw over dead zones, but on redraws it flickers. Avoid
-      //    drawing over deadzones; prevent deadzones by sizing columns.
-      //
-      fl_push_clip(tix, tiy, tiw, tih); {
-        for ( int r = toprow; r <= botrow; r++ ) {
-          for ( int c = leftcol; c <= rightcol; c++ ) {
-            _redraw_cell(CONTEXT_CELL, r, c);
-          }
-        }
-      }
-      fl_pop_clip();
-      // Draw little rectangle in corner of headers
-      if ( row_header() && col_header() ) {
-        fl_rectf(wix, wiy, row_header_width(), col_header_height(), color());
-      }
-
-      // Table has a boxtype? Close those few dead pixels
-      if ( table->box() ) {
-        if ( col_header() ) {
-          fl_rectf(tox, wiy, Fl::box_dx(table->box()), col_header_height(), color());
-        }
-        if ( row_header() ) {
-          fl_rectf(wix, toy, row_header_width(), Fl::box_dx(table->box()), color());
-        }
-      }
-
-      // Table width smaller than window? Fill remainder with rectangle
-      if ( table_w < tiw ) {
-        fl_rectf(tix + table_w, tiy, tiw - table_w, tih, color());
-        // Col header? fill that too
-        if ( col_header() ) {
-          fl_rectf(tix + table_w,
-                   wiy,
-                   // get that corner just right..
-                   (tiw - table_w + Fl::box_dw(table->box()) -
-                    Fl::box_dx(table->box())),
-                   col_header_height(),
-                   color());
-        }
-      }
-      // Table height smaller than window? Fill remainder with rectangle
-      if ( table_h < tih ) {
-        fl_rectf(tix, tiy + table_h, tiw, tih - table_h, color());
-        if ( row_header() ) {
-          // NOTE:
-          //     Careful with that lower corner; don't use tih; when eg.
-          //     table->box(FL_THIN_UP_FRAME) and hscrollbar hidden,
-          //     leaves a row of dead pixels.
-          //
-          fl_rectf(wix, tiy + table_h, row_header_width(),
-                   (wiy+wih) - (tiy+table_h) -
-                   ( hscrollbar->visible() ? scrollsize : 0),
-                   color());
-        }
-      }
+    if ( all ) {
+      _draw_cells(wix, wiy, wiw, wih);
     }
     // Both scrollbars? Draw little box in lower right
     if ( vscrollbar->visible() && hscrollbar->visible() ) {
@@ -1386,6 +1455,8 @@ void Fl_Table::draw() {
               tix, tiy, tiw, tih);              // routines cleanup
 
     _redraw_leftcol = _redraw_rightcol = _redraw_toprow = _redraw_botrow = -1;
+    _drawn_hscroll = hscrollbar->value();
+    _drawn_vscroll = vscrollbar->value();
   }
   fl_pop_clip();
 }
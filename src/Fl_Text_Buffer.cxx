@@ -108,6 +108,7 @@ Fl_Text_Buffer::Fl_Text_Buffer(int requestedSize, int preferredGapSize)
   mBuf = (char *) malloc(requestedSize + mPreferredGapSize);
   mGapStart = 0;
   mGapEnd = requestedSize + mPreferredGapSize;
+  mFrontGap = 0;
   mTabDist = 8;
   mPrimary.mSelected = 0;
   mPrimary.mStart = mPrimary.mEnd = 0;
@@ -133,7 +134,7 @@ Fl_Text_Buffer::Fl_Text_Buffer(int requestedSize, int preferredGapSize)
  */
 Fl_Text_Buffer::~Fl_Text_Buffer()
 {
-  free(mBuf);
+  free(mBuf - mFrontGap);
   if (mNModifyProcs != 0) {
     delete[]mModifyProcs;
     delete[]mCbArgs;
@@ -174,7 +175,8 @@ void Fl_Text_Buffer::text(const char *t)
   /* Save information for redisplay, and get rid of the old buffer */
   const char *deletedText = text();
   int deletedLength = mLength;
-  free((void *) mBuf);
+  free((void *) (mBuf - mFrontGap));
+  mFrontGap = 0;
 
   /* Start a new buffer with a gap of mPreferredGapSize at the end */
   int insertedLength = (int) strlen(t);
@@ -1177,10 +1179,15 @@ int Fl_Text_Buffer::insert_(int pos, const char *text)
    the current buffer, just move the gap (if necessary) to where
    the text should be inserted.  If the new text is too large, reallocate
    the buffer with a gap large enough to accomodate the new text and a
-   gap of mPreferredGapSize */
-  if (insertedLength > mGapEnd - mGapStart)
-    reallocate_with_gap(pos, insertedLength + mPreferredGapSize);
-  else if (pos != mGapStart)
+   gap of mPreferredGapSize or a quarter of the buffer length */
+  if (insertedLength > mGapEnd - mGapStart) {
+    /* the gap grows with the buffer, so that a buffer that is filled bit
+     by bit (e.g. a log, also when it is emptied at the start, see remove_())
+     is not copied again every few KB */
+    int gapLen = mLength / 4;
+    if (gapLen < mPreferredGapSize) gapLen = mPreferredGapSize;
+    reallocate_with_gap(pos, insertedLength + gapLen);
+  } else if (pos != mGapStart)
     move_gap(pos);
 
   /* Insert the new text (pos now corresponds to the start of the gap) */
@@ -1228,6 +1235,20 @@ void Fl_Text_Buffer::remove_(int start, int end)
     undowidget = this;
   }
 
+  if (start == 0 && end <= mGapStart) {
+    /* removing text at the start of the buffer before the gap: instead of
+     moving the rest of the text, skip the removed text */
+    if (mCanUndo)
+      memcpy(undobuffer, mBuf, end);
+    mBuf += end;
+    mFrontGap += end;
+    mGapStart -= end;
+    mGapEnd -= end;
+    mLength -= end;
+    update_selections(0, end, 0);
+    return;
+  }
+
   if (start > mGapStart) {
     if (mCanUndo)
       memcpy(undobuffer, mBuf + (mGapEnd - mGapStart) + start,
@@ -1500,8 +1521,9 @@ void Fl_Text_Buffer::reallocate_with_gap(int newGapStart, int newGapLen)
            &mBuf[mGapEnd + newGapStart - mGapStart],
            mLength - newGapStart);
   }
-  free((void *) mBuf);
+  free((void *) (mBuf - mFrontGap));
   mBuf = newBuf;
+  mFrontGap = 0;
   mGapStart = newGapStart;
   mGapEnd = newGapEnd;
 }
@@ -117,6 +117,10 @@ Fl_Text_Display::Fl_Text_Display(int X, int Y, int W, int H, const char* l)
   mLastChar = 0;
   mContinuousWrap = 0;
   mWrapMarginPix = 0;
+  mWrapCountWidth = -1;
+  mWrapCountOld = -1;
+  mWrapCountBufferLines = 0;
+  mWrapCountOldNewlines = 0;
   mLineStarts = new int[mNVisibleLines];
   { // This code unused unless mNVisibleLines is ever initialized >1
     for (int i=1; i<mNVisibleLines; i++) mLineStarts[i] = -1;
@@ -364,6 +368,7 @@ void Fl_Text_Display::buffer( Fl_Text_Buffer *buf ) {
   /* Add the buffer to the display, and attach a callback to the buffer for
    receiving modification information when the buffer contents change */
   mBuffer = buf;
+  mWrapCountWidth = -1;
   if (mBuffer) {
     mBuffer->add_modify_callback( buffer_modified_cb, this );
     mBuffer->add_predelete_callback( buffer_predelete_cb, this );
@@ -421,6 +426,7 @@ void Fl_Text_Display::highlight_data(Fl_Text_Buffer *styleBuffer,
   mUnfinishedHighlightCB = unfinishedHighlightCB;
   mHighlightCBArg = cbArg;
   mColumnScale = 0;
+  mWrapCountWidth = -1;
 
   mStyleBuffer->canUndo(0);
   damage(FL_DAMAGE_EXPOSE);
@@ -462,6 +468,10 @@ void Fl_Text_Display::resize(int X, int Y, int W, int H) {
   fflush(stdout);
 #endif // DEBUG2
 
+  // buffer_modified_cb() calls this after each modification with the same
+  // size, the wrapped line counts it updated must be kept in that case
+  if (W != w() || H != h() || Fl_Window::is_a_rescale())
+    mWrapCountWidth = -1;
   Fl_Widget::resize(X,Y,W,H);
   mColumnScale = 0; // force recomputation of the width of a column when display is rescaled
   recalc_display();
@@ -504,13 +514,17 @@ void Fl_Text_Display::recalc_display() {
   // to determine line wrapping.
   // Note: active since Oct 25, 2017: commit eb772d027d (svn r12526)
 
-  // force _first_ calculation in loop (STR #3412)
-  int oldTAWidth = -1; // was: text_area.w (before STR #3412)
+  // force _first_ calculation in loop (STR #3412), unless the line counts
+  // were made for the current settings and kept up to date since then by
+  // buffer_modified_cb(), which calls this after each buffer modification
+  int oldTAWidth = mWrapCountWidth; // was: text_area.w (before STR #3412)
 
   if (mContinuousWrap && !mWrapMarginPix) {
 
     int nvlines = (text_area.h + mMaxsize - 1) / mMaxsize;
-    int nlines = buffer()->count_lines(0,buffer()->length());
+    if (oldTAWidth < 0)
+      mWrapCountBufferLines = buffer()->count_lines(0,buffer()->length());
+    int nlines = mWrapCountBufferLines;
     if (nvlines < 1) nvlines = 1;
     if (nlines >= nvlines-1) {
       mVScrollBar->set_visible(); // we need a vertical scrollbar
@@ -519,6 +533,18 @@ void Fl_Text_Display::recalc_display() {
   }
   // End of optimization, see comment above.
 
+  if (mContinuousWrap && !mWrapMarginPix && text_area.w == oldTAWidth) {
+    // the line counts are up to date, only the top line is counted again,
+    // from the closer end of the buffer
+    int oldFirstChar = mFirstChar;
+    mFirstChar = line_start(mFirstChar);
+    if (mFirstChar < buffer()->length() / 2)
+      mTopLineNum = count_lines(0, mFirstChar, true)+1;
+    else
+      mTopLineNum = mNBufferLines - count_lines(mFirstChar, buffer()->length(), true)+1;
+    absolute_top_line_number(oldFirstChar);
+  }
+
   for (int again = 1; again;) {
     again = 0;
     /* In continuous wrap mode, a change in width affects the total number of
@@ -537,6 +563,9 @@ void Fl_Text_Display::recalc_display() {
       mFirstChar = line_start(mFirstChar);
       mTopLineNum = count_lines(0, mFirstChar, true)+1;
       absolute_top_line_number(oldFirstChar);
+      mWrapCountWidth = text_area.w;
+      mWrapCountLastStart = buffer()->line_start(buffer()->length());
+      mWrapCountLastLines = count_lines(mWrapCountLastStart, buffer()->length(), true);
 #ifdef DEBUG2
       printf("    mNBufferLines=%d\n", mNBufferLines);
 #endif // DEBUG2
@@ -955,6 +984,7 @@ void Fl_Text_Display::wrap_mode(int wrap, int wrapMargin) {
     mAbsTopLineNum = 1;         // changed from 0 to 1 -- LZA / STR#2621
   }
 
+  mWrapCountWidth = -1;
   recalc_display();             // resize(x(), y(), w(), h());
 }
 
@@ -1644,6 +1674,8 @@ void Fl_Text_Display::buffer_predelete_cb(int pos, int nDeleted, void *cbArg) {
    of the text may be completely different. */
     IS_UTF8_ALIGNED2(textD->buffer(), pos)
     textD->measure_deleted_lines(pos, nDeleted);
+    if (!textD->mWrapMarginPix && textD->mWrapCountWidth >= 0)
+      textD->wrap_count_predelete(pos, nDeleted);
   } else {
     textD->mSuppressResync = 0; /* Probably not needed, but just in case */
   }
@@ -1718,7 +1750,10 @@ void Fl_Text_Display::buffer_modified_cb( int pos, int nInserted, int nDeleted,
   }
 
   /* Update the line count for the whole buffer */
-  textD->mNBufferLines += linesInserted - linesDeleted;
+  if (textD->mContinuousWrap && !textD->mWrapMarginPix && textD->mWrapCountWidth >= 0)
+    textD->wrap_count_modified(pos, nInserted, nDeleted);
+  else
+    textD->mNBufferLines += linesInserted - linesDeleted;
 
   /* Update the cursor position */
   if ( textD->mCursorToHint != NO_HINT ) {
@@ -3544,7 +3579,7 @@ void Fl_Text_Display::wrapped_line_counter(Fl_Text_Buffer *buf, int startPos,
   *retPos = buf->length();
   *retLines = nLines;
   if (countLastLineMissingNewLine && colNum > 0)
-    *retLines = buf->next_char(*retLines);
+    (*retLines)++;
   *retLineStart = lineStart;
   *retLineEnd = buf->length();
 }
@@ -3663,6 +3698,86 @@ int Fl_Text_Display::wrap_uses_character(int lineEndPos) const {
 }
 
 
+/**
+ \brief Wrapping calculations.
+
+ Count the wrapped lines of the text that is about to be modified, that is
+ all lines from the start of the line at \p pos to the newline after
+ \p pos + \p nDeleted. Only lines that end with a newline are counted, the
+ last line of the buffer is counted by wrap_count_modified() itself.
+ If whole lines are deleted, the line after them is not counted, so that
+ lines removed from the start of a large buffer are not measured twice.
+
+ \param pos
+ \param nDeleted
+ */
+void Fl_Text_Display::wrap_count_predelete(int pos, int nDeleted) {
+  Fl_Text_Buffer *buf = buffer();
+  int start, end;
+
+  mWrapCountOldNewlines = buf->count_lines(pos, pos + nDeleted);
+  mWrapCountOld = -1;
+  if (pos >= mWrapCountLastStart)
+    return;
+  start = buf->line_start(pos);
+  end = pos + nDeleted;
+  if (start != pos || nDeleted == 0 || buf->byte_at(end - 1) != '\n') {
+    end = buf->line_end(end);
+    if (end < buf->length()) end++;
+  }
+  mWrapCountOld = count_lines(start, end, true);
+  mWrapCountOldEnd = buf->length() - end;
+}
+
+
+/**
+ \brief Wrapping calculations.
+
+ Keep the number of wrapped lines in the buffer (mNBufferLines) up to date
+ after a modification of the buffer. Lines never wrap across a newline, so
+ only the lines counted by wrap_count_predelete() are counted again, or the
+ last line of the buffer if the modification is in it, e.g. when text is
+ appended. If the lines could not be counted before the modification, all
+ lines are counted again by the next call of recalc_display().
+
+ \param pos
+ \param nInserted
+ \param nDeleted
+ */
+void Fl_Text_Display::wrap_count_modified(int pos, int nInserted, int nDeleted) {
+  Fl_Text_Buffer *buf = buffer();
+  int length = buf->length();
+  int start, end;
+
+  if (nInserted == 0 && nDeleted == 0)
+    return;
+  mWrapCountBufferLines += buf->count_lines(pos, pos + nInserted);
+  if (nDeleted) mWrapCountBufferLines -= mWrapCountOldNewlines;
+  mWrapCountOldNewlines = 0;
+  if (pos >= mWrapCountLastStart) {
+    start = mWrapCountLastStart;
+    end = length;
+    mNBufferLines -= mWrapCountLastLines;
+  } else {
+    end = length - mWrapCountOldEnd;
+    if (mWrapCountOld < 0 || (end > 0 && end < length && buf->byte_at(end - 1) != '\n')) {
+      mWrapCountWidth = -1;
+      return;
+    }
+    start = buf->line_start(pos);
+    mNBufferLines -= mWrapCountOld;
+  }
+  mNBufferLines += count_lines(start, end, true);
+  if (end == length) {
+    mWrapCountLastStart = buf->line_start(length);
+    mWrapCountLastLines = count_lines(mWrapCountLastStart, length, true);
+  } else {
+    mWrapCountLastStart += nInserted - nDeleted;
+  }
+  mWrapCountOld = -1;
+}
+
+
 /**
  \brief I don't know what this does!
 
@@ -7,6 +7,9 @@
 #include <FL/Fl_Tree.H>
 #include <FL/Fl_Preferences.H>
 #include <FL/fl_string.h>
+#include <FL/fl_draw.H>
+
+extern int fl_box_flat_inside(Fl_Boxtype); // in fl_boxtype.cxx
 
 //////////////////////
 // Fl_Tree.cxx
@@ -27,8 +30,11 @@
 //
 
 // INTERNAL: scroller callback (hor+vert scroll)
+//    Only the scroll position changed: draw() can move the items
+//    already on the screen instead of drawing all of them again.
+//
 static void scroll_cb(Fl_Widget*,void *data) {
-  ((Fl_Tree*)data)->redraw();
+  ((Fl_Tree*)data)->damage(FL_DAMAGE_SCROLL);
 }
 
 // INTERNAL: Parse elements from 'path' into an array of null terminated strings
@@ -85,6 +91,8 @@ Fl_Tree::Fl_Tree(int X, int Y, int W, int H, const char *L) : Fl_Group(X,Y,W,H,L
   _scrollbar_size  = 0;                         // 0: uses Fl::scrollbar_size()
 
   _lastselect       = 0;
+  _drawn_hpos       = 0;
+  _drawn_vpos       = 0;
 
   box(FL_DOWN_BOX);
   color(FL_BACKGROUND2_COLOR, FL_SELECTION_COLOR);
@@ -696,41 +704,80 @@ void Fl_Tree::resize(int X,int Y,int W, int H) {
   init_sizes();
 }
 
+// INTERNAL: Draw the items of the tree inside the current clip region
+void Fl_Tree::draw_items() {
+  // These values are changed during drawing
+  // By end, 'Y' will be the lowest point on the tree
+  int X = _tix + _prefs.marginleft() - _hscroll->value();
+  int Y = _tiy + _prefs.margintop()  - _vscroll->value();
+  int W = _tiw - X + _tix;
+  // Adjust root's X/W if connectors off
+  if (_prefs.connectorstyle() == FL_TREE_CONNECTOR_NONE) {
+    X -= _prefs.openicon()->w();
+    W += _prefs.openicon()->w();
+  }
+  // Draw entire tree, starting with root
+  fl_push_clip(_tix,_tiy,_tiw,_tih);
+  {
+    int xmax = 0;
+    fl_font(_prefs.labelfont(), _prefs.labelsize());
+    _root->draw(X, Y, W,                                // descend into tree here to draw it
+                (Fl::focus()==this)?_item_focus:0,      // show focus item ONLY if Fl_Tree has focus
+                xmax, 1, 1);
+  }
+  fl_pop_clip();
+}
+
+// INTERNAL: fl_scroll_by_copy() callback, draws the part of the tree
+//           that was scrolled into view
+//
+void Fl_Tree::draw_scrolled(void *v, int X, int Y, int W, int H) {
+  Fl_Tree *tree = (Fl_Tree*)v;
+  fl_push_clip(X, Y, W, H);
+  tree->draw_box();
+  tree->draw_items();
+  fl_pop_clip();
+}
+
 /// Standard FLTK draw() method, handles drawing the tree widget.
+///
+/// If the tree was only scrolled (FL_DAMAGE_SCROLL), the items on the
+/// screen are moved with fl_scroll_by_copy() and only those scrolled
+/// into view are drawn.
+///
 void Fl_Tree::draw() {
   fix_scrollbar_order();
+  int X = _tix, Y = _tiy, W = _tiw, H = _tih;
   // Has tree recalc been scheduled? If so, do it
   if ( _tree_w == -1 ) calc_tree();
   else calc_dimensions();
+  // Only scrolled? Then copy the items on the screen, if..
+  int dx = _drawn_hpos - (int)_hscroll->value();
+  int dy = _drawn_vpos - (int)_vscroll->value();
+  int scrolled = !(damage() & FL_DAMAGE_ALL) && (damage() & FL_DAMAGE_SCROLL) &&
+                 X == _tix && Y == _tiy && W == _tiw && H == _tih &&
+                 Fl_Group::children() <= 2 &&                   // ..no item widgets
+                 fl_box_flat_inside(box()) &&                   // ..background is uniform
+                 !(_prefs.selectmode() == FL_TREE_SELECT_SINGLE_DRAGGABLE &&
+                   Fl::pushed() == this) &&                     // ..no dragging line
+                 (_prefs.connectorstyle() == FL_TREE_CONNECTOR_NONE ||
+                  !((dx | dy) & 1));                            // ..keeps the dot pattern
   // Let group draw box+label but *NOT* children.
   // We handle drawing children ourselves by calling each item's draw()
   {
     // Draw group's bg + label
-    if ( damage() & ~FL_DAMAGE_CHILD) { // redraw entire widget?
+    if ( (damage() & ~FL_DAMAGE_CHILD) && !scrolled ) { // redraw entire widget?
       Fl_Group::draw_box();
       Fl_Group::draw_label();
     }
     if ( ! _root ) return;
-    // These values are changed during drawing
-    // By end, 'Y' will be the lowest point on the tree
-    int X = _tix + _prefs.marginleft() - _hscroll->value();
-    int Y = _tiy + _prefs.margintop()  - _vscroll->value();
-    int W = _tiw - X + _tix;
-    // Adjust root's X/W if connectors off
-    if (_prefs.connectorstyle() == FL_TREE_CONNECTOR_NONE) {
-      X -= _prefs.openicon()->w();
-      W += _prefs.openicon()->w();
-    }
-    // Draw entire tree, starting with root
-    fl_push_clip(_tix,_tiy,_tiw,_tih);
-    {
-      int xmax = 0;
-      fl_font(_prefs.labelfont(), _prefs.labelsize());
-      _root->draw(X, Y, W,                              // descend into tree here to draw it
-                  (Fl::focus()==this)?_item_focus:0,    // show focus item ONLY if Fl_Tree has focus
-                  xmax, 1, 1);
+    if ( !scrolled ) {
+      draw_items();
+    } else if ( !fl_scroll_by_copy(_tix, _tiy, _tiw, _tih, dx, dy, draw_scrolled, this) ) {
+      draw_scrolled(this, _tix, _tiy, _tiw, _tih);
     }
-    fl_pop_clip();
+    _drawn_hpos = (int)_hscroll->value();
+    _drawn_vpos = (int)_vscroll->value();
   }
   // Draw scrollbars last
   draw_child(*_vscroll);
@@ -850,6 +897,71 @@ Fl_Tree_Item* Fl_Tree::add(Fl_Tree_Item *parent_item, const char *name) {
   return(parent_item->add(_prefs, name));
 }
 
+/**
+ Adds many items at once, given an array of menu style \p 'paths'.
+ This is equivalent to calling add(const char*, Fl_Tree_Item*) for each
+ path, but faster for large trees: the parents found or created for
+ a path are remembered, so that paths that begin like the previous
+ path don't look them up again. Sorted input, e.g. a list of files
+ from a recursive directory scan, takes most advantage of this.
+ \par
+ \code
+ :
+ const char *paths[] = { "usr/bin/cc", "usr/bin/ls", "usr/lib/libc.so" };
+ tree->add_paths(paths, 3);            // finds "usr" and "usr/bin" only once
+ :
+ \endcode
+ Paths that already exist in the tree are skipped.
+ \param[in] paths The paths of the items, escaped as for add().
+ \param[in] npaths The number of paths.
+ \returns The number of items added for the last element of the paths,
+          not counting the parent items that were created.
+ \version 1.4.0
+*/
+int Fl_Tree::add_paths(const char * const *paths, int npaths) {
+  // Tree has no root? make one
+  if ( ! _root ) {
+    _root = new Fl_Tree_Item(this);
+    _root->parent(0);
+    _root->label("ROOT");
+  }
+  int count = 0;
+  char **last = 0;                      // previous path
+  Fl_Tree_Item **items = 0;             // items[i]: the item of last[0..i]
+  int nitems = 0;                       // allocated size of items[]
+  for ( int i=0; i<npaths; i++ ) {
+    char **arr = parse_path(paths[i]);
+    if ( !arr[0] ) { free_path(arr); continue; }
+    int depth = 0;
+    while ( arr[depth] ) depth++;
+    if ( depth > nitems ) {
+      Fl_Tree_Item **newitems = new Fl_Tree_Item*[depth];
+      if ( items ) { memcpy(newitems, items, nitems * sizeof(Fl_Tree_Item*)); delete[] items; }
+      items = newitems;
+      nitems = depth;
+    }
+    // Skip the parents this path has in common with the previous path
+    int d = 0;
+    if ( last )
+      while ( last[d] && arr[d+1] && strcmp(last[d], arr[d]) == 0 ) d++;
+    Fl_Tree_Item *parent = d ? items[d-1] : _root;
+    // Find or create the remaining parents and the new item
+    for ( ; arr[d]; d++ ) {
+      Fl_Tree_Item *item = parent->find_child_item(arr[d]);
+      if ( !item ) {
+        item = parent->add(_prefs, arr[d]);
+        if ( !arr[d+1] ) count++;
+      }
+      items[d] = parent = item;
+    }
+    free_path(last);
+    last = arr;
+  }
+  free_path(last);
+  delete[] items;
+  return(count);
+}
+
 /**
  Inserts a new item \p 'name' above the specified Fl_Tree_Item \p 'above'.
  Example:
@@ -2383,7 +2495,7 @@ void Fl_Tree::show_item(Fl_Tree_Item *item, int yoff) {
   if ( newval < _vscroll->minimum() ) newval = (int)_vscroll->minimum();
   if ( newval > _vscroll->maximum() ) newval = (int)_vscroll->maximum();
   _vscroll->value(newval);
-  redraw();
+  damage(FL_DAMAGE_SCROLL);
 }
 
 /// Adjust the vertical scrollbar to show \p 'item' at the top
@@ -2456,7 +2568,7 @@ void Fl_Tree::vposition(int pos) {
   if (pos > _vscroll->maximum()) pos = (int)_vscroll->maximum();
   if (pos == _vscroll->value()) return;
   _vscroll->value(pos);
-  redraw();
+  damage(FL_DAMAGE_SCROLL);
 }
 
 /// Returns the horizontal scroll position as a pixel offset.
@@ -2481,7 +2593,7 @@ void Fl_Tree::hposition(int pos) {
   if (pos > _hscroll->maximum()) pos = (int)_hscroll->maximum();
   if (pos == _hscroll->value()) return;
   _hscroll->value(pos);
-  redraw();
+  damage(FL_DAMAGE_SCROLL);
 }
 
 /**
@@ -155,8 +155,10 @@ void Fl_Tree_Item::show_self(const char *indent) const {
 /// Makes and manages an internal copy of \p 'name'.
 ///
 void Fl_Tree_Item::label(const char *name) {
+  if ( _parent ) _parent->_children.index_remove(this); // parent finds children by label
   if ( _label ) { free((void*)_label); _label = 0; }
   _label = name ? fl_strdup(name) : 0;
+  if ( _parent ) _parent->_children.index_add(this);
   recalc_tree();                // may change label geometry
 }
 
@@ -183,28 +185,21 @@ void Fl_Tree_Item::clear_children() {
 /// \version 1.3.0 release
 ///
 int Fl_Tree_Item::find_child(const char *name) {
-  if ( name ) {
-    for ( int t=0; t<children(); t++ )
-      if ( child(t)->label() )
-        if ( strcmp(child(t)->label(), name) == 0 )
-          return(t);
-  }
-  return(-1);
+  Fl_Tree_Item *item = find_child_item(name);
+  return(item ? find_child(item) : -1);
 }
 
 /// Return the /immediate/ child of current item
 /// that has the label \p 'name'.
 ///
+/// Items with many children find them through a hash table of the labels.
+///
 /// \returns const found item, or 0 if not found.
 /// \version 1.3.3
 ///
 const Fl_Tree_Item* Fl_Tree_Item::find_child_item(const char *name) const {
-  if ( name )
-    for ( int t=0; t<children(); t++ )
-      if ( child(t)->label() )
-        if ( strcmp(child(t)->label(), name) == 0 )
-          return(child(t));
-  return(0);
+  // the lookup may build the index, which doesn't change the children
+  return(const_cast<Fl_Tree_Item_Array&>(_children).find(name));
 }
 
 /// Non-const version of Fl_Tree_Item::find_child_item(const char *name) const.
@@ -222,18 +217,10 @@ Fl_Tree_Item* Fl_Tree_Item::find_child_item(const char *name) {
 /// \version 1.3.0 release
 ///
 const Fl_Tree_Item *Fl_Tree_Item::find_child_item(char **arr) const {
-  for ( int t=0; t<children(); t++ ) {
-    if ( child(t)->label() ) {
-      if ( strcmp(child(t)->label(), *arr) == 0 ) {     // match?
-        if ( *(arr+1) ) {                               // more in arr? descend
-          return(_children[t]->find_child_item(arr+1));
-        } else {                                        // end of arr? done
-          return(_children[t]);
-        }
-      }
-    }
-  }
-  return(0);
+  const Fl_Tree_Item *item = find_child_item(*arr);
+  if ( item && *(arr+1) )                       // match and more in arr? descend
+    return(item->find_child_item(arr+1));
+  return(item);
 }
 
 /// Non-const version of Fl_Tree_Item::find_child_item(char **arr) const.
@@ -653,16 +640,11 @@ int Fl_Tree_Item::remove_child(Fl_Tree_Item *item) {
 /// \version 1.3.3
 ///
 int Fl_Tree_Item::remove_child(const char *name) {
-  for ( int t=0; t<children(); t++ ) {
-    if ( child(t)->label() ) {
-      if ( strcmp(child(t)->label(), name) == 0 ) {
-        _children.remove(t);
-        recalc_tree();          // may change tree geometry
-        return(0);
-      }
-    }
-  }
-  return(-1);
+  int t = find_child(name);
+  if ( t == -1 ) return(-1);
+  _children.remove(t);
+  recalc_tree();                // may change tree geometry
+  return(0);
 }
 
 /// Swap two of our children, given two child index values \p 'ax' and \p 'bx'.
@@ -1065,6 +1047,9 @@ void Fl_Tree_Item::draw(int X, int &Y, int W, Fl_Tree_Item *itemfocus,
     }
   }
   char clipped = ((Y+H) < tree_top) || (Y>tree_bot) ? 1 : 0;
+  // Outside of the clip region? (e.g. when only drawing what was scrolled into view)
+  //    Connectors may end one pixel below Y+H2 to align with the dot pattern.
+  if ( !clipped && !fl_not_clipped(tree()->_tix, Y, tree()->_tiw, H2 + 2) ) clipped = 1;
   if (!render) clipped = 0;                     // NOT rendering? Then don't clip, so we calc unclipped items
   char active = (is_active() && tree()->active_r()) ? 1 : 0;
   char drawthis = ( is_root() && prefs.showroot() == 0 ) ? 0 : 1;
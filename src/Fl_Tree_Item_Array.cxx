@@ -36,6 +36,9 @@ Fl_Tree_Item_Array::Fl_Tree_Item_Array(int new_chunksize) {
   _size      = 0;
   _flags     = 0;
   _chunksize = new_chunksize;
+  _index      = 0;
+  _index_size = 0;
+  _index_used = 0;
 }
 
 /// Destructor. Calls each item's destructor, destroys internal _items array.
@@ -50,6 +53,9 @@ Fl_Tree_Item_Array::Fl_Tree_Item_Array(const Fl_Tree_Item_Array* o) {
   _size      = o->_size;
   _chunksize = o->_chunksize;
   _flags     = o->_flags;
+  _index      = 0;                                      // built again when needed
+  _index_size = 0;
+  _index_used = 0;
   for ( int t=0; t<o->_total; t++ ) {
     if ( _flags & MANAGE_ITEM ) {
       _items[t] = new Fl_Tree_Item(o->_items[t]);       // make new copy of item
@@ -79,6 +85,8 @@ void Fl_Tree_Item_Array::clear() {
     free((void*)_items); _items = 0;
   }
   _total = _size = 0;
+  free((void*)_index); _index = 0;
+  _index_size = _index_used = 0;
 }
 
 // Internal: Enlarge the items array.
@@ -123,6 +131,7 @@ void Fl_Tree_Item_Array::insert(int pos, Fl_Tree_Item *new_item) {
   }
   _items[pos] = new_item;
   _total++;
+  if ( _index ) index_add(new_item);
   if ( _flags & MANAGE_ITEM )
   {
     _items[pos]->update_prev_next(pos); // adjust item's prev/next and its neighbors
@@ -146,11 +155,13 @@ void Fl_Tree_Item_Array::add(Fl_Tree_Item *val) {
 ///
 void Fl_Tree_Item_Array::replace(int index, Fl_Tree_Item *newitem) {
   if ( _items[index] ) {                        // delete if non-zero
+    if ( _index ) index_remove(_items[index]);
     if ( _flags & MANAGE_ITEM )
       // Destroy old item
       delete _items[index];
   }
   _items[index] = newitem;                      // install new item
+  if ( _index ) index_add(newitem);
   if ( _flags & MANAGE_ITEM )
   {
     // Restitch into linked list
@@ -164,6 +175,7 @@ void Fl_Tree_Item_Array::replace(int index, Fl_Tree_Item *newitem) {
 ///
 void Fl_Tree_Item_Array::remove(int index) {
   if ( _items[index] ) {                        // delete if non-zero
+    if ( _index ) index_remove(_items[index]);
     if ( _flags & MANAGE_ITEM )
       delete _items[index];
   }
@@ -250,6 +262,7 @@ int Fl_Tree_Item_Array::deparent(int pos) {
   Fl_Tree_Item *item = _items[pos];
   Fl_Tree_Item *prev = item->prev_sibling();
   Fl_Tree_Item *next = item->next_sibling();
+  if ( _index ) index_remove(item);
   // Remove from parent's list of children
   _total -= 1;
   for ( int t=pos; t<_total; t++ )
@@ -275,8 +288,99 @@ int Fl_Tree_Item_Array::reparent(Fl_Tree_Item *item, Fl_Tree_Item* newparent, in
   for ( int t=_total-1; t>pos; --t )    // shuffle array to make room for new entry
     _items[t] = _items[t-1];
   _items[pos] = item;                   // insert new entry
+  if ( _index ) index_add(item);
   // Attach to new parent and siblings
   _items[pos]->parent(newparent);       // reparent (update_prev_next() needs this)
   _items[pos]->update_prev_next(pos);   // find new siblings
   return 0;
 }
+
+// Internal: the child name index.
+//
+//    Children are looked up by label with find() when a path is added
+//    or searched. Once an array holds more than INDEX_MIN_ITEMS items,
+//    find() builds a hash table of the items (open addressing, keyed by
+//    label), which is then kept up to date as items are added, removed,
+//    or relabeled. Removed items leave a REMOVED marker in their slot.
+//
+#define INDEX_MIN_ITEMS 32
+
+static char removed_item;
+#define REMOVED ((Fl_Tree_Item*)&removed_item)
+
+static unsigned int hash_label(const char *s) {
+  unsigned int h = 2166136261U;                 // FNV-1a
+  while ( *s ) { h ^= (unsigned char)*s++; h *= 16777619U; }
+  return h;
+}
+
+// Internal: (Re)build the index for all items with a label.
+void Fl_Tree_Item_Array::index_build() {
+  int size = 64;
+  while ( size < _total * 2 ) size *= 2;        // keep load factor below 1/2
+  free((void*)_index);
+  _index = (Fl_Tree_Item**)calloc(size, sizeof(Fl_Tree_Item*));
+  _index_size = size;
+  _index_used = 0;
+  for ( int t=0; t<_total; t++ ) index_add(_items[t]);
+}
+
+/// Add \p 'item' to the child name index, if the index exists.
+/// Called by the array itself and by Fl_Tree_Item::label() (internal use only).
+///
+void Fl_Tree_Item_Array::index_add(Fl_Tree_Item *item) {
+  if ( !_index || !item->label() ) return;
+  if ( (_index_used+1) * 2 > _index_size ) { index_build(); return; } // includes item
+  unsigned int mask = _index_size - 1;
+  unsigned int h = hash_label(item->label()) & mask;
+  while ( _index[h] && _index[h] != REMOVED ) h = (h+1) & mask;
+  if ( !_index[h] ) _index_used++;
+  _index[h] = item;
+}
+
+/// Remove \p 'item' from the child name index, if the index exists.
+/// Must be called while the item still has the label it was indexed with.
+/// Called by the array itself and by Fl_Tree_Item::label() (internal use only).
+///
+void Fl_Tree_Item_Array::index_remove(Fl_Tree_Item *item) {
+  if ( !_index || !item->label() ) return;
+  unsigned int mask = _index_size - 1;
+  unsigned int h = hash_label(item->label()) & mask;
+  for ( ; _index[h]; h = (h+1) & mask ) {
+    if ( _index[h] == item ) { _index[h] = REMOVED; return; }
+  }
+}
+
+/// Find the first item in the array whose label is \p 'name'.
+///
+///     Large arrays are searched through a hash table of the labels,
+///     which is built on first use and maintained from then on.
+///
+///     \returns the item, or 0 if not found.
+///     \version 1.4.0
+///
+Fl_Tree_Item *Fl_Tree_Item_Array::find(const char *name) {
+  if ( !name ) return 0;
+  if ( !_index ) {
+    if ( _total <= INDEX_MIN_ITEMS ) {          // small array? plain search
+      for ( int t=0; t<_total; t++ )
+        if ( _items[t]->label() && strcmp(_items[t]->label(), name) == 0 )
+          return _items[t];
+      return 0;
+    }
+    index_build();
+  }
+  unsigned int mask = _index_size - 1;
+  Fl_Tree_Item *found = 0;
+  for ( unsigned int h = hash_label(name) & mask; _index[h]; h = (h+1) & mask ) {
+    Fl_Tree_Item *item = _index[h];
+    if ( item == REMOVED || strcmp(item->label(), name) != 0 ) continue;
+    if ( found ) {                              // several items with that label?
+      for ( int t=0; t<_total; t++ )            // return the first one, as the
+        if ( _items[t]->label() && strcmp(_items[t]->label(), name) == 0 )
+          return _items[t];                     // plain search does
+    }
+    found = item;
+  }
+  return found;
+}
@@ -42,6 +42,7 @@ pWindow(win)
   shape_data_ = NULL;
   wait_for_expose_value = 0;
   other_xid = 0;
+  other_copied = 0;
 }
 
 
@@ -187,6 +187,9 @@ int Fl::scheme(const char *s) {
 int Fl::reload_scheme() {
   Fl_Window *win;
 
+  // cached box backgrounds belong to the previous scheme
+  box_cache_flush();
+
   if (scheme_ && !fl_ascii_strcasecmp(scheme_, "plastic")) {
     // Update the tile image to match the background color...
     uchar r, g, b;
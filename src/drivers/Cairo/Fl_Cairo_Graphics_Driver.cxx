@@ -23,11 +23,18 @@
 
 #include "Fl_Cairo_Graphics_Driver.H"
 #include <FL/fl_draw.H>
+#include <FL/fl_utf8.h>
+#include <FL/Fl.H>
+#include <FL/Fl_Image.H>
 #include <cairo/cairo.h>
 #include <pango/pangocairo.h>
 #include <math.h>
 #include <stdlib.h>  // abs(int)
 #include <string.h>  // memcpy()
+#if HAVE_PTHREAD
+#  include <pthread.h>
+#  include <unistd.h>  // sysconf()
+#endif
 
 // duplicated from Fl_PostScript.cxx
 struct callback_data {
@@ -663,4 +670,215 @@ void Fl_Cairo_Graphics_Driver::draw_rgb_bitmap_(Fl_Image *img,int XP, int YP, in
   }
 }
 
+
+//
+// Tiled drawing into an image by several threads, see fl_cairo_tiled_image()
+//
+
+#if HAVE_PTHREAD
+// serializes the calls to Fl::get_font_name() by the drawing threads
+static pthread_mutex_t tile_font_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+// Returns a new description of face f, without size
+static PangoFontDescription *tile_face_description(Fl_Font f) {
+#if HAVE_PTHREAD
+  pthread_mutex_lock(&tile_font_lock);
+#endif
+  PangoFontDescription *desc = pango_font_description_from_string(Fl::get_font_name(f));
+#if HAVE_PTHREAD
+  pthread_mutex_unlock(&tile_font_lock);
+#endif
+  return desc;
+}
+
+/* Draws one tile of an image made by fl_cairo_tiled_image().
+ Unlike the PostScript driver, it measures text with its own Pango layout
+ rather than with the display driver, so that several tiles can be drawn
+ at the same time by different threads. */
+class Fl_Cairo_Tile_Graphics_Driver : public Fl_Cairo_Graphics_Driver {
+  PangoFontDescription **faces_; // faces used by this tile, by Fl_Font
+  int nfaces_;
+  PangoFontDescription *desc_;   // the current face at the current size
+  int height_, descent_;
+public:
+  Fl_Cairo_Tile_Graphics_Driver(cairo_t *cr);
+  ~Fl_Cairo_Tile_Graphics_Driver();
+  void font(Fl_Font f, Fl_Fontsize s);
+  Fl_Font font() { return Fl_Graphics_Driver::font(); }
+  double width(const char *str, int n);
+  double width(unsigned int c);
+  int height() { return height_; }
+  int descent() { return descent_; }
+  void point(int x, int y) { rectf(x, y, 1, 1); }
+  PangoFontDescription *pango_font_description(Fl_Font) { return desc_; }
+};
+
+Fl_Cairo_Tile_Graphics_Driver::Fl_Cairo_Tile_Graphics_Driver(cairo_t *cr) {
+  cairo_ = cr;
+  pango_layout_ = pango_cairo_create_layout(cr); // uses the font map of this thread
+  faces_ = NULL;
+  nfaces_ = 0;
+  desc_ = NULL;
+  height_ = descent_ = 0;
+}
+
+Fl_Cairo_Tile_Graphics_Driver::~Fl_Cairo_Tile_Graphics_Driver() {
+  while (clip_) pop_clip();
+  for (int i = 0; i < nfaces_; i++) {
+    if (faces_[i]) pango_font_description_free(faces_[i]);
+  }
+  free(faces_);
+  if (desc_) pango_font_description_free(desc_);
+  g_object_unref(pango_layout_);
+}
+
+void Fl_Cairo_Tile_Graphics_Driver::font(Fl_Font f, Fl_Fontsize s) {
+  if (f < 0 || s <= 0 || (desc_ && f == font_ && s == size_)) return;
+  Fl_Graphics_Driver::font(f, s);
+  if (f >= nfaces_) {
+    int n = f + 16;
+    faces_ = (PangoFontDescription**)realloc(faces_, n * sizeof(PangoFontDescription*));
+    memset(faces_ + nfaces_, 0, (n - nfaces_) * sizeof(PangoFontDescription*));
+    nfaces_ = n;
+  }
+  if (!faces_[f]) faces_[f] = tile_face_description(f);
+  if (desc_) pango_font_description_free(desc_);
+  desc_ = pango_font_description_copy(faces_[f]);
+  pango_font_description_set_absolute_size(desc_, s * PANGO_SCALE);
+  pango_layout_set_font_description(pango_layout_, desc_);
+  // same metrics as Fl_Xlib_Graphics_Driver::font_unscaled()
+  height_ = descent_ = 0;
+  PangoFont *pfont = pango_context_load_font(pango_layout_get_context(pango_layout_), desc_);
+  if (pfont) {
+    PangoRectangle logical_rect;
+    pango_font_get_glyph_extents(pfont, /*PangoGlyph glyph*/'p', NULL, &logical_rect);
+    descent_ = PANGO_DESCENT(logical_rect)/PANGO_SCALE;
+    height_ = logical_rect.height/PANGO_SCALE;
+    g_object_unref(pfont);
+  }
+}
+
+double Fl_Cairo_Tile_Graphics_Driver::width(const char *str, int n) {
+  if (!desc_ || n <= 0) return 0;
+  int w, h;
+  pango_layout_set_font_description(pango_layout_, desc_);
+  pango_layout_set_text(pango_layout_, str, n);
+  pango_layout_get_size(pango_layout_, &w, &h);
+  return double(w) / PANGO_SCALE;
+}
+
+double Fl_Cairo_Tile_Graphics_Driver::width(unsigned int c) {
+  char buf[4];
+  int n = fl_utf8encode(c, buf);
+  return width(buf, n);
+}
+
+// the work shared by the threads of fl_cairo_tiled_image()
+struct Fl_Cairo_Tiles {
+  int W, H, size, columns, count;
+  int next;                      // index of the next tile to draw
+  uchar *rgb;                    // W * H * 3 bytes
+  void (*draw)(Fl_Graphics_Driver*, void*);
+  void *data;
+#if HAVE_PTHREAD
+  pthread_mutex_t lock;
+#endif
+};
+
+static int next_tile(Fl_Cairo_Tiles *t) {
+#if HAVE_PTHREAD
+  pthread_mutex_lock(&t->lock);
+#endif
+  int i = (t->next < t->count ? t->next++ : -1);
+#if HAVE_PTHREAD
+  pthread_mutex_unlock(&t->lock);
+#endif
+  return i;
+}
+
+// Draws tile i with its own surface and driver, and copies it to its place in t->rgb
+static void draw_tile(Fl_Cairo_Tiles *t, int i) {
+  int X = (i % t->columns) * t->size, Y = (i / t->columns) * t->size;
+  int w = t->W - X, h = t->H - Y;
+  if (w > t->size) w = t->size;
+  if (h > t->size) h = t->size;
+  cairo_surface_t *surf = cairo_image_surface_create(CAIRO_FORMAT_RGB24, w, h);
+  cairo_t *cr = cairo_create(surf);
+  cairo_set_source_rgb(cr, 1, 1, 1);
+  cairo_paint(cr);
+  cairo_set_source_rgb(cr, 0, 0, 0);
+  cairo_set_line_width(cr, 1);
+  // FLTK coordinates are those of pixel centers
+  cairo_translate(cr, 0.5 - X, 0.5 - Y);
+  {
+    Fl_Cairo_Tile_Graphics_Driver driver(cr);
+    t->draw(&driver, t->data);
+  }
+  cairo_destroy(cr);
+  cairo_surface_flush(surf);
+  const uchar *src = cairo_image_surface_get_data(surf);
+  int stride = cairo_image_surface_get_stride(surf);
+  for (int y = 0; y < h; y++) {
+    const unsigned *p = (const unsigned*)(src + y * stride);
+    uchar *q = t->rgb + ((size_t)(Y + y) * t->W + X) * 3;
+    for (int x = 0; x < w; x++, q += 3) {
+      unsigned v = p[x];
+      q[0] = uchar(v >> 16); q[1] = uchar(v >> 8); q[2] = uchar(v);
+    }
+  }
+  cairo_surface_destroy(surf);
+}
+
+static void *draw_tiles(void *data) {
+  Fl_Cairo_Tiles *t = (Fl_Cairo_Tiles*)data;
+  int i;
+  while ((i = next_tile(t)) >= 0) draw_tile(t, i);
+  return NULL;
+}
+
+/* Draws a W x H image with a white background in square tiles of tile_size
+ pixels, using up to \p threads threads (one per processor if 0).
+ Function draw() is called once per tile with a driver drawing to that tile;
+ it may run in several threads at once, and must only read shared data.
+ Each tile is drawn by a new driver whatever the thread, so that the image
+ doesn't depend on the number of threads. The calling thread draws tiles
+ too and returns when all are done.
+ Used by Fl_Recording_Surface::image().
+ */
+Fl_RGB_Image *fl_cairo_tiled_image(int W, int H, int tile_size, int threads,
+                                   void (*draw)(Fl_Graphics_Driver*, void*), void *data) {
+  if (W <= 0 || H <= 0) return NULL;
+  Fl_Cairo_Tiles t;
+  t.W = W;
+  t.H = H;
+  t.size = (tile_size > 0 ? tile_size : 256);
+  t.columns = (W + t.size - 1) / t.size;
+  t.count = t.columns * ((H + t.size - 1) / t.size);
+  t.next = 0;
+  t.rgb = new uchar[(size_t)W * H * 3];
+  t.draw = draw;
+  t.data = data;
+#if HAVE_PTHREAD
+  if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads > t.count) threads = t.count;
+  pthread_mutex_init(&t.lock, NULL);
+  pthread_t *ids = (threads > 1 ? new pthread_t[threads - 1] : NULL);
+  int started = 0;
+  for (int i = 1; i < threads; i++) {
+    if (pthread_create(&ids[started], NULL, draw_tiles, &t) == 0) started++;
+  }
+  draw_tiles(&t);
+  for (int i = 0; i < started; i++) pthread_join(ids[i], NULL);
+  delete[] ids;
+  pthread_mutex_destroy(&t.lock);
+#else
+  (void)threads;
+  draw_tiles(&t);
+#endif
+  Fl_RGB_Image *img = new Fl_RGB_Image(t.rgb, W, H, 3);
+  img->alloc_array = 1;
+  return img;
+}
+
 #endif // USE_PANGO
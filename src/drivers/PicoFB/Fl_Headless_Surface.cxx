@@ -0,0 +1,278 @@
+//
+// Implementation of class Fl_Headless_Surface in the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2021 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <FL/Fl_Headless_Surface.H>
+#include <FL/Fl.H>
+#include <FL/Fl_Window.H>
+#include <FL/Fl_Tooltip.H>
+#include <FL/Fl_RGB_Image.H>
+#include <FL/Fl_PNG_Image.H>
+#include "Fl_PicoFB_Graphics_Driver.H"
+#include "../../flstring.h"
+#include <stdlib.h>
+
+/**
+ Constructor of the headless drawing surface.
+ The surface is cleared to white.
+ \param w,h Width and height of the surface in pixels
+ */
+Fl_Headless_Surface::Fl_Headless_Surface(int w, int h) :
+  Fl_Widget_Surface(new Fl_PicoFB_Graphics_Driver(w, h))
+{
+  Fl_PicoFB_Graphics_Driver *driver = (Fl_PicoFB_Graphics_Driver*)this->driver();
+  width_ = driver->w();
+  height_ = driver->h();
+  driver->translate_all(0, 0); // the origin, see origin(int, int)
+}
+
+/**
+ Destructor.
+ */
+Fl_Headless_Surface::~Fl_Headless_Surface() {
+  delete driver();
+}
+
+void Fl_Headless_Surface::translate(int x, int y) {
+  ((Fl_PicoFB_Graphics_Driver*)driver())->translate_all(x, y);
+}
+
+void Fl_Headless_Surface::untranslate() {
+  ((Fl_PicoFB_Graphics_Driver*)driver())->untranslate_all();
+}
+
+void Fl_Headless_Surface::origin(int x, int y) {
+  Fl_PicoFB_Graphics_Driver *driver = (Fl_PicoFB_Graphics_Driver*)this->driver();
+  driver->untranslate_all();
+  driver->translate_all(x, y);
+  Fl_Widget_Surface::origin(x, y);
+}
+
+void Fl_Headless_Surface::origin(int *x, int *y) {
+  Fl_Widget_Surface::origin(x, y);
+}
+
+int Fl_Headless_Surface::printable_rect(int *w, int *h) {
+  *w = width_;
+  *h = height_;
+  return 0;
+}
+
+// Fl_Widget::damage() ignores windows that are not shown, so the damage
+// bits of the window and of its subwindows are set directly.
+static void set_damage(Fl_Widget *widget, uchar c) {
+  if (widget->as_window()) widget->clear_damage(c);
+  Fl_Group *g = widget->as_group();
+  if (!g) return;
+  for (int i = 0; i < g->children(); i++) set_damage(g->child(i), c);
+}
+
+/**
+ Draws a window and all its subwindows at the origin of the surface.
+ The window must not be shown on the display. It is marked visible
+ for FLTK, and drawn completely whatever its damage() state.
+ */
+void Fl_Headless_Surface::draw_window(Fl_Window *win) {
+  if (!win->visible()) win->set_visible();
+  set_damage(win, FL_DAMAGE_ALL);
+  draw(win);
+  set_damage(win, 0);
+}
+
+const uchar *Fl_Headless_Surface::buffer() {
+  return ((Fl_PicoFB_Graphics_Driver*)driver())->buffer();
+}
+
+/**
+ Returns a copy of the surface content.
+ The caller is responsible for deleting the returned image.
+ */
+Fl_RGB_Image *Fl_Headless_Surface::image() {
+  uchar *data = new uchar[width_ * height_ * 3];
+  memcpy(data, buffer(), width_ * height_ * 3);
+  Fl_RGB_Image *img = new Fl_RGB_Image(data, width_, height_, 3);
+  img->alloc_array = 1;
+  return img;
+}
+
+/**
+ Writes the surface content to a PNG file.
+ \return 0 on success, see fl_write_png() for error codes
+ */
+int Fl_Headless_Surface::write_png(const char *filename) {
+  return fl_write_png(filename, buffer(), width_, height_, 3);
+}
+
+/**
+ Assigns a TrueType font file to a font face.
+ Text drawn in this face by any Fl_Headless_Surface uses the glyphs
+ of the file instead of the built-in vector font.
+ \return 0 on success, -1 if the file can't be read or isn't a TrueType font
+ */
+int Fl_Headless_Surface::font_file(Fl_Font face, const char *ttf_file) {
+  return Fl_PicoFB_Graphics_Driver::font_file(face, ttf_file);
+}
+
+
+// ---- event injection ------------------------------------------------------
+
+// Same as send_event() in Fl.cxx: coordinates are made relative to the
+// window that contains the target widget.
+static int send_event(int event, Fl_Widget *to, Fl_Window *window) {
+  int dx = window ? window->x() : 0, dy = window ? window->y() : 0;
+  for (const Fl_Widget *w = to; w; w = w->parent()) {
+    if (w->type() >= FL_WINDOW) {
+      dx -= w->x();
+      dy -= w->y();
+    }
+  }
+  int old_event = Fl::e_number;
+  int save_x = Fl::e_x; Fl::e_x += dx;
+  int save_y = Fl::e_y; Fl::e_y += dy;
+  int ret = to->handle(Fl::e_number = event);
+  Fl::e_number = old_event;
+  Fl::e_y = save_y;
+  Fl::e_x = save_x;
+  return ret;
+}
+
+/**
+ Sends an event to a window drawn by an Fl_Headless_Surface.
+ The event is dispatched as Fl::handle() does, using the current event
+ state (Fl::event_x(), Fl::event_key() ...). Those events of Fl::handle()
+ that would ask the window system for something are handled without it:
+ an FL_PUSH nobody uses doesn't raise the window, and FL_KEYBOARD
+ and FL_SHORTCUT events only search \p win for a shortcut.
+ \return non-zero if a widget used the event
+ */
+int Fl_Headless_Surface::handle(Fl_Window *win, int event) {
+  Fl_Widget *wi;
+  switch (event) {
+    case FL_PUSH:
+    case FL_KEYBOARD:
+      // give the window the keyboard focus without asking the window system
+      if (!Fl::grab() && !win->contains(Fl::focus())) Fl::handle_(FL_FOCUS, win);
+      break;
+    default:
+      break;
+  }
+  switch (event) {
+    case FL_PUSH:
+      Fl::e_number = event;
+      wi = win;
+      if (Fl::grab()) wi = Fl::grab();
+      else if (Fl::modal() && wi != Fl::modal()) return 0;
+      Fl::pushed(wi);
+      Fl_Tooltip::current(wi);
+      return send_event(FL_PUSH, wi, win);
+
+    case FL_KEYBOARD:
+      Fl::e_number = event;
+      Fl_Tooltip::enter((Fl_Widget*)0);
+      for (wi = Fl::grab() ? Fl::grab() : Fl::focus(); wi; wi = wi->parent()) {
+        if (send_event(FL_KEYBOARD, wi, win)) return 1;
+      }
+      // FALLTHROUGH
+
+    case FL_SHORTCUT:
+      Fl::e_number = event = FL_SHORTCUT;
+      if (Fl::grab()) return send_event(FL_SHORTCUT, Fl::grab(), win);
+      wi = Fl::belowmouse();
+      if (!wi || !win->contains(wi)) wi = Fl::modal() ? Fl::modal() : win;
+      for (; wi; wi = wi->parent()) {
+        if (send_event(FL_SHORTCUT, wi, win)) return 1;
+      }
+      if (Fl::event_key() == FL_Escape) { // make Escape key close windows
+        wi = Fl::modal() ? Fl::modal() : win;
+        wi->do_callback();
+        return 1;
+      }
+      return 0;
+
+    default:
+      return Fl::handle_(event, win);
+  }
+}
+
+/**
+ Sends a mouse event to a window drawn by an Fl_Headless_Surface.
+ Sets the event state as the window system would, including
+ Fl::event_clicks() for repeated clicks, and calls handle().
+ \param win the window
+ \param event FL_PUSH, FL_RELEASE, FL_DRAG, FL_MOVE, FL_MOUSEWHEEL ...
+ \param x,y mouse position relative to \p win
+ \param button FL_LEFT_MOUSE, FL_MIDDLE_MOUSE or FL_RIGHT_MOUSE for
+   FL_PUSH and FL_RELEASE; the vertical scroll amount (Fl::event_dy())
+   for FL_MOUSEWHEEL; unused otherwise
+ \return non-zero if a widget used the event
+ */
+int Fl_Headless_Surface::mouse_event(Fl_Window *win, int event, int x, int y, int button) {
+  static int px, py; // position of the last FL_PUSH
+  Fl::e_x = x;
+  Fl::e_y = y;
+  Fl::e_x_root = win->x() + x;
+  Fl::e_y_root = win->y() + y;
+  switch (event) {
+    case FL_PUSH:
+      Fl::e_keysym = FL_Button + button;
+      Fl::e_state |= FL_BUTTON(button);
+      if (Fl::e_is_click == Fl::e_keysym) Fl::e_clicks++;
+      else { Fl::e_clicks = 0; Fl::e_is_click = Fl::e_keysym; }
+      px = x; py = y;
+      break;
+    case FL_RELEASE:
+      Fl::e_keysym = FL_Button + button;
+      Fl::e_state &= ~FL_BUTTON(button);
+      break;
+    case FL_MOUSEWHEEL:
+      Fl::e_dx = 0;
+      Fl::e_dy = button;
+      break;
+    default:
+      if (abs(x - px) > 5 || abs(y - py) > 5) Fl::e_is_click = 0;
+      break;
+  }
+  return handle(win, event);
+}
+
+/**
+ Sends a key stroke to a window drawn by an Fl_Headless_Surface.
+ An FL_KEYBOARD event is followed by an FL_KEYUP event.
+ \param win the window
+ \param key the key code, e.g. 'a', FL_Enter, FL_Left
+ \param text the UTF-8 text of the key stroke; if NULL, the text is
+   the character \p key for printable ASCII keys and empty otherwise
+ \param state the state of the modifier keys, e.g. FL_SHIFT|FL_CTRL
+ \return non-zero if a widget used the FL_KEYBOARD event
+ */
+int Fl_Headless_Surface::key_event(Fl_Window *win, int key, const char *text, int state) {
+  static char buffer[32];
+  if (text) {
+    strlcpy(buffer, text, sizeof(buffer));
+  } else if (key >= ' ' && key < 0x7f) {
+    buffer[0] = (char)key;
+    buffer[1] = 0;
+  } else {
+    buffer[0] = 0;
+  }
+  Fl::e_keysym = Fl::e_original_keysym = key;
+  Fl::e_state = (Fl::e_state & FL_BUTTONS) | state;
+  Fl::e_text = buffer;
+  Fl::e_length = (int)strlen(buffer);
+  Fl::e_is_click = 0;
+  int ret = handle(win, FL_KEYBOARD);
+  handle(win, FL_KEYUP);
+  return ret;
+}
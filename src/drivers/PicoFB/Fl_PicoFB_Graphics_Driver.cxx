@@ -0,0 +1,928 @@
+//
+// Framebuffer graphics driver for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2010-2021 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <config.h>
+#include "Fl_PicoFB_Graphics_Driver.H"
+#include <FL/Fl.H>
+#include <FL/fl_draw.H>
+#include <FL/fl_utf8.h>
+#include <FL/math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+// stb_truetype is shared with the Android driver. Make all its functions
+// static so that both drivers can be linked into the same library, and
+// don't warn about the ones this driver doesn't use.
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-function"
+#endif
+
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ > 5))
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-function"
+#endif
+
+#include "../Android/stb_truetype.h"
+
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ > 5))
+#pragma GCC diagnostic pop
+#endif
+
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif
+
+
+// ---- TrueType fonts -------------------------------------------------------
+
+/* A font face that was assigned a TrueType file with font_file() */
+struct Fl_PicoFB_Font {
+  uchar *data;
+  stbtt_fontinfo info;
+};
+
+static Fl_PicoFB_Font **ttf_fonts = 0;
+static int ttf_fonts_size = 0;
+
+static Fl_PicoFB_Font *ttf_font(int face) {
+  if (face < 0 || face >= ttf_fonts_size) return 0;
+  return ttf_fonts[face];
+}
+
+/* A small direct-mapped cache of rasterized glyphs, shared by all drivers */
+struct Fl_PicoFB_Glyph {
+  int face, size;             // size is 0 for an unused entry
+  unsigned ucs;
+  int w, h, xoff, yoff;
+  uchar *bitmap;              // NULL for glyphs without pixels, e.g. spaces
+};
+
+#define FL_PICOFB_GLYPH_CACHE 512
+static Fl_PicoFB_Glyph glyph_cache[FL_PICOFB_GLYPH_CACHE];
+
+static Fl_PicoFB_Glyph *glyph(int face, int size, unsigned ucs) {
+  Fl_PicoFB_Glyph *g = glyph_cache + ((ucs * 31 + size * 7 + face) % FL_PICOFB_GLYPH_CACHE);
+  if (g->size && g->face == face && g->size == size && g->ucs == ucs) return g;
+  Fl_PicoFB_Font *f = ttf_font(face);
+  if (g->bitmap) stbtt_FreeBitmap(g->bitmap, 0);
+  float scale = stbtt_ScaleForPixelHeight(&f->info, (float)size);
+  g->bitmap = stbtt_GetCodepointBitmap(&f->info, 0, scale, ucs, &g->w, &g->h, &g->xoff, &g->yoff);
+  g->face = face;
+  g->size = size;
+  g->ucs = ucs;
+  if (!g->bitmap) g->w = g->h = 0;
+  return g;
+}
+
+static void flush_glyph_cache(int face) {
+  for (int i = 0; i < FL_PICOFB_GLYPH_CACHE; i++) {
+    Fl_PicoFB_Glyph *g = glyph_cache + i;
+    if (g->size && g->face == face) {
+      if (g->bitmap) stbtt_FreeBitmap(g->bitmap, 0);
+      g->bitmap = 0;
+      g->size = 0;
+    }
+  }
+}
+
+/**
+ Assigns a TrueType font file to a font face.
+
+ All Fl_PicoFB_Graphics_Driver objects then render text in this face with
+ the given font. Without a font file, text is drawn with the built-in
+ vector font of the Pico driver.
+ \param face the FLTK font face, e.g. FL_HELVETICA
+ \param ttf_file path to a .ttf file, or NULL to remove the assignment
+ \return 0 on success, -1 if the file could not be read or is not a TrueType font
+ */
+int Fl_PicoFB_Graphics_Driver::font_file(Fl_Font face, const char *ttf_file) {
+  if (face < 0) return -1;
+  if (face >= ttf_fonts_size) {
+    int size = face + 16;
+    ttf_fonts = (Fl_PicoFB_Font**)realloc(ttf_fonts, size * sizeof(Fl_PicoFB_Font*));
+    memset(ttf_fonts + ttf_fonts_size, 0, (size - ttf_fonts_size) * sizeof(Fl_PicoFB_Font*));
+    ttf_fonts_size = size;
+  }
+  if (ttf_fonts[face]) {
+    flush_glyph_cache(face);
+    free(ttf_fonts[face]->data);
+    delete ttf_fonts[face];
+    ttf_fonts[face] = 0;
+  }
+  if (!ttf_file) return 0;
+  FILE *f = fl_fopen(ttf_file, "rb");
+  if (!f) return -1;
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  uchar *data = (uchar*)malloc(size > 0 ? size : 1);
+  if (size <= 0 || fread(data, 1, size, f) != (size_t)size) {
+    free(data);
+    fclose(f);
+    return -1;
+  }
+  fclose(f);
+  Fl_PicoFB_Font *font = new Fl_PicoFB_Font;
+  font->data = data;
+  int offset = stbtt_GetFontOffsetForIndex(data, 0);
+  if (offset < 0 || !stbtt_InitFont(&font->info, data, offset)) {
+    free(data);
+    delete font;
+    return -1;
+  }
+  ttf_fonts[face] = font;
+  return 0;
+}
+
+
+// ---- construction ---------------------------------------------------------
+
+/**
+ Creates a framebuffer graphics driver.
+ \param w,h size of the framebuffer in pixels
+ \param buffer RGB pixel data of at least \p h lines of \p ld bytes, or NULL
+   to have the driver allocate (and later free) a buffer cleared to white
+ \param ld number of bytes per line of \p buffer, or 0 for w*3
+ */
+Fl_PicoFB_Graphics_Driver::Fl_PicoFB_Graphics_Driver(int w, int h, uchar *buffer, int ld)
+{
+  width_ = w > 0 ? w : 1;
+  height_ = h > 0 ? h : 1;
+  ld_ = ld ? ld : width_ * 3;
+  own_buffer_ = (buffer == 0);
+  if (own_buffer_) {
+    data_ = new uchar[ld_ * height_];
+    memset(data_, 0xff, ld_ * height_);
+  } else {
+    data_ = buffer;
+  }
+  buffer_ = data_;
+  offset_x_ = offset_y_ = 0;
+  depth_ = 0;
+  red_ = green_ = blue_ = 0;
+  color_ = FL_BLACK;
+  line_width_ = 0;
+  antialias_ = 1;
+  clip_sp_ = 0;
+  clip_[0].x = clip_[0].y = 0;
+  clip_[0].r = width_;
+  clip_[0].b = height_;
+  subpath_ = 0;
+  subpath_n_ = subpath_size_ = 0;
+  xs_ = 0;
+  xs_size_ = 0;
+  p_size = 0;
+  p = 0;
+}
+
+
+Fl_PicoFB_Graphics_Driver::~Fl_PicoFB_Graphics_Driver()
+{
+  if (own_buffer_) delete[] data_;
+  free(subpath_);
+  free(xs_);
+  if (p) free(p);
+}
+
+
+/**
+ Reversibly moves the origin of graphics by dx, dy pixels.
+ Clip rectangles already on the stack keep their position in the framebuffer.
+ */
+void Fl_PicoFB_Graphics_Driver::translate_all(int dx, int dy)
+{
+  if (depth_ < FL_PICOFB_TRANSLATION_STACK_SIZE) {
+    stack_x_[depth_] = offset_x_;
+    stack_y_[depth_] = offset_y_;
+    depth_++;
+  } else {
+    Fl::warning("%s: translate stack overflow!", "Fl_PicoFB_Graphics_Driver");
+  }
+  set_offset(offset_x_ + dx, offset_y_ + dy);
+}
+
+
+/** Undoes the previous translate_all(). */
+void Fl_PicoFB_Graphics_Driver::untranslate_all()
+{
+  if (depth_ > 0) depth_--;
+  set_offset(stack_x_[depth_], stack_y_[depth_]);
+}
+
+
+// The pixel address and all clip rectangles are kept relative to the
+// current origin, so that the drawing code never adds the offset itself.
+void Fl_PicoFB_Graphics_Driver::set_offset(int x, int y)
+{
+  int dx = x - offset_x_, dy = y - offset_y_;
+  for (int i = 0; i <= clip_sp_; i++) {
+    clip_[i].x -= dx; clip_[i].r -= dx;
+    clip_[i].y -= dy; clip_[i].b -= dy;
+  }
+  offset_x_ = x;
+  offset_y_ = y;
+  buffer_ = data_ + y * ld_ + x * 3;
+}
+
+
+// ---- pixels and spans -----------------------------------------------------
+
+// Blends the current color into pixel x, y with coverage a (0...255).
+// The caller must have checked that the pixel is inside the clip rectangle.
+inline void Fl_PicoFB_Graphics_Driver::blend(int x, int y, int a)
+{
+  uchar *d = buffer_ + y * ld_ + x * 3;
+  if (a >= 255) {
+    d[0] = red_; d[1] = green_; d[2] = blue_;
+  } else if (a > 0) {
+    d[0] = (uchar)(d[0] + ((red_   - d[0]) * a + 127) / 255);
+    d[1] = (uchar)(d[1] + ((green_ - d[1]) * a + 127) / 255);
+    d[2] = (uchar)(d[2] + ((blue_  - d[2]) * a + 127) / 255);
+  }
+}
+
+
+// Fills pixels x...x1 (inclusive) of line y with the current color.
+void Fl_PicoFB_Graphics_Driver::fill_span(int x, int x1, int y)
+{
+  Clip_Rect &c = clip();
+  if (y < c.y || y >= c.b) return;
+  if (x1 < x) { int t = x; x = x1; x1 = t; }
+  if (x < c.x) x = c.x;
+  if (x1 >= c.r) x1 = c.r - 1;
+  if (x1 < x) return;
+  uchar *d = buffer_ + y * ld_ + x * 3;
+  int n = x1 - x + 1;
+  if (red_ == green_ && green_ == blue_) {
+    memset(d, red_, n * 3);
+  } else {
+    for (; n > 0; n--, d += 3) { d[0] = red_; d[1] = green_; d[2] = blue_; }
+  }
+}
+
+
+void Fl_PicoFB_Graphics_Driver::point(int x, int y)
+{
+  Clip_Rect &c = clip();
+  if (x >= c.x && x < c.r && y >= c.y && y < c.b) blend(x, y, 255);
+}
+
+
+void Fl_PicoFB_Graphics_Driver::rectf(int x, int y, int w, int h)
+{
+  Clip_Rect &c = clip();
+  int r = x + w, b = y + h;
+  if (x < c.x) x = c.x;
+  if (y < c.y) y = c.y;
+  if (r > c.r) r = c.r;
+  if (b > c.b) b = c.b;
+  if (r <= x || b <= y) return;
+  // fill the first line, then copy it to all other lines
+  fill_span(x, r - 1, y);
+  uchar *first = buffer_ + y * ld_ + x * 3;
+  for (int i = y + 1; i < b; i++)
+    memcpy(buffer_ + i * ld_ + x * 3, first, (r - x) * 3);
+}
+
+
+void Fl_PicoFB_Graphics_Driver::colored_rectf(int x, int y, int w, int h, uchar r, uchar g, uchar b)
+{
+  Fl_Color save = color_;
+  color(r, g, b);
+  rectf(x, y, w, h);
+  color(save);
+}
+
+
+void Fl_PicoFB_Graphics_Driver::xyline(int x, int y, int x1)
+{
+  if (line_width_ > 1) {
+    if (x1 < x) { int t = x; x = x1; x1 = t; }
+    rectf(x, y - line_width_ / 2, x1 - x + 1, line_width_);
+  } else {
+    fill_span(x, x1, y);
+  }
+}
+
+
+void Fl_PicoFB_Graphics_Driver::yxline(int x, int y, int y1)
+{
+  if (y1 < y) { int t = y; y = y1; y1 = t; }
+  if (line_width_ > 1) {
+    rectf(x - line_width_ / 2, y, line_width_, y1 - y + 1);
+    return;
+  }
+  Clip_Rect &c = clip();
+  if (x < c.x || x >= c.r) return;
+  if (y < c.y) y = c.y;
+  if (y1 >= c.b) y1 = c.b - 1;
+  for (; y <= y1; y++) blend(x, y, 255);
+}
+
+
+// ---- lines ----------------------------------------------------------------
+
+// Draws a one pixel wide line between two pixel centers, anti-aliased
+// with Xiaolin Wu's algorithm if antialiasing is on, else with Bresenham's.
+void Fl_PicoFB_Graphics_Driver::thin_line(float x0, float y0, float x1, float y1)
+{
+  Clip_Rect &c = clip();
+  int steep = fabs(y1 - y0) > fabs(x1 - x0);
+  float t;
+  if (steep) {
+    t = x0; x0 = y0; y0 = t;
+    t = x1; x1 = y1; y1 = t;
+  }
+  if (x0 > x1) {
+    t = x0; x0 = x1; x1 = t;
+    t = y0; y0 = y1; y1 = t;
+  }
+  float dx = x1 - x0;
+  float gradient = (dx == 0) ? 0 : (y1 - y0) / dx;
+  int xs = (int)floorf(x0 + 0.5f), xe = (int)floorf(x1 + 0.5f);
+  float y = y0 + gradient * (xs - x0);
+  for (int x = xs; x <= xe; x++, y += gradient) {
+    int px, py;
+    if (!antialias_) {
+      int yi = (int)floorf(y + 0.5f);
+      if (steep) { px = yi; py = x; } else { px = x; py = yi; }
+      if (px >= c.x && px < c.r && py >= c.y && py < c.b) blend(px, py, 255);
+      continue;
+    }
+    int yi = (int)floorf(y);
+    int a = (int)((y - yi) * 255 + 0.5f);
+    for (int k = 0; k < 2; k++) {
+      int cov = k ? a : 255 - a;
+      if (steep) { px = yi + k; py = x; } else { px = x; py = yi + k; }
+      if (px >= c.x && px < c.r && py >= c.y && py < c.b) blend(px, py, cov);
+    }
+  }
+}
+
+
+// Draws a line of the current line width as a filled rectangle.
+void Fl_PicoFB_Graphics_Driver::thick_line(float x0, float y0, float x1, float y1)
+{
+  float dx = x1 - x0, dy = y1 - y0;
+  float len = sqrtf(dx * dx + dy * dy);
+  if (len == 0) return;
+  float nx = -dy / len * line_width_ / 2, ny = dx / len * line_width_ / 2;
+  XPOINT q[4];
+  // pixel centers are at .5 in the continuous coordinates used for filling
+  q[0].x = x0 + nx + 0.5f; q[0].y = y0 + ny + 0.5f;
+  q[1].x = x1 + nx + 0.5f; q[1].y = y1 + ny + 0.5f;
+  q[2].x = x1 - nx + 0.5f; q[2].y = y1 - ny + 0.5f;
+  q[3].x = x0 - nx + 0.5f; q[3].y = y0 - ny + 0.5f;
+  int start = 0;
+  fill_polygon(q, 4, &start, 1);
+}
+
+
+void Fl_PicoFB_Graphics_Driver::line(int x, int y, int x1, int y1)
+{
+  if (y == y1) xyline(x, y, x1);
+  else if (x == x1) yxline(x, y, y1);
+  else if (line_width_ > 1) thick_line((float)x, (float)y, (float)x1, (float)y1);
+  else thin_line((float)x, (float)y, (float)x1, (float)y1);
+}
+
+
+void Fl_PicoFB_Graphics_Driver::draw_lines(const XPOINT *pts, int npts)
+{
+  for (int i = 1; i < npts; i++) {
+    if (line_width_ > 1) thick_line(pts[i-1].x, pts[i-1].y, pts[i].x, pts[i].y);
+    else thin_line(pts[i-1].x, pts[i-1].y, pts[i].x, pts[i].y);
+  }
+}
+
+
+void Fl_PicoFB_Graphics_Driver::line_style(int style, int width, char *dashes)
+{
+  // dashes and cap/join styles are not supported, only the width
+  line_width_ = width;
+}
+
+
+// ---- polygons -------------------------------------------------------------
+
+// Fills a polygon made of one or more closed sub-paths using the even-odd
+// rule. A pixel is filled when its center is inside the polygon.
+// starts[] holds the index of the first point of each sub-path.
+void Fl_PicoFB_Graphics_Driver::fill_polygon(const XPOINT *pts, int npts, const int *starts, int nstarts)
+{
+  if (npts < 3) return;
+  float ymin = pts[0].y, ymax = pts[0].y;
+  int i;
+  for (i = 1; i < npts; i++) {
+    if (pts[i].y < ymin) ymin = pts[i].y;
+    if (pts[i].y > ymax) ymax = pts[i].y;
+  }
+  Clip_Rect &c = clip();
+  int y0 = (int)ceilf(ymin - 0.5f), y1 = (int)ceilf(ymax - 0.5f);
+  if (y0 < c.y) y0 = c.y;
+  if (y1 > c.b) y1 = c.b;
+  if (xs_size_ < npts) {
+    xs_size_ = npts + 16;
+    xs_ = (float*)realloc(xs_, xs_size_ * sizeof(float));
+  }
+  for (int y = y0; y < y1; y++) {
+    float yc = y + 0.5f;
+    int nx = 0;
+    for (int s = 0; s < nstarts; s++) {
+      int first = starts[s], last = (s + 1 < nstarts ? starts[s+1] : npts) - 1;
+      for (i = first; i <= last; i++) {
+        const XPOINT &a = pts[i], &b = pts[i < last ? i + 1 : first];
+        if ((a.y <= yc && b.y > yc) || (b.y <= yc && a.y > yc)) {
+          float x = a.x + (yc - a.y) * (b.x - a.x) / (b.y - a.y);
+          // insertion sort, the number of crossings is usually tiny
+          int k = nx++;
+          while (k > 0 && xs_[k-1] > x) { xs_[k] = xs_[k-1]; k--; }
+          xs_[k] = x;
+        }
+      }
+    }
+    for (i = 0; i + 1 < nx; i += 2) {
+      int xa = (int)ceilf(xs_[i] - 0.5f), xb = (int)ceilf(xs_[i+1] - 0.5f) - 1;
+      if (xb >= xa) fill_span(xa, xb, y);
+    }
+  }
+}
+
+
+void Fl_PicoFB_Graphics_Driver::polygon(int x0, int y0, int x1, int y1, int x2, int y2)
+{
+  XPOINT q[3] = { {(float)x0, (float)y0}, {(float)x1, (float)y1}, {(float)x2, (float)y2} };
+  int start = 0;
+  fill_polygon(q, 3, &start, 1);
+}
+
+
+void Fl_PicoFB_Graphics_Driver::polygon(int x0, int y0, int x1, int y1, int x2, int y2, int x3, int y3)
+{
+  XPOINT q[4] = { {(float)x0, (float)y0}, {(float)x1, (float)y1},
+                  {(float)x2, (float)y2}, {(float)x3, (float)y3} };
+  int start = 0;
+  fill_polygon(q, 4, &start, 1);
+}
+
+
+// ---- clipping -------------------------------------------------------------
+
+void Fl_PicoFB_Graphics_Driver::push_clip(int x, int y, int w, int h)
+{
+  if (clip_sp_ >= region_stack_max) {
+    Fl::warning("Fl_PicoFB_Graphics_Driver::push_clip: clip stack overflow!\n");
+    return;
+  }
+  Clip_Rect c = clip();
+  if (w > 0 && h > 0) {
+    if (x > c.x) c.x = x;
+    if (y > c.y) c.y = y;
+    if (x + w < c.r) c.r = x + w;
+    if (y + h < c.b) c.b = y + h;
+    if (c.r < c.x) c.r = c.x;
+    if (c.b < c.y) c.b = c.y;
+  } else {
+    c.r = c.x; c.b = c.y; // nothing is visible
+  }
+  clip_[++clip_sp_] = c;
+}
+
+
+void Fl_PicoFB_Graphics_Driver::push_no_clip()
+{
+  if (clip_sp_ >= region_stack_max) {
+    Fl::warning("Fl_PicoFB_Graphics_Driver::push_no_clip: clip stack overflow!\n");
+    return;
+  }
+  clip_[++clip_sp_] = clip_[0];
+}
+
+
+void Fl_PicoFB_Graphics_Driver::pop_clip()
+{
+  if (clip_sp_ > 0) clip_sp_--;
+  else Fl::warning("Fl_PicoFB_Graphics_Driver::pop_clip: clip stack underflow!\n");
+}
+
+
+int Fl_PicoFB_Graphics_Driver::clip_box(int x, int y, int w, int h, int &X, int &Y, int &W, int &H)
+{
+  Clip_Rect &c = clip();
+  int r = x + w, b = y + h;
+  X = x > c.x ? x : c.x;
+  Y = y > c.y ? y : c.y;
+  W = (r < c.r ? r : c.r) - X;
+  H = (b < c.b ? b : c.b) - Y;
+  if (W < 0) W = 0;
+  if (H < 0) H = 0;
+  return (X != x || Y != y || W != w || H != h);
+}
+
+
+int Fl_PicoFB_Graphics_Driver::not_clipped(int x, int y, int w, int h)
+{
+  Clip_Rect &c = clip();
+  return x < c.r && y < c.b && x + w > c.x && y + h > c.y;
+}
+
+
+// ---- complex shapes -------------------------------------------------------
+
+void Fl_PicoFB_Graphics_Driver::begin_points()
+{
+  n = 0;
+  what = POINT_;
+}
+
+
+void Fl_PicoFB_Graphics_Driver::begin_line()
+{
+  n = 0;
+  what = LINE;
+}
+
+
+void Fl_PicoFB_Graphics_Driver::begin_loop()
+{
+  n = 0;
+  what = LOOP;
+}
+
+
+void Fl_PicoFB_Graphics_Driver::begin_polygon()
+{
+  n = 0;
+  what = POLYGON;
+  subpath_n_ = 0;
+}
+
+
+void Fl_PicoFB_Graphics_Driver::begin_complex_polygon()
+{
+  begin_polygon();
+  gap_ = 0;
+}
+
+
+void Fl_PicoFB_Graphics_Driver::transformed_vertex(double xf, double yf)
+{
+  transformed_vertex0((float)xf, (float)yf);
+}
+
+
+void Fl_PicoFB_Graphics_Driver::vertex(double x, double y)
+{
+  transformed_vertex0((float)(x*m.a + y*m.c + m.x), (float)(x*m.b + y*m.d + m.y));
+}
+
+
+void Fl_PicoFB_Graphics_Driver::end_points()
+{
+  for (int i = 0; i < n; i++) point((int)floorf(p[i].x + 0.5f), (int)floorf(p[i].y + 0.5f));
+  n = 0;
+}
+
+
+void Fl_PicoFB_Graphics_Driver::end_line()
+{
+  if (n < 2) { end_points(); return; }
+  draw_lines(p, n);
+  n = 0;
+}
+
+
+void Fl_PicoFB_Graphics_Driver::end_loop()
+{
+  fixloop();
+  if (n > 2) transformed_vertex0(p[0].x, p[0].y);
+  end_line();
+}
+
+
+void Fl_PicoFB_Graphics_Driver::end_polygon()
+{
+  fixloop();
+  if (n > 2) {
+    int start = 0;
+    fill_polygon(p, n, &start, 1);
+  }
+  n = 0;
+}
+
+
+void Fl_PicoFB_Graphics_Driver::gap()
+{
+  while (n > gap_ + 2 && p[n-1].x == p[gap_].x && p[n-1].y == p[gap_].y) n--;
+  if (n > gap_ + 2) {
+    if (subpath_n_ >= subpath_size_) {
+      subpath_size_ = subpath_size_ ? 2 * subpath_size_ : 8;
+      subpath_ = (int*)realloc(subpath_, subpath_size_ * sizeof(int));
+    }
+    subpath_[subpath_n_++] = gap_;
+    gap_ = n;
+  } else {
+    n = gap_;
+  }
+}
+
+
+void Fl_PicoFB_Graphics_Driver::end_complex_polygon()
+{
+  gap();
+  if (n > 2) fill_polygon(p, n, subpath_, subpath_n_);
+  n = 0;
+  subpath_n_ = 0;
+}
+
+
+// Adds points of an axis-aligned ellipse arc in device coordinates,
+// a1 and a2 in degrees counter-clockwise from 3 o'clock.
+void Fl_PicoFB_Graphics_Driver::ellipse_points(double x, double y, double rx, double ry, double a1, double a2)
+{
+  double A1 = a1 * M_PI / 180, A2 = a2 * M_PI / 180;
+  // choose the number of segments so that the error stays well below one pixel
+  int segs = (int)ceil(fabs(A2 - A1) * sqrt((rx + ry) / 2) * 2);
+  if (segs < 4) segs = 4;
+  for (int i = 0; i <= segs; i++) {
+    double a = A1 + (A2 - A1) * i / segs;
+    transformed_vertex0((float)(x + cos(a) * rx), (float)(y - sin(a) * ry));
+  }
+}
+
+
+void Fl_PicoFB_Graphics_Driver::circle(double x, double y, double r)
+{
+  double xt = transform_x(x, y);
+  double yt = transform_y(x, y);
+  double rx = r * (m.c ? sqrt(m.a*m.a + m.c*m.c) : fabs(m.a));
+  double ry = r * (m.b ? sqrt(m.b*m.b + m.d*m.d) : fabs(m.d));
+  if (what == POLYGON) { xt += 0.5; yt += 0.5; } // fill around pixel centers
+  ellipse_points(xt, yt, rx, ry, 0, 360);
+}
+
+
+void Fl_PicoFB_Graphics_Driver::arc(int x, int y, int w, int h, double a1, double a2)
+{
+  if (w <= 0 || h <= 0 || a2 <= a1) return;
+  n = 0;
+  ellipse_points(x + (w - 1) / 2.0, y + (h - 1) / 2.0, (w - 1) / 2.0, (h - 1) / 2.0, a1, a2);
+  draw_lines(p, n);
+  n = 0;
+}
+
+
+void Fl_PicoFB_Graphics_Driver::pie(int x, int y, int w, int h, double a1, double a2)
+{
+  if (w <= 0 || h <= 0 || a2 <= a1) return;
+  double cx = x + w / 2.0, cy = y + h / 2.0;
+  n = 0;
+  if (a2 - a1 < 360) transformed_vertex0((float)cx, (float)cy);
+  ellipse_points(cx, cy, w / 2.0, h / 2.0, a1, a2);
+  int start = 0;
+  fill_polygon(p, n, &start, 1);
+  n = 0;
+}
+
+
+// ---- color ----------------------------------------------------------------
+
+void Fl_PicoFB_Graphics_Driver::color(Fl_Color c)
+{
+  color_ = c;
+  Fl::get_color(c, red_, green_, blue_);
+}
+
+
+void Fl_PicoFB_Graphics_Driver::color(uchar r, uchar g, uchar b)
+{
+  color_ = fl_rgb_color(r, g, b);
+  red_ = r; green_ = g; blue_ = b;
+}
+
+
+// ---- text -----------------------------------------------------------------
+
+void Fl_PicoFB_Graphics_Driver::draw_ttf(int face, const char *str, int n, int x, int y)
+{
+  Fl_PicoFB_Font *f = ttf_font(face);
+  float scale = stbtt_ScaleForPixelHeight(&f->info, (float)size_);
+  float pen = (float)x;
+  Clip_Rect &c = clip();
+  const char *end = str + n;
+  while (str < end) {
+    int len;
+    unsigned ucs = fl_utf8decode(str, end, &len);
+    str += len;
+    Fl_PicoFB_Glyph *g = glyph(face, size_, ucs);
+    int gx = (int)floorf(pen + 0.5f) + g->xoff, gy = y + g->yoff;
+    for (int j = 0; j < g->h; j++) {
+      int py = gy + j;
+      if (py < c.y || py >= c.b) continue;
+      const uchar *cov = g->bitmap + j * g->w;
+      for (int i = 0; i < g->w; i++) {
+        int px = gx + i;
+        if (px >= c.x && px < c.r && cov[i]) blend(px, py, cov[i]);
+      }
+    }
+    int advance, lsb;
+    stbtt_GetCodepointHMetrics(&f->info, ucs, &advance, &lsb);
+    pen += advance * scale;
+  }
+}
+
+
+void Fl_PicoFB_Graphics_Driver::draw(const char *str, int n, int x, int y)
+{
+  if (ttf_font(font_)) draw_ttf(font_, str, n, x, y);
+  else Fl_Pico_Graphics_Driver::draw(str, n, x, y);
+}
+
+
+double Fl_PicoFB_Graphics_Driver::width(const char *str, int n)
+{
+  Fl_PicoFB_Font *f = ttf_font(font_);
+  if (!f) return Fl_Pico_Graphics_Driver::width(str, n);
+  const char *end = str + n;
+  int w = 0;
+  while (str < end) {
+    int len, advance, lsb;
+    unsigned ucs = fl_utf8decode(str, end, &len);
+    str += len;
+    stbtt_GetCodepointHMetrics(&f->info, ucs, &advance, &lsb);
+    w += advance;
+  }
+  return w * stbtt_ScaleForPixelHeight(&f->info, (float)size_);
+}
+
+
+double Fl_PicoFB_Graphics_Driver::width(unsigned int c)
+{
+  char buf[4];
+  int n = fl_utf8encode(c, buf);
+  return width(buf, n);
+}
+
+
+int Fl_PicoFB_Graphics_Driver::height()
+{
+  Fl_PicoFB_Font *f = ttf_font(font_);
+  if (!f) return Fl_Pico_Graphics_Driver::height();
+  int ascent, descent, gap;
+  stbtt_GetFontVMetrics(&f->info, &ascent, &descent, &gap);
+  return (int)ceilf((ascent - descent) * stbtt_ScaleForPixelHeight(&f->info, (float)size_));
+}
+
+
+int Fl_PicoFB_Graphics_Driver::descent()
+{
+  Fl_PicoFB_Font *f = ttf_font(font_);
+  if (!f) return Fl_Pico_Graphics_Driver::descent();
+  int ascent, descent, gap;
+  stbtt_GetFontVMetrics(&f->info, &ascent, &descent, &gap);
+  return (int)ceilf(-descent * stbtt_ScaleForPixelHeight(&f->info, (float)size_));
+}
+
+
+// ---- images ---------------------------------------------------------------
+
+// Copies W x H pixels to X, Y. Source pixels are 'delta' bytes apart and lines
+// are L bytes apart. 'fmt' is 1 (gray), 2 (gray + alpha), 3 (RGB) or 4 (RGBA).
+void Fl_PicoFB_Graphics_Driver::blit(const uchar *src, int X, int Y, int W, int H, int delta, int L, int fmt)
+{
+  if (!L) L = W * delta;
+  Clip_Rect &c = clip();
+  int cx = 0, cy = 0;
+  if (X < c.x) { cx = c.x - X; W -= cx; X = c.x; }
+  if (Y < c.y) { cy = c.y - Y; H -= cy; Y = c.y; }
+  if (X + W > c.r) W = c.r - X;
+  if (Y + H > c.b) H = c.b - Y;
+  if (W <= 0 || H <= 0) return;
+  src += cy * L + cx * delta;
+  for (int j = 0; j < H; j++, src += L) {
+    const uchar *s = src;
+    uchar *d = buffer_ + (Y + j) * ld_ + X * 3;
+    for (int i = 0; i < W; i++, s += delta, d += 3) {
+      uchar r, g, b, a = 255;
+      if (fmt < 3) { r = g = b = s[0]; if (fmt == 2) a = s[1]; }
+      else { r = s[0]; g = s[1]; b = s[2]; if (fmt == 4) a = s[3]; }
+      if (a == 255) {
+        d[0] = r; d[1] = g; d[2] = b;
+      } else if (a) {
+        d[0] = (uchar)(d[0] + ((r - d[0]) * a + 127) / 255);
+        d[1] = (uchar)(d[1] + ((g - d[1]) * a + 127) / 255);
+        d[2] = (uchar)(d[2] + ((b - d[2]) * a + 127) / 255);
+      }
+    }
+  }
+}
+
+
+void Fl_PicoFB_Graphics_Driver::draw_image(const uchar *buf, int X, int Y, int W, int H, int D, int L)
+{
+  int alpha = (abs(D) & FL_IMAGE_WITH_ALPHA) != 0;
+  if (alpha) D ^= FL_IMAGE_WITH_ALPHA;
+  int mono = (D > -3 && D < 3);
+  blit(buf, X, Y, W, H, D, L, mono ? (alpha ? 2 : 1) : (alpha ? 4 : 3));
+}
+
+
+void Fl_PicoFB_Graphics_Driver::draw_image_mono(const uchar *buf, int X, int Y, int W, int H, int D, int L)
+{
+  blit(buf, X, Y, W, H, D, L, 1);
+}
+
+
+void Fl_PicoFB_Graphics_Driver::draw_image(Fl_Draw_Image_Cb cb, void *data, int X, int Y, int W, int H, int D)
+{
+  int alpha = (abs(D) & FL_IMAGE_WITH_ALPHA) != 0;
+  if (alpha) D ^= FL_IMAGE_WITH_ALPHA;
+  int mono = (D > -3 && D < 3);
+  D = abs(D);
+  uchar *line = new uchar[W * D];
+  Clip_Rect &c = clip();
+  for (int j = 0; j < H; j++) {
+    if (Y + j < c.y || Y + j >= c.b) continue;
+    cb(data, 0, j, W, line);
+    blit(line, X, Y + j, W, 1, D, 0, mono ? (alpha ? 2 : 1) : (alpha ? 4 : 3));
+  }
+  delete[] line;
+}
+
+
+void Fl_PicoFB_Graphics_Driver::draw_image_mono(Fl_Draw_Image_Cb cb, void *data, int X, int Y, int W, int H, int D)
+{
+  D = abs(D);
+  uchar *line = new uchar[W * D];
+  Clip_Rect &c = clip();
+  for (int j = 0; j < H; j++) {
+    if (Y + j < c.y || Y + j >= c.b) continue;
+    cb(data, 0, j, W, line);
+    blit(line, X, Y + j, W, 1, D, 0, 1);
+  }
+  delete[] line;
+}
+
+
+void Fl_PicoFB_Graphics_Driver::draw_rgb(Fl_RGB_Image *rgb, int XP, int YP, int WP, int HP, int cx, int cy)
+{
+  if (!rgb->d() || !rgb->array) {
+    Fl_Graphics_Driver::draw_empty(rgb, XP, YP);
+    return;
+  }
+  if (rgb->w() != rgb->data_w() || rgb->h() != rgb->data_h()) {
+    // draw a copy resized to the drawing size
+    Fl_RGB_Image *img2 = (Fl_RGB_Image*)rgb->copy(rgb->w(), rgb->h());
+    draw_rgb(img2, XP, YP, WP, HP, cx, cy);
+    delete img2;
+    return;
+  }
+  int X, Y, W, H;
+  if (start_image(rgb, XP, YP, WP, HP, cx, cy, X, Y, W, H)) return;
+  int d = rgb->d();
+  int ld = rgb->ld() ? rgb->ld() : rgb->data_w() * d;
+  blit(rgb->array + cy * ld + cx * d, X, Y, W, H, d, ld, d);
+}
+
+
+void Fl_PicoFB_Graphics_Driver::draw_pixmap(Fl_Pixmap *pxm, int XP, int YP, int WP, int HP, int cx, int cy)
+{
+  Fl_RGB_Image rgb(pxm);
+  rgb.scale(pxm->w(), pxm->h(), 0, 1);
+  draw_rgb(&rgb, XP, YP, WP, HP, cx, cy);
+}
+
+
+void Fl_PicoFB_Graphics_Driver::draw_bitmap(Fl_Bitmap *bm, int XP, int YP, int WP, int HP, int cx, int cy)
+{
+  int X, Y, W, H;
+  if (start_image(bm, XP, YP, WP, HP, cx, cy, X, Y, W, H)) return;
+  // map drawing coordinates to bitmap data, which may be scaled
+  int bw = (bm->data_w() + 7) / 8;
+  for (int j = 0; j < H; j++) {
+    int sy = (cy + j) * bm->data_h() / bm->h();
+    const uchar *row = bm->array + sy * bw;
+    for (int i = 0; i < W; i++) {
+      int sx = (cx + i) * bm->data_w() / bm->w();
+      if (row[sx >> 3] & (1 << (sx & 7))) blend(X + i, Y + j, 255);
+    }
+  }
+}
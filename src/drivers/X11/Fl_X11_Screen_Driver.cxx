@@ -404,8 +404,10 @@ void Fl_X11_Screen_Driver::beep(int type)
 
 void Fl_X11_Screen_Driver::flush()
 {
-  if (fl_display)
+  if (fl_display) {
+    Fl_Xlib_Graphics_Driver::flush_batch();
     XFlush(fl_display);
+  }
 }
 
 
@@ -749,6 +751,7 @@ Fl_RGB_Image *Fl_X11_Screen_Driver::read_win_rectangle(int X, int Y, int w, int
   if (w < 0) w = - w;
 
   Window xid = (win && !allow_outside ? fl_xid(win) : fl_window);
+  Fl_Xlib_Graphics_Driver::flush_batch();
 
   float s = allow_outside ? Fl::screen_driver()->scale(win->screen_num()) : Fl_Surface_Device::surface()->driver()->scale();
   int Xs = Fl_Scalable_Graphics_Driver::floor(X, s);
@@ -540,7 +540,14 @@ int Fl_X11_System_Driver::filename_list(const char *d,
     if (de->d_name[len-1]!='/' && len<=FL_PATH_MAX) {
       // Use memcpy for speed since we already know the length of the string...
       memcpy(name, de->d_name, len+1);
-      if (fl_filename_isdir(fullname)) {
+#if defined(DT_DIR) && defined(DT_LNK) && defined(DT_UNKNOWN)
+      // the type from readdir() saves a stat() unless it is unknown or a link
+      int isdir = (de->d_type == DT_UNKNOWN || de->d_type == DT_LNK) ?
+                  fl_filename_isdir(fullname) : de->d_type == DT_DIR;
+#else
+      int isdir = fl_filename_isdir(fullname);
+#endif
+      if (isdir) {
         char *dst = newde->d_name + newlen;
         *dst++ = '/';
         *dst = 0;
@@ -38,8 +38,61 @@
 Window fl_window;
 
 
+// Back buffers of double-buffered windows go to a small pool when a window
+// is hidden or grows, and new back buffers are taken from it when they are
+// large enough. Sizes are rounded up, so that interactively resizing a
+// window or showing the same dialog again doesn't create and free an X
+// pixmap every time.
+
+#define BUFFER_POOL_SIZE 4
+#define BUFFER_ROUND 64
+
+static struct {
+  Fl_Offscreen off;
+  int w, h;
+  float scale;
+} buffer_pool[BUFFER_POOL_SIZE];
+static int buffer_pool_count = 0;
+
+// Returns a pooled buffer of at least W x H for scale factor s,
+// or creates one. W and H are set to the size of the buffer.
+static Fl_Offscreen get_back_buffer(int &W, int &H, float s) {
+  W = (W + BUFFER_ROUND - 1) / BUFFER_ROUND * BUFFER_ROUND;
+  H = (H + BUFFER_ROUND - 1) / BUFFER_ROUND * BUFFER_ROUND;
+  int best = -1;
+  for (int n = 0; n < buffer_pool_count; n++) {
+    if (buffer_pool[n].scale != s || buffer_pool[n].w < W || buffer_pool[n].h < H)
+      continue;
+    // don't give a large buffer to a small window:
+    if (buffer_pool[n].w * buffer_pool[n].h > 2 * W * H) continue;
+    if (best < 0 || buffer_pool[n].w * buffer_pool[n].h < buffer_pool[best].w * buffer_pool[best].h)
+      best = n;
+  }
+  if (best < 0) return fl_create_offscreen(W, H);
+  Fl_Offscreen off = buffer_pool[best].off;
+  W = buffer_pool[best].w;
+  H = buffer_pool[best].h;
+  buffer_pool_count--;
+  memmove(buffer_pool + best, buffer_pool + best + 1, (buffer_pool_count - best) * sizeof(buffer_pool[0]));
+  return off;
+}
+
+// Puts a buffer into the pool, deleting the oldest one if the pool is full.
+static void release_back_buffer(Fl_Offscreen off, int W, int H, float s) {
+  if (buffer_pool_count == BUFFER_POOL_SIZE) {
+    fl_delete_offscreen(buffer_pool[0].off);
+    buffer_pool_count--;
+    memmove(buffer_pool, buffer_pool + 1, buffer_pool_count * sizeof(buffer_pool[0]));
+  }
+  buffer_pool[buffer_pool_count].off = off;
+  buffer_pool[buffer_pool_count].w = W;
+  buffer_pool[buffer_pool_count].h = H;
+  buffer_pool[buffer_pool_count].scale = s;
+  buffer_pool_count++;
+}
+
 void Fl_X11_Window_Driver::destroy_double_buffer() {
-  fl_delete_offscreen(other_xid);
+  if (other_xid) release_back_buffer(other_xid, other_w_, other_h_, other_scale_);
   other_xid = 0;
 }
 
@@ -54,6 +107,8 @@ Fl_X11_Window_Driver::Fl_X11_Window_Driver(Fl_Window *win)
 {
   icon_ = new icon_data;
   memset(icon_, 0, sizeof(icon_data));
+  other_w_ = other_h_ = 0;
+  other_scale_ = 1;
 #if USE_XFT
   screen_num_ = -1;
 #endif
@@ -155,7 +210,9 @@ void Fl_X11_Window_Driver::flush_double(int erase_overlay)
   pWindow->make_current(); // make sure fl_gc is non-zero
   Fl_X *i = Fl_X::i(pWindow);
   if (!other_xid) {
-      other_xid = fl_create_offscreen(w(), h());
+    other_w_ = w(); other_h_ = h();
+    other_scale_ = fl_graphics_driver->scale();
+    other_xid = get_back_buffer(other_w_, other_h_, other_scale_);
     pWindow->clear_damage(FL_DAMAGE_ALL);
   }
     if (pWindow->damage() & ~FL_DAMAGE_EXPOSE) {
@@ -167,7 +224,23 @@ void Fl_X11_Window_Driver::flush_double(int erase_overlay)
   if (erase_overlay) fl_clip_region(0);
   int X = 0, Y = 0, W = 0, H = 0;
   fl_clip_box(0, 0, w(), h(), X, Y, W, H);
-  if (other_xid) fl_copy_offscreen(X, Y, W, H, other_xid, X, Y);
+  other_copied = 0;
+  if (!other_xid || W <= 0 || H <= 0) return;
+  // The clip region is the damaged area: the X server copies only its
+  // rectangles, not the whole bounding box.
+  fl_copy_offscreen(X, Y, W, H, other_xid, X, Y);
+  Fl_Region r = fl_clip_region();
+  double area = 0;
+  if (!r) area = double(W) * H;
+  else for (int n = 0; n < r->numRects; n++) {
+    const BOX &b = r->rects[n];
+    int x1 = b.x1 > X ? b.x1 : X, x2 = b.x2 < X + W ? b.x2 : X + W;
+    int y1 = b.y1 > Y ? b.y1 : Y, y2 = b.y2 < Y + H ? b.y2 : Y + H;
+    if (x2 > x1 && y2 > y1) area += double(x2 - x1) * (y2 - y1);
+  }
+  float s = fl_graphics_driver->scale();
+  int depth = fl_visual->depth;
+  other_copied = (unsigned long)(area * s * s + 0.5) * (depth > 16 ? 4 : (depth > 8 ? 2 : 1));
 }
 
 
@@ -393,6 +466,7 @@ void Fl_X11_Window_Driver::hide() {
   Fl_Xlib_Graphics_Driver::destroy_xft_draw(ip->xid);
   screen_num_ = -1;
 # endif
+  Fl_Xlib_Graphics_Driver::flush_batch();
   // this test makes sure ip->xid has not been destroyed already
   if (ip->xid) XDestroyWindow(fl_display, ip->xid);
   delete ip;
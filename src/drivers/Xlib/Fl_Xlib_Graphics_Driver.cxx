@@ -65,6 +65,8 @@ Fl_Xlib_Graphics_Driver::~Fl_Xlib_Graphics_Driver() {
 
 
 void Fl_Xlib_Graphics_Driver::gc(void *value) {
+  flush_batch();
+  if ((GC)value != gc_) forget_clip();
   gc_ = (GC)value;
   fl_gc = gc_;
 }
@@ -81,6 +83,7 @@ void Fl_Xlib_Graphics_Driver::scale(float f) {
 }
 
 void Fl_Xlib_Graphics_Driver::copy_offscreen(int x, int y, int w, int h, Fl_Offscreen pixmap, int srcx, int srcy) {
+  flush_batch();
   XCopyArea(fl_display, pixmap, fl_window, gc_, srcx*scale(), srcy*scale(), w*scale(), h*scale(), (x+offset_x_)*scale(), (y+offset_y_)*scale());
 
 }
@@ -204,6 +207,7 @@ void Fl_Xlib_Graphics_Driver::font_name(int num, const char *name) {
     pango_font_description_free(pfd_array[num]);
     pfd_array[num] = NULL;
   }
+  clear_layout_cache();
 #  endif
   Fl_Fontdesc *s = fl_fonts + num;
 #else
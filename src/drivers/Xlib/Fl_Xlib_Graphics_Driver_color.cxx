@@ -102,14 +102,24 @@ void Fl_Xlib_Graphics_Driver::color(Fl_Color i) {
   } else {
     Fl_Graphics_Driver::color(i);
     if(!gc_) return; // don't get a default gc if current window is not yet created/valid
-    XSetForeground(fl_display, gc_, fl_xpixel(i));
+    unsigned long pixel = fl_xpixel(i);
+    if (pixel != batch_pixel_) {
+      flush_batch();
+      batch_pixel_ = pixel;
+    }
+    XSetForeground(fl_display, gc_, pixel);
   }
 }
 
 void Fl_Xlib_Graphics_Driver::color(uchar r,uchar g,uchar b) {
   Fl_Graphics_Driver::color( fl_rgb_color(r, g, b) );
   if(!gc_) return; // don't get a default gc if current window is not yet created/valid
-  XSetForeground(fl_display, gc_, fl_xpixel(r,g,b));
+  unsigned long pixel = fl_xpixel(r,g,b);
+  if (pixel != batch_pixel_) {
+    flush_batch();
+    batch_pixel_ = pixel;
+  }
+  XSetForeground(fl_display, gc_, pixel);
 }
 
 /** \addtogroup  fl_attributes
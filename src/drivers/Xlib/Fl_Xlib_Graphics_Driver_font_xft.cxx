@@ -689,7 +689,59 @@ puts("Font Opened"); fflush(stdout);
 Fl_Xlib_Font_Descriptor::Fl_Xlib_Font_Descriptor(const char* name, Fl_Fontsize fsize, int fangle) : Fl_Font_Descriptor(name, fsize) {
 //  encoding = fl_encoding_;
   angle = fangle;
-  font = fontopen(name, fsize, false, angle);
+  fnum = 0;
+  hash_next = lru_prev = lru_next = NULL;
+  font = NULL; // opened by xft_font()
+}
+
+// Only the Xft fonts of the max_open_fonts most recently selected
+// descriptors are kept open (all of them if max_open_fonts <= 0).
+// The others are closed and opened again when they are used.
+static int max_open_fonts = 128;
+static int open_fonts = 0;
+static Fl_Xlib_Font_Descriptor *lru_first = NULL, *lru_last = NULL;
+
+static void lru_unlink(Fl_Xlib_Font_Descriptor *f) {
+  if (f->lru_prev) f->lru_prev->lru_next = f->lru_next;
+  else lru_first = f->lru_next;
+  if (f->lru_next) f->lru_next->lru_prev = f->lru_prev;
+  else lru_last = f->lru_prev;
+  f->lru_prev = f->lru_next = NULL;
+}
+
+static void lru_push(Fl_Xlib_Font_Descriptor *f) {
+  f->lru_prev = NULL;
+  f->lru_next = lru_first;
+  if (lru_first) lru_first->lru_prev = f;
+  else lru_last = f;
+  lru_first = f;
+}
+
+// closes the least recently used fonts, except 'keep' and the current font
+static void close_fonts(Fl_Xlib_Font_Descriptor *keep) {
+  Fl_Xlib_Font_Descriptor *f = lru_last;
+  while (f && max_open_fonts > 0 && open_fonts > max_open_fonts) {
+    Fl_Xlib_Font_Descriptor *prev = f->lru_prev;
+    if (f != keep && f->font != fl_xftfont) {
+      lru_unlink(f);
+      XftFontClose(fl_display, f->font);
+      f->font = NULL;
+      open_fonts--;
+    }
+    f = prev;
+  }
+}
+
+// returns the Xft font of a descriptor, opening it if it is closed
+static XftFont *xft_font(Fl_Font_Descriptor *desc) {
+  Fl_Xlib_Font_Descriptor *f = (Fl_Xlib_Font_Descriptor*)desc;
+  if (!f->font) {
+    f->font = fontopen(fl_fonts[f->fnum].name, f->size, false, f->angle);
+    lru_push(f);
+    open_fonts++;
+    close_fonts(f);
+  }
+  return f->font;
 }
 
 
@@ -721,19 +773,19 @@ static void utf8extents(Fl_Xlib_Font_Descriptor *desc, const char *str, int n, X
   memset(extents, 0, sizeof(XGlyphInfo));
   const wchar_t *buffer = utf8reformat(str, n);
 #ifdef __CYGWIN__
-    XftTextExtents16(fl_display, desc->font, (XftChar16 *)buffer, n, extents);
+    XftTextExtents16(fl_display, xft_font(desc), (XftChar16 *)buffer, n, extents);
 #else
-    XftTextExtents32(fl_display, desc->font, (XftChar32 *)buffer, n, extents);
+    XftTextExtents32(fl_display, xft_font(desc), (XftChar32 *)buffer, n, extents);
 #endif
 }
 
 int Fl_Xlib_Graphics_Driver::height_unscaled() {
-  if (font_descriptor()) return ((Fl_Xlib_Font_Descriptor*)font_descriptor())->font->ascent + ((Fl_Xlib_Font_Descriptor*)font_descriptor())->font->descent;
+  if (font_descriptor()) return xft_font(font_descriptor())->ascent + xft_font(font_descriptor())->descent;
   else return -1;
 }
 
 int Fl_Xlib_Graphics_Driver::descent_unscaled() {
-  if (font_descriptor()) return ((Fl_Xlib_Font_Descriptor*)font_descriptor())->font->descent;
+  if (font_descriptor()) return xft_font(font_descriptor())->descent;
   else return -1;
 }
 
@@ -747,7 +799,7 @@ double Fl_Xlib_Graphics_Driver::width_unscaled(const char* str, int n) {
 static double fl_xft_width(Fl_Font_Descriptor *desc, FcChar32 *str, int n) {
   if (!desc) return -1.0;
   XGlyphInfo i;
-  XftTextExtents32(fl_display, ((Fl_Xlib_Font_Descriptor*)desc)->font, str, n, &i);
+  XftTextExtents32(fl_display, xft_font(desc), str, n, &i);
   return i.xOff;
 }
 
@@ -782,6 +834,7 @@ void Fl_Xlib_Graphics_Driver::draw_unscaled(const char *str, int n, int x, int y
   int y1 = y + floor(offset_y_) ;
   if (y1 < clip_min() || y1 > clip_max()) return;
 
+  flush_batch();
   if (!draw_)
     draw_ = XftDrawCreate(fl_display, draw_window = fl_window,
                          fl_visual->visual, fl_colormap);
@@ -804,9 +857,9 @@ void Fl_Xlib_Graphics_Driver::draw_unscaled(const char *str, int n, int x, int y
 
     const wchar_t *buffer = utf8reformat(str, n);
 #ifdef __CYGWIN__
-    XftDrawString16(draw_, &color, ((Fl_Xlib_Font_Descriptor*)font_descriptor())->font, x1, y1, (XftChar16 *)buffer, n);
+    XftDrawString16(draw_, &color, xft_font(font_descriptor()), x1, y1, (XftChar16 *)buffer, n);
 #else
-    XftDrawString32(draw_, &color, ((Fl_Xlib_Font_Descriptor*)font_descriptor())->font, x1, y1, (XftChar32 *)buffer, n);
+    XftDrawString32(draw_, &color, xft_font(font_descriptor()), x1, y1, (XftChar32 *)buffer, n);
 #endif
   }
 }
@@ -818,6 +871,7 @@ void Fl_Xlib_Graphics_Driver::draw_unscaled(int angle, const char *str, int n, i
 }
 
 void Fl_Xlib_Graphics_Driver::drawUCS4(const void *str, int n, int x, int y) {
+  flush_batch();
   if (!draw_)
     draw_ = XftDrawCreate(fl_display, draw_window = fl_window,
                          fl_visual->visual, fl_colormap);
@@ -838,7 +892,7 @@ void Fl_Xlib_Graphics_Driver::drawUCS4(const void *str, int n, int x, int y) {
   color.color.blue  = ((int)b)*0x101;
   color.color.alpha = 0xffff;
 
-  XftDrawString32(draw_, &color, ((Fl_Xlib_Font_Descriptor*)font_descriptor())->font, x+floor(offset_x_), y+floor(offset_y_), (FcChar32 *)str, n);
+  XftDrawString32(draw_, &color, xft_font(font_descriptor()), x+floor(offset_x_), y+floor(offset_y_), (FcChar32 *)str, n);
 }
 
 
@@ -977,8 +1031,52 @@ float Fl_Xlib_Graphics_Driver::scale_bitmap_for_PostScript() {
   return 2;
 }
 
+// The font descriptors of all faces, hashed by face, size and angle.
+// They are also in the linked list of their face (Fl_Fontdesc::first).
+#define FL_XFT_FONT_SLOTS 256 // must be a power of 2
+static Fl_Xlib_Font_Descriptor *font_slots[FL_XFT_FONT_SLOTS];
+
+static Fl_Xlib_Font_Descriptor **font_slot(Fl_Font fnum, Fl_Fontsize size, int angle) {
+  unsigned h = ((unsigned)fnum * 31 + (unsigned)size) * 31 + (unsigned)angle;
+  return font_slots + (h & (FL_XFT_FONT_SLOTS - 1));
+}
+
+// returns the descriptor of a face, size and angle, creating it if needed
+static Fl_Xlib_Font_Descriptor *find_font_descriptor(Fl_Font fnum, Fl_Fontsize size, int angle) {
+  Fl_Xlib_Font_Descriptor **slot = font_slot(fnum, size, angle), *f;
+  for (f = *slot; f; f = f->hash_next) {
+    if (f->fnum == fnum && f->size == size && f->angle == angle)
+      break;
+  }
+  if (!f) {
+    Fl_Fontdesc *font = fl_fonts + fnum;
+    f = new Fl_Xlib_Font_Descriptor(font->name, size, angle);
+    f->fnum = fnum;
+    f->next = font->first;
+    font->first = f;
+    f->hash_next = *slot;
+    *slot = f;
+  }
+#if !USE_PANGO
+  else if (f->font && f != lru_first) { // most recently used
+    lru_unlink(f);
+    lru_push(f);
+  }
+#endif
+  return f;
+}
+
 Fl_Xlib_Font_Descriptor::~Fl_Xlib_Font_Descriptor() {
   if (this == fl_graphics_driver->font_descriptor()) fl_graphics_driver->font_descriptor(NULL);
+  Fl_Xlib_Font_Descriptor **p = font_slot(fnum, size, angle);
+  while (*p && *p != this) p = &(*p)->hash_next;
+  if (*p) *p = hash_next;
+#if !USE_PANGO
+  if (font) {
+    lru_unlink(this);
+    open_fonts--;
+  }
+#endif
   //  XftFontClose(fl_display, font);
 #if USE_PANGO
   if (width) for (int i = 0; i < 64; i++) delete[] width[i];
@@ -1002,30 +1100,41 @@ static void fl_xft_font(Fl_Xlib_Graphics_Driver *driver, Fl_Font fnum, Fl_Fontsi
   if (fnum == driver->Fl_Graphics_Driver::font() && size == driver->size_unscaled() && f && f->angle == angle)
     return;
   driver->Fl_Graphics_Driver::font(fnum, size);
-  Fl_Fontdesc *font = fl_fonts + fnum;
-  // search the fontsizes we have generated already
-  for (f = (Fl_Xlib_Font_Descriptor*)font->first; f; f = (Fl_Xlib_Font_Descriptor*)f->next) {
-    if (f->size == size && f->angle == angle)// && !strcasecmp(f->encoding, fl_encoding_))
-      break;
-  }
-  if (!f) {
-    f = new Fl_Xlib_Font_Descriptor(font->name, size, angle);
-    f->next = font->first;
-    font->first = f;
-  }
+  f = find_font_descriptor(fnum, size, angle);
   driver->font_descriptor(f);
 #if XFT_MAJOR < 2 && ! USE_PANGO
-  fl_xfont    = f->font->u.core.font;
+  fl_xfont    = xft_font(f)->u.core.font;
 #else
   fl_xfont    = NULL; // invalidate
 #endif // XFT_MAJOR < 2
 #if USE_PANGO
   fl_xftfont = NULL;
 #else
-  fl_xftfont = (void*)f->font;
+  fl_xftfont = (void*)xft_font(f);
 #endif
 }
 
+#if !USE_PANGO
+
+void Fl_Xlib_Graphics_Driver::preload_font(Fl_Font fnum, Fl_Fontsize size) {
+  static const char ascii[] = " !\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~";
+  fl_open_display();
+  XftFont *font = xft_font(find_font_descriptor(fnum, Fl_Fontsize(size * scale()), 0));
+  XGlyphInfo i;
+  XftTextExtents8(fl_display, font, (const FcChar8*)ascii, sizeof(ascii) - 1, &i); // loads the glyphs
+}
+
+void Fl_Xlib_Graphics_Driver::font_cache_size(int n) {
+  max_open_fonts = n;
+  close_fonts(NULL);
+}
+
+int Fl_Xlib_Graphics_Driver::font_cache_size() {
+  return max_open_fonts;
+}
+
+#endif // !USE_PANGO
+
 /* This code is used (mainly by opengl) to get a bitmapped font. The
  * original XFT-1 code used XFT's "core" fonts methods to load an XFT
  * font that was actually a X-bitmap font, that could then be readily
@@ -1141,8 +1250,8 @@ static XFontStruct* fl_xxfont(Fl_Graphics_Driver *driver) {
   }
   return xgl_font;
 #  else // XFT-1 provides a means to load a "core" font directly
-  if (driver->font_descriptor()->font->core) {
-    return driver->font_descriptor()->font->u.core.font; // is the current font a "core" font? If so, use it.
+  if (xft_font(driver->font_descriptor())->core) {
+    return xft_font(driver->font_descriptor())->u.core.font; // is the current font a "core" font? If so, use it.
   }
   static XftFont* xftfont;
   if (xftfont) XftFontClose (fl_display, xftfont);
@@ -1168,15 +1277,135 @@ PangoFontMap *Fl_Xlib_Graphics_Driver::pfmap_ = 0;
 PangoContext *Fl_Xlib_Graphics_Driver::pctxt_ = 0;
 PangoLayout *Fl_Xlib_Graphics_Driver::playout_ = 0;
 
+// Rotated text is drawn with its own context and layout: setting the
+// matrix of pctxt_ would make all cached layouts shape their text again.
+static PangoContext *rotated_ctxt = NULL;
+static PangoLayout *rotated_layout = NULL;
+
+// Cache of shaped text: one layout for each of the most recently measured
+// or drawn strings, fonts and sizes. Shaping a string is the most costly
+// part of pango text drawing, and widgets draw the same labels again and
+// again.
+#define FL_LAYOUT_CACHE_SLOTS 512     // must be a power of 2
+#define FL_LAYOUT_CACHE_SIZE 256      // number of cached layouts
+#define FL_LAYOUT_CACHE_TEXT_MAX 1024 // longer strings aren't cached
+
+struct Fl_Cached_Layout {
+  PangoLayout *layout;
+  char *text;
+  int n;
+  unsigned hash;
+  Fl_Font font;
+  Fl_Fontsize size;
+  Fl_Cached_Layout *hash_next, *lru_prev, *lru_next;
+};
+
+static Fl_Cached_Layout *layout_slots[FL_LAYOUT_CACHE_SLOTS];
+static Fl_Cached_Layout *layout_first = NULL, *layout_last = NULL; // most recently used first
+static int layout_count = 0;
+static unsigned long layout_hits = 0, layout_misses = 0;
+
+static void layout_unlink(Fl_Cached_Layout *e) {
+  if (e->lru_prev) e->lru_prev->lru_next = e->lru_next;
+  else layout_first = e->lru_next;
+  if (e->lru_next) e->lru_next->lru_prev = e->lru_prev;
+  else layout_last = e->lru_prev;
+}
+
+static void layout_push(Fl_Cached_Layout *e) {
+  e->lru_prev = NULL;
+  e->lru_next = layout_first;
+  if (layout_first) layout_first->lru_prev = e;
+  else layout_last = e;
+  layout_first = e;
+}
+
+// returns a layout holding str shaped with the current font
+PangoLayout *Fl_Xlib_Graphics_Driver::cached_layout(const char *str, int n) {
+  if (!playout_) context();
+  if (n > FL_LAYOUT_CACHE_TEXT_MAX) {
+    pango_layout_set_font_description(playout_, pfd_array[font_]);
+    pango_layout_set_text(playout_, str, n);
+    return playout_;
+  }
+  Fl_Fontsize size = size_unscaled();
+  unsigned h = 2166136261U; // FNV-1a
+  for (int i = 0; i < n; i++) h = (h ^ (uchar)str[i]) * 16777619U;
+  h = (h ^ (unsigned)font_) * 16777619U;
+  h = (h ^ (unsigned)size) * 16777619U;
+  Fl_Cached_Layout **slot = layout_slots + (h & (FL_LAYOUT_CACHE_SLOTS - 1)), *e;
+  for (e = *slot; e; e = e->hash_next) {
+    if (e->hash == h && e->font == font_ && e->size == size && e->n == n && !memcmp(e->text, str, n))
+      break;
+  }
+  if (e) {
+    layout_hits++;
+    if (e != layout_first) {
+      layout_unlink(e);
+      layout_push(e);
+    }
+    return e->layout;
+  }
+  layout_misses++;
+  if (layout_count >= FL_LAYOUT_CACHE_SIZE) { // reuse the least recently used layout
+    e = layout_last;
+    layout_unlink(e);
+    Fl_Cached_Layout **p = layout_slots + (e->hash & (FL_LAYOUT_CACHE_SLOTS - 1));
+    while (*p != e) p = &(*p)->hash_next;
+    *p = e->hash_next;
+    free(e->text);
+  } else {
+    e = new Fl_Cached_Layout;
+    e->layout = pango_layout_new(pctxt_);
+    layout_count++;
+  }
+  e->text = (char*)malloc(n + 1);
+  memcpy(e->text, str, n);
+  e->n = n;
+  e->hash = h;
+  e->font = font_;
+  e->size = size;
+  pango_layout_set_font_description(e->layout, pfd_array[font_]);
+  pango_layout_set_text(e->layout, e->text, n);
+  e->hash_next = *slot;
+  *slot = e;
+  layout_push(e);
+  return e->layout;
+}
+
+// forgets all cached layouts, e.g. when the font table changes
+void Fl_Xlib_Graphics_Driver::clear_layout_cache() {
+  Fl_Cached_Layout *e = layout_first;
+  while (e) {
+    Fl_Cached_Layout *next = e->lru_next;
+    g_object_unref(e->layout);
+    free(e->text);
+    delete e;
+    e = next;
+  }
+  layout_first = layout_last = NULL;
+  layout_count = 0;
+  memset(layout_slots, 0, sizeof(layout_slots));
+}
+
+int Fl_Xlib_Graphics_Driver::text_layout_cache_stats(unsigned long *hits, unsigned long *misses) {
+  if (hits) *hits = layout_hits;
+  if (misses) *misses = layout_misses;
+  return 1;
+}
+
 PangoContext *Fl_Xlib_Graphics_Driver::context() {
   if (fl_display && !pctxt_) {
     pfmap_ = pango_xft_get_font_map(fl_display, fl_screen); // 1.2
 #if PANGO_VERSION_CHECK(1,22,0)
     pctxt_ = pango_font_map_create_context(pfmap_); // 1.22
+    rotated_ctxt = pango_font_map_create_context(pfmap_); // 1.22
 #else
     pctxt_ = pango_xft_get_context(fl_display, fl_screen); // deprecated since 1.22
+    rotated_ctxt = pango_xft_get_context(fl_display, fl_screen); // deprecated since 1.22
 #endif
     playout_ = pango_layout_new(pctxt_);
+    rotated_layout = pango_layout_new(rotated_ctxt);
   }
   return pctxt_;
 }
@@ -1231,15 +1460,20 @@ void Fl_Xlib_Graphics_Driver::draw_unscaled(int angle, const char *str, int n, i
   PangoMatrix mat = PANGO_MATRIX_INIT; // 1.6
   pango_matrix_translate(&mat, x + floor(offset_x_), y + floor(offset_y_)); // 1.6
   double l = width_unscaled(str, n);
+  if (!playout_) context();
   pango_matrix_rotate(&mat, angle); // 1.6
-  pango_context_set_matrix(pctxt_, &mat); // 1.6
-  pango_layout_set_text(playout_, str, n);
+  pango_context_set_matrix(rotated_ctxt, &mat); // 1.6
+  pango_layout_context_changed(rotated_layout);
+  pango_layout_set_font_description(rotated_layout, pfd_array[font_]);
+  pango_layout_set_text(rotated_layout, str, n);
   int w, h;
-  pango_layout_get_pixel_size(playout_, &w, &h);
+  pango_layout_get_pixel_size(rotated_layout, &w, &h);
   pango_matrix_scale(&mat, l/w, l/w); // 1.6
-  pango_context_set_matrix(pctxt_, &mat); // 1.6
+  pango_context_set_matrix(rotated_ctxt, &mat); // 1.6
+  pango_layout_context_changed(rotated_layout);
   do_draw(0, str, n, 0, 0);
-  pango_context_set_matrix(pctxt_, NULL); // 1.6
+  pango_context_set_matrix(rotated_ctxt, NULL); // 1.6
+  pango_layout_context_changed(rotated_layout);
 }
 
 void Fl_Xlib_Graphics_Driver::rtl_draw_unscaled(const char* str, int n, int x, int y) {
@@ -1274,7 +1508,6 @@ void Fl_Xlib_Graphics_Driver::do_draw(int from_right, const char *str, int n, in
     if (--n == 0) return;
     tmpv = NULL;
   }
-  pango_layout_set_font_description(playout_, pfd_array[font_]);
   if (tmpv) { // replace newlines by spaces in a copy of str
     str2 = (char*)malloc(n);
     memcpy(str2, str, n);
@@ -1286,12 +1519,20 @@ void Fl_Xlib_Graphics_Driver::do_draw(int from_right, const char *str, int n, in
     while (tmpv);
     str = str2;
   }
-  const char *old = 0;
-  if (!str2) old = pango_layout_get_text(playout_);
-  if (!old || (int)strlen(old) != n || memcmp(str, old, n)) // do not re-set text if equal to text already in layout
-        pango_layout_set_text(playout_, str, n);
+  PangoLayout *layout;
+  if (pango_context_get_matrix(rotated_ctxt)) { // rotated text, see draw_unscaled(int angle, ...)
+    layout = rotated_layout;
+    pango_layout_set_font_description(layout, pfd_array[font_]);
+    const char *old = 0;
+    if (!str2) old = pango_layout_get_text(layout);
+    if (!old || (int)strlen(old) != n || memcmp(str, old, n)) // do not re-set text if equal to text already in layout
+          pango_layout_set_text(layout, str, n);
+  } else {
+    layout = cached_layout(str, n);
+  }
   if (str2) free(str2);
 
+  flush_batch();
   XftColor color;
   Fl_Color c = this->color();
   color.pixel = fl_xpixel(c);
@@ -1307,11 +1548,11 @@ void Fl_Xlib_Graphics_Driver::do_draw(int from_right, const char *str, int n, in
   XftDrawSetClip(draw_, region);
 
   int  dx, dy, w, h, y_correction, desc = descent_unscaled(), lheight = height_unscaled();
-  fl_pango_layout_get_pixel_extents(playout_, dx, dy, w, h, desc, lheight, y_correction);
+  fl_pango_layout_get_pixel_extents(layout, dx, dy, w, h, desc, lheight, y_correction);
   if (from_right) {
     x -= w;
   }
-  pango_xft_render_layout(draw_, &color, playout_, x * PANGO_SCALE,
+  pango_xft_render_layout(draw_, &color, layout, x * PANGO_SCALE,
                           (y - y_correction  - lheight + desc) * PANGO_SCALE ); // 1.8
   }
 
@@ -1356,20 +1597,14 @@ double Fl_Xlib_Graphics_Driver::width_unscaled(const char* str, int n) {
 double Fl_Xlib_Graphics_Driver::do_width_unscaled_(const char* str, int n) {
   if (!n) return 0;
   if (!fl_display || size_ == 0) return -1;
-  if (!playout_) context();
   int width, height;
-  pango_layout_set_font_description(playout_, pfd_array[font_]);
-  pango_layout_set_text(playout_, str, n);
-  pango_layout_get_pixel_size(playout_, &width, &height);
+  pango_layout_get_pixel_size(cached_layout(str, n), &width, &height);
   return (double)width;
 }
 
 void Fl_Xlib_Graphics_Driver::text_extents_unscaled(const char *str, int n, int &dx, int &dy, int &w, int &h) {
-  if (!playout_) context();
-  pango_layout_set_font_description(playout_, pfd_array[font_]);
-  pango_layout_set_text(playout_, str, n);
   int y_correction;
-  fl_pango_layout_get_pixel_extents(playout_, dx, dy, w, h, descent_unscaled(), height_unscaled(), y_correction);
+  fl_pango_layout_get_pixel_extents(cached_layout(str, n), dx, dy, w, h, descent_unscaled(), height_unscaled(), y_correction);
   dy -= y_correction;
   correct_extents(scale(), dx, dy, w, h);
 }
@@ -1432,6 +1667,17 @@ Fl_Font Fl_Xlib_Graphics_Driver::set_fonts(const char* pattern_name)
   /*g_*/free(families);
   // Sort the list into alphabetic order
   qsort(fl_fonts + FL_FREE_FONT, count, sizeof(Fl_Fontdesc), (sort_f_type)font_sort);
+  clear_layout_cache();
+  // the faces moved: hash their font descriptors again
+  memset(font_slots, 0, sizeof(font_slots));
+  for (int i = 0; i < FL_FREE_FONT + count; i++) {
+    for (Fl_Font_Descriptor *d = fl_fonts[i].first; d; d = d->next) {
+      Fl_Xlib_Font_Descriptor *f = (Fl_Xlib_Font_Descriptor*)d, **slot = font_slot(i, f->size, f->angle);
+      f->fnum = i;
+      f->hash_next = *slot;
+      *slot = f;
+    }
+  }
   return FL_FREE_FONT + count;
 }
 
@@ -1456,6 +1702,8 @@ int Fl_Xlib_Graphics_Driver::get_font_sizes(Fl_Font fnum, int*& sizep) {
 Fl_Xlib_Font_Descriptor::Fl_Xlib_Font_Descriptor(const char* name, Fl_Fontsize fsize, int fangle) : Fl_Font_Descriptor(name, fsize) {
   fl_open_display();
   angle = fangle;
+  fnum = 0;
+  hash_next = NULL;
   height_ = 0;
   descent_ = 0;
   width = NULL;
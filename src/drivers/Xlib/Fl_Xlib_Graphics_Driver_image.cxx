@@ -285,46 +285,12 @@ static void rrr_converter(const uchar *from, uchar *to, int w, int delta) {
 ////////////////////////////////////////////////////////////////
 // 32bit TrueColor converters on a 32 or 64-bit machine:
 
-#  ifdef U64
-#    define STORETYPE U64
-#    if WORDS_BIGENDIAN
-#      define INNARDS32(f) \
-  U64 *t = (U64*)to; \
-  int w1 = w/2; \
-  for (; w1--; from += delta) {U64 i = f; from += delta; *t++ = (i<<32)|(f);} \
-  if (w&1) *t++ = (U64)(f)<<32;
-#    else
-#      define INNARDS32(f) \
-  U64 *t = (U64*)to; \
-  int w1 = w/2; \
-  for (; w1--; from += delta) {U64 i = f; from += delta; *t++ = ((U64)(f)<<32)|i;} \
-  if (w&1) *t++ = (U64)(f);
-#    endif
-#  else
-#    define STORETYPE U32
-#    define INNARDS32(f) \
-  U32 *t = (U32*)to; for (; w--; from += delta) *t++ = f
-#  endif
+#include "Fl_Xlib_Image_Converters.H"
 
 static void rgbx_converter(const uchar *from, uchar *to, int w, int delta) {
   INNARDS32((unsigned(from[0])<<24)+(from[1]<<16)+(from[2]<<8));
 }
 
-static void xbgr_converter(const uchar *from, uchar *to, int w, int delta) {
-  INNARDS32((from[0])+(from[1]<<8)+(from[2]<<16));
-}
-
-static void xrgb_converter(const uchar *from, uchar *to, int w, int delta) {
-  INNARDS32((from[0]<<16)+(from[1]<<8)+(from[2]));
-}
-
-static void argb_premul_converter(const uchar *from, uchar *to, int w, int delta) {
-  INNARDS32((unsigned(from[3]) << 24) +
-             (((from[0] * from[3]) / 255) << 16) +
-             (((from[1] * from[3]) / 255) << 8) +
-             ((from[2] * from[3]) / 255));
-}
-
 static void depth2_to_argb_premul_converter(const uchar *from, uchar *to, int w, int delta) {
   INNARDS32((unsigned(from[1]) << 24) +
             (((from[0] * from[1]) / 255) << 16) +
@@ -340,10 +306,6 @@ static void rrrx_converter(const uchar *from, uchar *to, int w, int delta) {
   INNARDS32(unsigned(*from) * 0x1010100U);
 }
 
-static void xrrr_converter(const uchar *from, uchar *to, int w, int delta) {
-  INNARDS32(*from * 0x10101U);
-}
-
 static void
 color32_converter(const uchar *from, uchar *to, int w, int delta) {
   INNARDS32(
@@ -356,6 +318,22 @@ mono32_converter(const uchar *from,uchar *to,int w, int delta) {
     (*from << fl_redshift)+(*from << fl_greenshift)+(*from << fl_blueshift));
 }
 
+static void (*argb_premul)(const uchar *from, uchar *to, int w, int delta) = argb_premul_converter;
+
+// Replace the scalar converters chosen by figure_out_visual() by their
+// vectorized versions if the CPU has the required instruction set.
+static void use_simd_converters() {
+#  if FL_XLIB_SIMD_CONVERTERS
+  __builtin_cpu_init();
+  if (!__builtin_cpu_supports("sse2")) return;
+  argb_premul = argb_premul_converter_sse2;
+  if (mono_converter == xrrr_converter) mono_converter = xrrr_converter_sse2;
+  if (!__builtin_cpu_supports("ssse3")) return;
+  if (converter == xrgb_converter) converter = xrgb_converter_ssse3;
+  else if (converter == xbgr_converter) converter = xbgr_converter_ssse3;
+#  endif
+}
+
 ////////////////////////////////////////////////////////////////
 
 static void figure_out_visual() {
@@ -461,6 +439,7 @@ static void figure_out_visual() {
     Fl::fatal("Can't do %d bits_per_pixel",xi.bits_per_pixel);
   }
 
+  use_simd_converters();
 }
 
 #  define MAXBUFFER 0x40000 // 256k
@@ -471,6 +450,7 @@ static void innards(const uchar *buf, int X, int Y, int W, int H,
                     const bool alpha, GC gc)
 {
   if (!linedelta) linedelta = W*abs(delta);
+  Fl_Xlib_Graphics_Driver::flush_batch();
 
   int dx = 0, dy = 0, w = 0, h = 0;
   fl_clip_box(X, Y, W, H, dx, dy, w, h);
@@ -488,7 +468,7 @@ static void innards(const uchar *buf, int X, int Y, int W, int H,
   if (alpha) {
     // This flag states the destination format is ARGB32 (big-endian), pre-multiplied.
     bytes_per_pixel = 4;
-    conv = (mono ? depth2_to_argb_premul_converter : argb_premul_converter);
+    conv = (mono ? depth2_to_argb_premul_converter : argb_premul);
     xi.depth = 32;
     xi.bits_per_pixel = 32;
 
@@ -623,6 +603,7 @@ void Fl_Xlib_Graphics_Driver::delete_bitmask(Fl_Bitmask bm) {
 }
 
 void Fl_Xlib_Graphics_Driver::draw_fixed(Fl_Bitmap *bm, int X, int Y, int W, int H, int cx, int cy) {
+  flush_batch();
   X = floor(X)+floor(offset_x_);
   Y = floor(Y)+floor(offset_y_);
   cache_size(bm, W, H);
@@ -737,6 +718,7 @@ void Fl_Xlib_Graphics_Driver::cache(Fl_RGB_Image *img) {
 
 
 void Fl_Xlib_Graphics_Driver::draw_fixed(Fl_RGB_Image *img, int X, int Y, int W, int H, int cx, int cy) {
+  flush_batch();
   X = floor(X)+floor(offset_x_);
   Y = floor(Y)+floor(offset_y_);
   cache_size(img, W, H);
@@ -798,6 +780,7 @@ void Fl_Xlib_Graphics_Driver::draw_rgb(Fl_RGB_Image *rgb, int XP, int YP, int WP
  XP,YP,WP,HP are in drawing units
  */
 int Fl_Xlib_Graphics_Driver::scale_and_render_pixmap(Fl_Offscreen pixmap, int depth, double scale_x, double scale_y, int XP, int YP, int WP, int HP) {
+  flush_batch();
   bool has_alpha = (depth == 2 || depth == 4);
   XRenderPictureAttributes srcattr;
   memset(&srcattr, 0, sizeof(XRenderPictureAttributes));
@@ -844,6 +827,7 @@ int Fl_Xlib_Graphics_Driver::scale_and_render_pixmap(Fl_Offscreen pixmap, int de
 void Fl_Xlib_Graphics_Driver::uncache(Fl_RGB_Image*, fl_uintptr_t &id_, fl_uintptr_t &mask_)
 {
   if (id_) {
+    flush_batch();
     XFreePixmap(fl_display, (Fl_Offscreen)id_);
     id_ = 0;
   }
@@ -858,6 +842,7 @@ void Fl_Xlib_Graphics_Driver::cache(Fl_Bitmap *bm) {
 }
 
 void Fl_Xlib_Graphics_Driver::draw_fixed(Fl_Pixmap *pxm, int X, int Y, int W, int H, int cx, int cy) {
+  flush_batch();
   X = floor(X)+floor(offset_x_);
   Y = floor(Y)+floor(offset_y_);
   cache_size(pxm, W, H);
@@ -867,6 +852,7 @@ void Fl_Xlib_Graphics_Driver::draw_fixed(Fl_Pixmap *pxm, int X, int Y, int W, in
     // make X use the bitmap as a mask:
     XSetClipMask(fl_display, gc_, *Fl_Graphics_Driver::mask(pxm));
     XSetClipOrigin(fl_display, gc_, X-cx, Y-cy);
+    forget_clip();
     if (clip_region()) {
       // At this point, XYWH is the bounding box of the intersection between
       // the current clip region and the (portion of the) pixmap we have to draw.
@@ -924,5 +910,6 @@ void Fl_Xlib_Graphics_Driver::cache(Fl_Pixmap *pxm) {
 }
 
 void Fl_Xlib_Graphics_Driver::uncache_pixmap(fl_uintptr_t offscreen) {
+  flush_batch();
   XFreePixmap(fl_display, (Fl_Offscreen)offscreen);
 }
@@ -27,6 +27,7 @@
 #include <stdlib.h>
 
 void Fl_Xlib_Graphics_Driver::line_style_unscaled(int style, int width, char* dashes) {
+  flush_batch();
 
   int ndashes = dashes ? strlen(dashes) : 0;
   // emulate the Windows dash patterns on X
@@ -63,6 +64,7 @@ void Fl_Xlib_Graphics_Driver::line_style_unscaled(int style, int width, char* da
 }
 
 void *Fl_Xlib_Graphics_Driver::change_pen_width(int lwidth) {
+  flush_batch();
   XGCValues *gc_values = (XGCValues*)malloc(sizeof(XGCValues));
   gc_values->line_width = lwidth;
   XChangeGC(fl_display, gc_, GCLineWidth, gc_values);
@@ -72,6 +74,7 @@ void *Fl_Xlib_Graphics_Driver::change_pen_width(int lwidth) {
 }
 
 void Fl_Xlib_Graphics_Driver::reset_pen_width(void *data) {
+  flush_batch();
   XGCValues *gc_values = (XGCValues*)data;
   line_width_ = gc_values->line_width;
   XChangeGC(fl_display, gc_, GCLineWidth, gc_values);
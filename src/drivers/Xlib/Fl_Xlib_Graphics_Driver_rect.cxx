@@ -26,6 +26,8 @@
 #include <FL/platform.H>
 
 #include "Fl_Xlib_Graphics_Driver.H"
+#include <stdlib.h>
+#include <string.h>
 
 // Arbitrary line clipping: clip line end points to 16-bit coordinate range.
 
@@ -209,6 +211,7 @@ void Fl_Xlib_Graphics_Driver::XDestroyRegion(Fl_Region r) {
 // --- line and polygon drawing
 
 void Fl_Xlib_Graphics_Driver::focus_rect(int x, int y, int w, int h) {
+  flush_batch();
   w = this->floor(x + w) - this->floor(x);
   h = this->floor(y + h) - this->floor(y);
   x = this->floor(x) + floor(offset_x_);
@@ -230,8 +233,12 @@ void Fl_Xlib_Graphics_Driver::focus_rect(int x, int y, int w, int h) {
 void Fl_Xlib_Graphics_Driver::rectf_unscaled(int x, int y, int w, int h) {
   x += floor(offset_x_);
   y += floor(offset_y_);
-  if (!clip_rect(x, y, w, h))
-    XFillRectangle(fl_display, fl_window, gc_, x, y, w, h);
+  if (!clip_rect(x, y, w, h)) {
+    batch_target();
+    if (batch_nrects_ == FL_XLIB_GRAPHICS_BATCH_SIZE) flush_batch_();
+    XRectangle *r = batch_rects_ + batch_nrects_++;
+    r->x = x; r->y = y; r->width = w; r->height = h;
+  }
 }
 
 void Fl_Xlib_Graphics_Driver::line_unscaled(int x, int y, int x1, int y1) {
@@ -256,6 +263,7 @@ void Fl_Xlib_Graphics_Driver::yxline_unscaled(int x, int y, int y1) {
 }
 
 void Fl_Xlib_Graphics_Driver::loop_unscaled(int x, int y, int x1, int y1, int x2, int y2) {
+  flush_batch();
   XPoint p[4];
   p[0].x = x + floor(offset_x_) ;  p[0].y = y + floor(offset_y_) ;
   p[1].x = x1 + floor(offset_x_) ; p[1].y = y1 + floor(offset_y_) ;
@@ -266,6 +274,7 @@ void Fl_Xlib_Graphics_Driver::loop_unscaled(int x, int y, int x1, int y1, int x2
 }
 
 void Fl_Xlib_Graphics_Driver::loop_unscaled(int x, int y, int x1, int y1, int x2, int y2, int x3, int y3) {
+  flush_batch();
   XPoint p[5];
   p[0].x = x + floor(offset_x_) ;  p[0].y = y + floor(offset_y_) ;
   p[1].x = x1 + floor(offset_x_) ; p[1].y = y1 + floor(offset_y_) ;
@@ -277,6 +286,7 @@ void Fl_Xlib_Graphics_Driver::loop_unscaled(int x, int y, int x1, int y1, int x2
 }
 
 void Fl_Xlib_Graphics_Driver::polygon_unscaled(int x, int y, int x1, int y1, int x2, int y2) {
+  flush_batch();
   XPoint p[4];
   p[0].x = x + floor(offset_x_) ;  p[0].y = y + floor(offset_y_) ;
   p[1].x = x1 + floor(offset_x_) ; p[1].y = y1 + floor(offset_y_) ;
@@ -288,6 +298,7 @@ void Fl_Xlib_Graphics_Driver::polygon_unscaled(int x, int y, int x1, int y1, int
 }
 
 void Fl_Xlib_Graphics_Driver::polygon_unscaled(int x, int y, int x1, int y1, int x2, int y2, int x3, int y3) {
+  flush_batch();
   XPoint p[5];
   p[0].x = x + floor(offset_x_) ;  p[0].y = y + floor(offset_y_) ;
   p[1].x = x1 + floor(offset_x_) ; p[1].y = y1 + floor(offset_y_) ;
@@ -305,17 +316,105 @@ void Fl_Xlib_Graphics_Driver::polygon_unscaled(int x, int y, int x1, int y1, int
 // This draws nothing if the line is entirely outside the X coordinate space.
 
 void Fl_Xlib_Graphics_Driver::draw_clipped_line(int x1, int y1, int x2, int y2) {
-  if (!clip_line(x1, y1, x2, y2))
-    XDrawLine(fl_display, fl_window, gc_, x1, y1, x2, y2);
+  if (!clip_line(x1, y1, x2, y2)) {
+    batch_target();
+    if (batch_nsegments_ == FL_XLIB_GRAPHICS_BATCH_SIZE) flush_batch_();
+    XSegment *s = batch_segments_ + batch_nsegments_++;
+    s->x1 = x1; s->y1 = y1; s->x2 = x2; s->y2 = y2;
+  }
+}
+
+// --- batching of filled rectangles and lines
+
+/*
+  A widget like Fl_Table or Fl_Tree draws thousands of filled rectangles
+  and horizontal or vertical lines, often many of them in a row with the
+  same color. Instead of an X request for each of them, rectf_unscaled()
+  and draw_clipped_line() add them to a batch that is sent with one
+  XFillRectangles() and one XDrawSegments() request when
+
+  - the color, line style or clip region changes,
+  - another primitive, an image or text is drawn,
+  - the drawing goes to another window or GC,
+  - gc() is called, e.g. by code that uses Xlib calls directly,
+  - the screen driver flushes the display (Fl::flush()), or
+  - the batch is full.
+
+  All primitives of a batch are drawn with the same GC state, so the order
+  of rectangles and lines in the batch doesn't change the result.
+*/
+
+XRectangle Fl_Xlib_Graphics_Driver::batch_rects_[FL_XLIB_GRAPHICS_BATCH_SIZE];
+XSegment Fl_Xlib_Graphics_Driver::batch_segments_[FL_XLIB_GRAPHICS_BATCH_SIZE];
+int Fl_Xlib_Graphics_Driver::batch_nrects_ = 0;
+int Fl_Xlib_Graphics_Driver::batch_nsegments_ = 0;
+Window Fl_Xlib_Graphics_Driver::batch_window_ = 0;
+GC Fl_Xlib_Graphics_Driver::batch_gc_ = 0;
+unsigned long Fl_Xlib_Graphics_Driver::batch_pixel_ = 0;
+
+void Fl_Xlib_Graphics_Driver::flush_batch_() {
+  if (batch_nrects_)
+    XFillRectangles(fl_display, batch_window_, batch_gc_, batch_rects_, batch_nrects_);
+  if (batch_nsegments_)
+    XDrawSegments(fl_display, batch_window_, batch_gc_, batch_segments_, batch_nsegments_);
+  batch_nrects_ = batch_nsegments_ = 0;
 }
 
 // --- clipping
 
+/*
+  X11 regions are sorted lists of rectangles kept by Xlib on the client
+  side. Most clip regions are a single rectangle, though: push_clip(),
+  clip_box() and not_clipped() compute the result directly from the
+  region's bounding box then, and reject rectangles outside of it without
+  calling Xlib. The clip of gc_ is sent to the X server again only when it
+  differs from the last one sent, which is often not the case because
+  groups push the same clip as their parent, and pop_clip() goes back
+  to the clip of the parent.
+*/
+
+BOX *Fl_Xlib_Graphics_Driver::clip_boxes_ = 0;
+int Fl_Xlib_Graphics_Driver::clip_nboxes_ = -1; // -1: unknown, -2: no clip
+int Fl_Xlib_Graphics_Driver::clip_alloc_ = 0;
+
+// Returns 1 if the clip of gc_ is region r, otherwise stores r as the
+// new clip of gc_ and returns 0.
+int Fl_Xlib_Graphics_Driver::clip_sent(Region r) {
+  int n = (int)r->numRects;
+  if (n == clip_nboxes_ && (n == 0 || !memcmp(r->rects, clip_boxes_, n * sizeof(BOX))))
+    return 1;
+  if (n > clip_alloc_) {
+    clip_alloc_ = n + 16;
+    clip_boxes_ = (BOX*)realloc(clip_boxes_, clip_alloc_ * sizeof(BOX));
+  }
+  if (n) memcpy(clip_boxes_, r->rects, n * sizeof(BOX));
+  clip_nboxes_ = n;
+  return 0;
+}
+
+// Same results as XRectInRegion(): 0 if the rectangle is outside region r,
+// 1 if inside, 2 if partially inside.
+static inline int rect_in_region(Region r, int x, int y, int w, int h) {
+  const BOX &e = r->extents;
+  if (r->numRects == 0 || x + w <= e.x1 || x >= e.x2 || y + h <= e.y1 || y >= e.y2)
+    return 0;
+  if (r->numRects == 1)
+    return (x >= e.x1 && y >= e.y1 && x + w <= e.x2 && y + h <= e.y2) ? 1 : 2;
+  return XRectInRegion(r, x, y, w, h);
+}
+
 void Fl_Xlib_Graphics_Driver::push_clip(int x, int y, int w, int h) {
   Fl_Region r;
-  if (w > 0 && h > 0) {
+  Fl_Region current = rstack[rstackptr];
+  if (w > 0 && h > 0 && current && current->numRects <= 1) {
+    // intersection of two rectangles
+    const BOX &e = current->extents;
+    int X = x > e.x1 ? x : e.x1, Y = y > e.y1 ? y : e.y1;
+    int R = x + w < e.x2 ? x + w : e.x2, B = y + h < e.y2 ? y + h : e.y2;
+    if (current->numRects == 1 && R > X && B > Y) r = XRectangleRegion(X, Y, R - X, B - Y);
+    else r = XCreateRegion();
+  } else if (w > 0 && h > 0) {
     r = XRectangleRegion(x, y, w, h); // does X coordinate clipping
-    Fl_Region current = rstack[rstackptr];
     if (current) {
       Fl_Region temp = XCreateRegion();
       XIntersectRegion(current, r, temp);
@@ -343,7 +442,7 @@ int Fl_Xlib_Graphics_Driver::clip_box(int x, int y, int w, int h, int& X, int& Y
       return 1; // partially outside, region differs
     return 0;
   }
-  switch (XRectInRegion(r, X, Y, W, H)) {
+  switch (rect_in_region(r, X, Y, W, H)) {
     case 0: // completely outside
       W = H = 0;
       return 2;
@@ -352,6 +451,14 @@ int Fl_Xlib_Graphics_Driver::clip_box(int x, int y, int w, int h, int& X, int& Y
     default: // partial:
       break;
   }
+  if (r->numRects == 1) {
+    const BOX &e = r->extents;
+    int R = X + W < e.x2 ? X + W : e.x2, B = Y + H < e.y2 ? Y + H : e.y2;
+    if (X < e.x1) X = e.x1;
+    if (Y < e.y1) Y = e.y1;
+    W = R - X; H = B - Y;
+    return 1;
+  }
   Fl_Region rr = XRectangleRegion(X, Y, W, H);
   Fl_Region temp = XCreateRegion();
   XIntersectRegion(r, rr, temp);
@@ -369,7 +476,7 @@ int Fl_Xlib_Graphics_Driver::not_clipped(int x, int y, int w, int h) {
   if (!r) return 1;
   // get rid of coordinates outside the 16-bit range the X calls take.
   if (clip_rect(x,y,w,h)) return 0;     // clipped
-  return XRectInRegion(r, x, y, w, h);
+  return rect_in_region(r, x, y, w, h);
 }
 
 void Fl_Xlib_Graphics_Driver::restore_clip() {
@@ -378,9 +485,16 @@ void Fl_Xlib_Graphics_Driver::restore_clip() {
     Region r = rstack[rstackptr];
     if (r) {
       Region r2 = scale_clip(scale());
-      XSetRegion(fl_display, gc_, rstack[rstackptr]);
+      if (!clip_sent(rstack[rstackptr])) {
+        flush_batch();
+        XSetRegion(fl_display, gc_, rstack[rstackptr]);
+      }
       unscale_clip(r2);
     }
-    else XSetClipMask(fl_display, gc_, 0);
+    else if (clip_nboxes_ != -2) {
+      flush_batch();
+      XSetClipMask(fl_display, gc_, 0);
+      clip_nboxes_ = -2;
+    }
   }
 }
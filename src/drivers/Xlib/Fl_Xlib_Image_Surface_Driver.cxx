@@ -51,6 +51,7 @@ Fl_Xlib_Image_Surface_Driver::Fl_Xlib_Image_Surface_Driver(int w, int h, int hig
 }
 
 Fl_Xlib_Image_Surface_Driver::~Fl_Xlib_Image_Surface_Driver() {
+  Fl_Xlib_Graphics_Driver::flush_batch();
   if (offscreen && !external_offscreen) XFreePixmap(fl_display, offscreen);
   delete driver();
 }
@@ -45,6 +45,7 @@
     \param[in] s the string to check for a match
     \param[in] p the string pattern
     \return non zero if the string matches the pattern
+    \see Fl_Filename_Matcher, which is faster to match many strings against one pattern
 */
 int fl_filename_match(const char *s, const char *p) {
   int matched;
@@ -118,3 +119,406 @@ int fl_filename_match(const char *s, const char *p) {
     }
   }
 }
+
+
+//
+// Fl_Filename_Matcher...
+//
+// A pattern is translated into an automaton with one state per pattern
+// position: the state of position i does what fl_filename_match() does
+// when it is called with pattern + i.  A state consumes a set of bytes
+// and goes on with its next state, and it may have epsilon transitions
+// to the states that fl_filename_match() tries without consuming a byte
+// (the repetition of '*', the alternatives of '{', and the skips of '|'
+// and '}').  Every position gets its own state, because the alternatives
+// of '{' are found without regard to sets and may start in one.  The
+// state at the end of the pattern accepts.
+//
+// match() follows the sets of states the automaton can be in.  Each set
+// becomes a state of a deterministic automaton whose transitions are
+// cached, so after a few strings every byte costs one table lookup.
+//
+
+#include <FL/Fl_Filename_Matcher.H>
+#include <FL/fl_string.h>   // fl_strdup()
+#include <stdlib.h>
+#include <string.h>
+
+struct Fl_Filename_State {
+  unsigned char set[32];    // bytes consumed by the state
+  int next;                 // state after a byte of set, or -1
+  int eps;                  // index of first epsilon transition
+  int neps;                 // number of epsilon transitions
+};
+
+struct Fl_Filename_Program {
+  enum { ALL, EXTENSIONS, AUTOMATON };
+  int kind;
+
+  // EXTENSIONS: hash table of the lowercase extensions
+  int num_slots;            // power of two
+  char **slots;             // extensions or NULL
+  char *text;               // storage for the extensions
+  char *text_end;           // end of the stored extensions
+
+  // AUTOMATON: states of the pattern positions...
+  int num_states;
+  Fl_Filename_State *states;
+  int *eps;                 // targets of epsilon transitions
+  int words;                // words of a set of states
+
+  // ... and the cached deterministic states, sets of the states above
+  int num_dfa;
+  unsigned *dfa_sets;
+  int *dfa_next;            // 256 transitions per state, -1 if unknown
+  char *dfa_flags;          // DFA_ACCEPT, DFA_DEAD
+  unsigned *work;           // set being built
+  int *stack;               // for epsilon closures
+};
+
+enum { DFA_ACCEPT = 1, DFA_DEAD = 2 };
+static const int DFA_MAX = 64;  // deterministic states kept in the cache
+
+// Hash of the lowercase version of the first len characters of s,
+// also used by the extension index of Fl_File_Icon.
+unsigned fl_filename_ext_hash(const char *s, int len) {
+  unsigned h = 2166136261U;
+  while (len-- > 0) h = (h ^ (unsigned char)tolower((unsigned char)*s++)) * 16777619U;
+  return h;
+}
+
+// Returns the length of an extension of a "*.ext" or "*.{ext|...}"
+// pattern, which ends with one of the characters in end, or 0 if it
+// contains a special character or is empty.
+static int ext_length(const char *p, const char *end) {
+  int len;
+  for (len = 0; p[len] && !strchr(end, p[len]); len++)
+    if (strchr("*?[]{}|,\\/.", p[len])) return 0;
+  if (end[0] && !p[len]) return 0;
+  return len;
+}
+
+// Calls f(ext, len, data) for each extension of a "*.ext" or
+// "*.{ext1|ext2|...}" pattern and returns 1, or returns 0 without
+// calling f if the pattern has another form.  In these patterns '*'
+// can match anything up to the last '.', because the extensions don't
+// contain one.  Fl_File_Icon builds its extension index with this.
+int fl_filename_pattern_exts(const char *p,
+                             void (*f)(const char *ext, int len, void *data),
+                             void *data) {
+  const char *q;
+  int len;
+  if (p[0] != '*' || p[1] != '.') return 0;
+  p += 2;
+  if (*p != '{') {
+    if (!(len = ext_length(p, ""))) return 0;
+    if (f) f(p, len, data);
+    return 1;
+  }
+  // check the whole list before reporting anything
+  for (q = p + 1;; q += len + 1) {
+    if (!(len = ext_length(q, "|,}"))) return 0;
+    if (q[len] == '}') break;
+  }
+  if (q[len + 1]) return 0;
+  if (f)
+    for (q = p + 1;; q += len + 1) {
+      len = ext_length(q, "|,}");
+      f(q, len, data);
+      if (q[len] == '}') break;
+    }
+  return 1;
+}
+
+// Callbacks of fl_filename_pattern_exts() for compile_extensions()
+static void count_ext(const char *, int len, void *data) {
+  int *count = (int *)data;
+  count[0]++;
+  count[1] += len + 1;
+}
+
+static void add_ext(const char *ext, int len, void *data) {
+  Fl_Filename_Program *prog = (Fl_Filename_Program *)data;
+  char *t = prog->text_end;
+  unsigned h = fl_filename_ext_hash(ext, len);
+  for (int i = 0; i < len; i++) t[i] = (char)tolower((unsigned char)ext[i]);
+  t[len] = 0;
+  while (prog->slots[h & (prog->num_slots - 1)]) h++;
+  prog->slots[h & (prog->num_slots - 1)] = t;
+  prog->text_end = t + len + 1;
+}
+
+// Fills the extension table of prog if p is "*.ext" or "*.{ext|...}".
+static int compile_extensions(Fl_Filename_Program *prog, const char *p) {
+  int count[2] = { 0, 0 };  // extensions, characters
+  if (!fl_filename_pattern_exts(p, count_ext, count)) return 0;
+  prog->kind = Fl_Filename_Program::EXTENSIONS;
+  for (prog->num_slots = 4; prog->num_slots < 2 * count[0]; prog->num_slots *= 2) {/*empty*/}
+  prog->slots = (char **)calloc(prog->num_slots, sizeof(char *));
+  prog->text = prog->text_end = (char *)malloc(count[1]);
+  fl_filename_pattern_exts(p, add_ext, prog);
+  return 1;
+}
+
+// Returns 1 if c is in the set at p, which follows "[", "[^" or "[!",
+// and sets *end to the position after the closing ']' or to the end of
+// the pattern.  Same loop as in fl_filename_match().
+static int set_member(const char *p, char c, const char **end) {
+  int matched = 0;
+  char last = 0;
+  while (*p) {
+    if (*p == '-' && last) {
+      if (!p[1]) { p++; break; }
+      ++p;
+      if (c <= *p && c >= last) matched = 1;
+    } else {
+      if (c == *p) matched = 1;
+    }
+    last = *p++;
+    if (*p == ']') { p++; break; }
+  }
+  *end = p;
+  return matched;
+}
+
+static void compile_automaton(Fl_Filename_Program *prog, const char *pattern) {
+  int len = (int)strlen(pattern);
+  int i, c, num_eps = 0, max_eps = len + 1;
+  const char *p, *end;
+  prog->kind = Fl_Filename_Program::AUTOMATON;
+  prog->num_states = len + 1;
+  prog->states = (Fl_Filename_State *)calloc(len + 1, sizeof(Fl_Filename_State));
+  prog->eps = (int *)malloc(max_eps * sizeof(int));
+  for (i = 0; i <= len; i++) {
+    Fl_Filename_State *st = prog->states + i;
+    int first_eps = num_eps;
+    st->next = -1;
+    p = pattern + i;
+    switch (*p) {
+      case '?' : // any byte
+        for (c = 1; c < 256; c++) st->set[c >> 3] |= 1 << (c & 7);
+        st->next = i + 1;
+        break;
+      case '*' : // any byte and stay, or go on
+        for (c = 1; c < 256; c++) st->set[c >> 3] |= 1 << (c & 7);
+        st->next = i;
+        prog->eps[num_eps++] = i + 1;
+        break;
+      case '[' : { // a byte of the set, an unterminated set ends the pattern
+        int reverse = (p[1] == '^' || p[1] == '!');
+        for (c = 1; c < 256; c++)
+          if (set_member(p + 1 + reverse, (char)c, &end) != reverse)
+            st->set[c >> 3] |= 1 << (c & 7);
+        set_member(p + 1 + reverse, 0, &end);
+        st->next = (int)(end - pattern);
+        break;
+      }
+      case '{' : { // each alternative, found as in fl_filename_match()
+        int matched = 0;
+        prog->eps[num_eps++] = i + 1;
+        for (p++;;) {
+          char ch = *p++;
+          if (ch == '\\') { if (*p) p++; }
+          else if (ch == '{') matched++;
+          else if (ch == '}') { if (!matched--) break; }
+          else if (ch == '|' || ch == ',') {
+            if (matched) break;
+            if (num_eps == max_eps) prog->eps = (int *)realloc(prog->eps, (max_eps *= 2) * sizeof(int));
+            prog->eps[num_eps++] = (int)(p - pattern);
+          }
+          else if (!ch) break;
+        }
+        break;
+      }
+      case '|' : // end of an alternative, skip the others
+      case ',' : {
+        int matched = 0;
+        for (p++; *p && matched >= 0;) {
+          char ch = *p++;
+          if (ch == '\\') { if (*p) p++; }
+          else if (ch == '{') matched++;
+          else if (ch == '}') matched--;
+        }
+        prog->eps[num_eps++] = (int)(p - pattern);
+        break;
+      }
+      case '}' :
+        prog->eps[num_eps++] = i + 1;
+        break;
+      case 0 : // end of pattern, accepts
+        break;
+      default : { // the quoted or the plain character, ignoring case
+        int n = 1;
+        if (*p == '\\' && p[1]) { p++; n = 2; }
+        int lc = tolower((unsigned char)*p);
+        for (c = 1; c < 256; c++)
+          if (tolower(c) == lc) st->set[c >> 3] |= 1 << (c & 7);
+        st->next = i + n;
+        break;
+      }
+    }
+    if (num_eps == max_eps) prog->eps = (int *)realloc(prog->eps, (max_eps *= 2) * sizeof(int));
+    st->eps = first_eps;
+    st->neps = num_eps - first_eps;
+  }
+  prog->words     = (len + 1 + 31) / 32;
+  prog->num_dfa   = 0;
+  prog->dfa_sets  = (unsigned *)malloc(DFA_MAX * prog->words * sizeof(unsigned));
+  prog->dfa_next  = (int *)malloc(DFA_MAX * 256 * sizeof(int));
+  prog->dfa_flags = (char *)malloc(DFA_MAX);
+  prog->work      = (unsigned *)malloc(prog->words * sizeof(unsigned));
+  prog->stack     = (int *)malloc((len + 1) * sizeof(int));
+}
+
+// Adds state s and the states reachable by epsilon transitions to set.
+static void add_closure(Fl_Filename_Program *prog, unsigned *set, int s) {
+  int n = 0;
+  if (set[s >> 5] & (1U << (s & 31))) return;
+  set[s >> 5] |= 1U << (s & 31);
+  prog->stack[n++] = s;
+  while (n > 0) {
+    Fl_Filename_State *st = prog->states + prog->stack[--n];
+    for (int e = 0; e < st->neps; e++) {
+      int t = prog->eps[st->eps + e];
+      if (set[t >> 5] & (1U << (t & 31))) continue;
+      set[t >> 5] |= 1U << (t & 31);
+      prog->stack[n++] = t;
+    }
+  }
+}
+
+// Returns the deterministic state of prog->work, adding it if needed.
+// When the cache is full it starts over with the start state.
+static int dfa_state(Fl_Filename_Program *prog) {
+  int i, words = prog->words;
+  size_t bytes = words * sizeof(unsigned);
+  for (i = 0; i < prog->num_dfa; i++)
+    if (!memcmp(prog->dfa_sets + i * words, prog->work, bytes)) return i;
+  if (prog->num_dfa == DFA_MAX) {
+    unsigned *set = prog->dfa_sets;
+    memset(set, 0, bytes);
+    add_closure(prog, set, 0);
+    prog->dfa_flags[0] = (set[(prog->num_states - 1) >> 5] & (1U << ((prog->num_states - 1) & 31))) ? DFA_ACCEPT : 0;
+    for (i = 0; i < 256; i++) prog->dfa_next[i] = -1;
+    prog->num_dfa = 1;
+    if (!memcmp(set, prog->work, bytes)) return 0;
+  }
+  i = prog->num_dfa++;
+  memcpy(prog->dfa_sets + i * words, prog->work, bytes);
+  int last = prog->num_states - 1, dead = 1;
+  for (int w = 0; w < words; w++) if (prog->work[w]) dead = 0;
+  prog->dfa_flags[i] = dead ? DFA_DEAD :
+                       (prog->work[last >> 5] & (1U << (last & 31))) ? DFA_ACCEPT : 0;
+  for (int c = 0; c < 256; c++) prog->dfa_next[i * 256 + c] = -1;
+  return i;
+}
+
+// Computes the transition of deterministic state d on byte c.
+static int dfa_step(Fl_Filename_Program *prog, int d, unsigned char c) {
+  int words = prog->words, num_dfa = prog->num_dfa;
+  const unsigned *set = prog->dfa_sets + d * words;
+  memset(prog->work, 0, words * sizeof(unsigned));
+  for (int s = 0; s < prog->num_states; s++) {
+    if (!(set[s >> 5] & (1U << (s & 31)))) continue;
+    Fl_Filename_State *st = prog->states + s;
+    if (st->next >= 0 && (st->set[c >> 3] & (1 << (c & 7))))
+      add_closure(prog, prog->work, st->next);
+  }
+  int n = dfa_state(prog);
+  if (prog->num_dfa >= num_dfa) // d is still valid unless the cache was reset
+    prog->dfa_next[d * 256 + c] = n;
+  return n;
+}
+
+static void free_program(Fl_Filename_Program *prog) {
+  if (!prog) return;
+  free(prog->slots);
+  free(prog->text);
+  free(prog->states);
+  free(prog->eps);
+  free(prog->dfa_sets);
+  free(prog->dfa_next);
+  free(prog->dfa_flags);
+  free(prog->work);
+  free(prog->stack);
+  free(prog);
+}
+
+/**
+ Creates a matcher for a fl_filename_match() pattern.
+ \param[in] pattern the pattern, or NULL to set it later with pattern(const char*)
+ */
+Fl_Filename_Matcher::Fl_Filename_Matcher(const char *pattern) {
+  pattern_ = 0;
+  program_ = 0;
+  this->pattern(pattern);
+}
+
+/** Destroys the matcher. */
+Fl_Filename_Matcher::~Fl_Filename_Matcher() {
+  free_program(program_);
+  free(pattern_);
+}
+
+/**
+ Sets the pattern of the matcher.
+ The pattern is copied and translated. Setting the pattern that is
+ already set keeps the cached automaton of the matcher.
+ \param[in] pattern the pattern, or NULL to remove it
+ */
+void Fl_Filename_Matcher::pattern(const char *pattern) {
+  if (pattern && pattern_ && !strcmp(pattern, pattern_)) return;
+  free_program(program_);
+  free(pattern_);
+  program_ = 0;
+  pattern_ = 0;
+  if (!pattern) return;
+  pattern_ = fl_strdup(pattern);
+  program_ = (Fl_Filename_Program *)calloc(1, sizeof(Fl_Filename_Program));
+  if (!strcmp(pattern, "*"))
+    program_->kind = Fl_Filename_Program::ALL;
+  else if (!compile_extensions(program_, pattern))
+    compile_automaton(program_, pattern);
+}
+
+/**
+ Checks if a string matches the pattern of the matcher.
+ \param[in] name the string to check for a match
+ \return non zero if \p name matches, as fl_filename_match(name, pattern())
+   would return, and 0 if no pattern is set
+ */
+int Fl_Filename_Matcher::match(const char *name) {
+  Fl_Filename_Program *prog = program_;
+  if (!prog) return 0;
+  switch (prog->kind) {
+    case Fl_Filename_Program::ALL :
+      return 1;
+    case Fl_Filename_Program::EXTENSIONS : {
+      const char *ext = strrchr(name, '.');
+      if (!ext || !*++ext) return 0;
+      int len = (int)strlen(ext);
+      unsigned h = fl_filename_ext_hash(ext, len);
+      for (;; h++) {
+        const char *t = prog->slots[h & (prog->num_slots - 1)];
+        if (!t) return 0;
+        int i;
+        for (i = 0; i < len && tolower((unsigned char)ext[i]) == (unsigned char)t[i]; i++) {/*empty*/}
+        if (i == len && !t[len]) return 1;
+      }
+    }
+    default : {
+      if (prog->num_dfa == 0) {
+        memset(prog->work, 0, prog->words * sizeof(unsigned));
+        add_closure(prog, prog->work, 0);
+        dfa_state(prog);
+      }
+      int d = 0;
+      for (const unsigned char *s = (const unsigned char *)name; *s; s++) {
+        int n = prog->dfa_next[d * 256 + *s];
+        d = n >= 0 ? n : dfa_step(prog, d, *s);
+        if (prog->dfa_flags[d] == DFA_DEAD) return 0;
+      }
+      return prog->dfa_flags[d] == DFA_ACCEPT;
+    }
+  }
+}
@@ -25,6 +25,8 @@
 
 #include <FL/Fl.H>
 #include <FL/Fl_Widget.H>
+#include <FL/Fl_Image_Surface.H>
+#include <FL/Fl_Graphics_Driver.H>
 #include <FL/fl_draw.H>
 #include <config.h>
 
@@ -409,6 +411,168 @@ void fl_internal_boxtype(Fl_Boxtype t, Fl_Box_Draw_F* f) {
   }
 }
 
+/**
+  Returns whether a box type fills its inside with the box color only.
+  The inside is the area within Fl::box_dx(), Fl::box_dy() etc. of the
+  box. Widgets can scroll their contents there by copying pixels, see
+  fl_scroll_by_copy(). Box types of the "plastic" and "gleam" schemes,
+  frames, round boxes and user defined box types return 0.
+  \param[in] t box type
+*/
+int fl_box_flat_inside(Fl_Boxtype t) {
+  if (!fl_box_table[t].set) return 0;
+  Fl_Box_Draw_F *f = fl_box_table[t].f;
+  return f == fl_flat_box || f == fl_up_box || f == fl_down_box ||
+         f == fl_thin_up_box || f == fl_thin_down_box ||
+         f == fl_engraved_box || f == fl_embossed_box || f == fl_border_box;
+}
+
+////////////////////////////////////////////////////////////////
+// Cache of rendered box backgrounds
+
+// The shaded backgrounds of the "plastic", "gleam" and "gtk+" box types
+// are drawn with one line per pixel row, which is slow when many boxes
+// are drawn, particularly on remote displays. fl_cached_box() renders
+// such a background once into an offscreen buffer, and then copies it.
+//
+// Cache entries are found by a hash of the drawing function, the size,
+// the color, the active state and the scale factor. They are kept in a
+// list ordered by the time they were last used, and the least recently
+// used entry is deleted when the cache is full.
+
+#define FL_BOX_CACHE_HASH 64
+
+struct Fl_Box_Cache_Entry {
+  Fl_Box_Draw_F *f;
+  int w, h;
+  Fl_Color c;
+  int active;
+  float scale;
+  Fl_Image_Surface *surf;
+  Fl_Box_Cache_Entry *hnext;            // next entry with the same hash
+  Fl_Box_Cache_Entry *prev, *next;      // LRU list, most recently used first
+};
+
+static Fl_Box_Cache_Entry *box_cache_hash[FL_BOX_CACHE_HASH];
+static Fl_Box_Cache_Entry *box_cache_first, *box_cache_last;
+static int box_cache_count = 0;
+static int box_cache_max = 100;
+
+static unsigned box_cache_key(Fl_Box_Draw_F *f, int w, int h, Fl_Color c) {
+  unsigned k = (unsigned)((size_t)f >> 4);
+  k = k * 31 + w;
+  k = k * 31 + h;
+  k = k * 31 + c;
+  return k % FL_BOX_CACHE_HASH;
+}
+
+static void box_cache_unlink(Fl_Box_Cache_Entry *e) {
+  if (e->prev) e->prev->next = e->next; else box_cache_first = e->next;
+  if (e->next) e->next->prev = e->prev; else box_cache_last = e->prev;
+}
+
+static void box_cache_delete(Fl_Box_Cache_Entry *e) {
+  Fl_Box_Cache_Entry **p = box_cache_hash + box_cache_key(e->f, e->w, e->h, e->c);
+  while (*p != e) p = &(*p)->hnext;
+  *p = e->hnext;
+  box_cache_unlink(e);
+  delete e->surf;
+  delete e;
+  box_cache_count--;
+}
+
+/**
+  Draws the background of a box with \p f, or copies it from the box cache.
+
+  The box drawing function \p f must draw all pixels of the \p n
+  rectangles \p rects (given as x, y, w, h relative to \p x, \p y) and
+  nothing outside of them, and its output must only depend on the size
+  of the box, its color and Fl::draw_box_active(). Only these rectangles
+  are copied from the cache, so that pixels inside the box that \p f
+  leaves untouched keep the color of the parent widget.
+
+  The cache is used only when drawing to the display at an integral
+  scale factor, and for boxes smaller than 64k pixels. Otherwise the
+  box is drawn by \p f directly.
+*/
+void fl_cached_box(Fl_Box_Draw_F *f, int x, int y, int w, int h, Fl_Color c,
+                   int n, const int *rects) {
+  float s = fl_graphics_driver->scale();
+  if (box_cache_max <= 0 || w <= 0 || h <= 0 || w * h > 0x10000 || s != int(s) ||
+      Fl_Surface_Device::surface() != Fl_Display_Device::display_device()) {
+    f(x, y, w, h, c);
+    return;
+  }
+  int active = Fl::draw_box_active();
+  Fl_Box_Cache_Entry **head = box_cache_hash + box_cache_key(f, w, h, c);
+  Fl_Box_Cache_Entry *e;
+  for (e = *head; e; e = e->hnext) {
+    if (e->f == f && e->w == w && e->h == h && e->c == c &&
+        e->active == active && e->scale == s) break;
+  }
+  if (e) {
+    box_cache_unlink(e);
+  } else {
+    if (box_cache_count >= box_cache_max) box_cache_delete(box_cache_last);
+    e = new Fl_Box_Cache_Entry;
+    e->f = f; e->w = w; e->h = h; e->c = c;
+    e->active = active;
+    e->scale = s;
+    e->surf = new Fl_Image_Surface(w, h, 1);
+    e->hnext = *head;
+    *head = e;
+    box_cache_count++;
+    Fl_Surface_Device::push_current(e->surf);
+    f(0, 0, w, h, c);
+    Fl_Surface_Device::pop_current();
+  }
+  // move the entry to the front of the LRU list
+  e->prev = 0;
+  e->next = box_cache_first;
+  if (box_cache_first) box_cache_first->prev = e; else box_cache_last = e;
+  box_cache_first = e;
+  for (int i = 0; i < n; i++, rects += 4) {
+    if (rects[2] > 0 && rects[3] > 0)
+      fl_copy_offscreen(x + rects[0], y + rects[1], rects[2], rects[3],
+                        e->surf->offscreen(), rects[0], rects[1]);
+  }
+}
+
+/**
+  Deletes all box backgrounds in the box cache.
+
+  This is done automatically when the scheme is changed or a color of
+  the color map is set. Box types that draw their own background must
+  call this when their look changes otherwise.
+  \see Fl::box_cache_size(int)
+  \since 1.4.0
+*/
+void Fl::box_cache_flush() {
+  while (box_cache_last) box_cache_delete(box_cache_last);
+}
+
+/**
+  Sets the maximum number of box backgrounds kept by the box cache.
+
+  The "plastic", "gleam" and "gtk+" schemes keep the shaded backgrounds
+  of recently drawn boxes in offscreen buffers. The default is 100.
+  Setting 0 disables the cache.
+  \since 1.4.0
+*/
+void Fl::box_cache_size(int n) {
+  box_cache_max = n < 0 ? 0 : n;
+  while (box_cache_count > box_cache_max) box_cache_delete(box_cache_last);
+}
+
+/**
+  Gets the maximum number of box backgrounds kept by the box cache.
+  \see Fl::box_cache_size(int)
+  \since 1.4.0
+*/
+int Fl::box_cache_size() {
+  return box_cache_max;
+}
+
 /** Gets the current box drawing function for the specified box type. */
 Fl_Box_Draw_F *Fl::get_boxtype(Fl_Boxtype t) {
   return fl_box_table[t].f;
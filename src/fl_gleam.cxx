@@ -134,6 +134,36 @@ static void frame_rect_down(int x, int y, int w, int h, Fl_Color bc, Fl_Color lc
   frame_rect(x,y,w,h,fl_color_average(bc, FL_WHITE, th1), fl_color_average(FL_BLACK, bc, th2), lc);
 }
 
+// Shaded backgrounds of the box types, drawn through the box cache.
+
+extern void fl_cached_box(Fl_Box_Draw_F *f, int x, int y, int w, int h, Fl_Color c, int n, const int *rects);
+
+static void up_shade(int x, int y, int w, int h, Fl_Color c) {
+  shade_rect_top_bottom_up(x, y, w, h, c, .15f);
+}
+
+static void thin_up_shade(int x, int y, int w, int h, Fl_Color c) {
+  shade_rect_top_bottom_up(x, y, w, h, c, .25f);
+}
+
+static void down_shade(int x, int y, int w, int h, Fl_Color c) {
+  shade_rect_top_bottom_down(x, y, w, h, c, .65f);
+}
+
+static void thin_down_shade(int x, int y, int w, int h, Fl_Color c) {
+  shade_rect_top_bottom_down(x, y, w, h, c, .85f);
+}
+
+// shade_rect_top_bottom() fills the box inside the 2 pixel wide border
+static void cached_shade(Fl_Box_Draw_F *f, int x, int y, int w, int h, Fl_Color c) {
+  if (w > 4 && h > 4) {
+    const int r[4] = { 2, 2, w - 4, h - 4 };
+    fl_cached_box(f, x, y, w, h, c, 1, r);
+  } else {
+    f(x, y, w, h, c);
+  }
+}
+
 // Draw the different box types. These are the actual box drawing functions.
 
 static void up_frame(int x, int y, int w, int h, Fl_Color c) {
@@ -141,12 +171,12 @@ static void up_frame(int x, int y, int w, int h, Fl_Color c) {
 }
 
 static void up_box(int x, int y, int w, int h, Fl_Color c) {
-  shade_rect_top_bottom_up(x, y, w, h, c, .15f);
+  cached_shade(up_shade, x, y, w, h, c);
   frame_rect_up(x, y, w, h, c, fl_color_average(c, FL_WHITE, .05f), .15f, .05f);
 }
 
 static void thin_up_box(int x, int y, int w, int h, Fl_Color c) {
-  shade_rect_top_bottom_up(x, y, w, h, c, .25f);
+  cached_shade(thin_up_shade, x, y, w, h, c);
   frame_rect_up(x, y, w, h, c, fl_color_average(c, FL_WHITE, .45f), .25f, .15f);
 }
 
@@ -155,12 +185,12 @@ static void down_frame(int x, int y, int w, int h, Fl_Color c) {
 }
 
 static void down_box(int x, int y, int w, int h, Fl_Color c) {
-  shade_rect_top_bottom_down(x, y, w, h, c, .65f);
+  cached_shade(down_shade, x, y, w, h, c);
   frame_rect_down(x, y, w, h, c, fl_color_average(c, FL_BLACK, .05f), .05f, .95f);
 }
 
 static void thin_down_box(int x, int y, int w, int h, Fl_Color c) {
-  shade_rect_top_bottom_down(x, y, w, h, c, .85f);
+  cached_shade(thin_down_shade, x, y, w, h, c);
   frame_rect_down(x, y, w, h, c, fl_color_average(c, FL_BLACK, .45f), .35f, 0.85f);
 }
 
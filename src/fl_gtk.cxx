@@ -25,6 +25,7 @@
 #include <FL/fl_draw.H>
 
 extern void fl_internal_boxtype(Fl_Boxtype, Fl_Box_Draw_F*);
+extern void fl_cached_box(Fl_Box_Draw_F *f, int x, int y, int w, int h, Fl_Color c, int n, const int *rects);
 
 
 static void gtk_color(Fl_Color c) {
@@ -50,9 +51,9 @@ static void gtk_up_frame(int x, int y, int w, int h, Fl_Color c) {
 }
 
 
-static void gtk_up_box(int x, int y, int w, int h, Fl_Color c) {
-  gtk_up_frame(x, y, w, h, c);
-
+// Draws the shaded inside of gtk_up_box(). Covers all pixels of
+// x+2, y+2, w-4, h-3 and the right column x+w-2, y+2 ... y+h-3.
+static void gtk_up_shade(int x, int y, int w, int h, Fl_Color c) {
   gtk_color(fl_color_average(FL_WHITE, c, 0.4f));
   fl_xyline(x + 2, y + 2, x + w - 3);
   gtk_color(fl_color_average(FL_WHITE, c, 0.2f));
@@ -71,6 +72,18 @@ static void gtk_up_box(int x, int y, int w, int h, Fl_Color c) {
 }
 
 
+static void gtk_up_box(int x, int y, int w, int h, Fl_Color c) {
+  gtk_up_frame(x, y, w, h, c);
+
+  if (w > 4 && h > 8) {
+    const int r[8] = { 2, 2, w - 4, h - 3,  w - 2, 2, 1, h - 4 };
+    fl_cached_box(gtk_up_shade, x, y, w, h, c, 2, r);
+  } else {
+    gtk_up_shade(x, y, w, h, c);
+  }
+}
+
+
 static void gtk_down_frame(int x, int y, int w, int h, Fl_Color c) {
   gtk_color(fl_color_average(FL_BLACK, c, 0.5));
   fl_begin_loop();
@@ -113,9 +126,9 @@ static void gtk_thin_up_frame(int x, int y, int w, int h, Fl_Color c) {
 }
 
 
-static void gtk_thin_up_box(int x, int y, int w, int h, Fl_Color c) {
-  gtk_thin_up_frame(x, y, w, h, c);
-
+// Draws the shaded inside of gtk_thin_up_box(). Covers all pixels of
+// x+1, y+1, w-2, h-2.
+static void gtk_thin_up_shade(int x, int y, int w, int h, Fl_Color c) {
   gtk_color(fl_color_average(FL_WHITE, c, 0.4f));
   fl_xyline(x + 1, y + 1, x + w - 2);
   gtk_color(fl_color_average(FL_WHITE, c, 0.2f));
@@ -133,6 +146,18 @@ static void gtk_thin_up_box(int x, int y, int w, int h, Fl_Color c) {
 }
 
 
+static void gtk_thin_up_box(int x, int y, int w, int h, Fl_Color c) {
+  gtk_thin_up_frame(x, y, w, h, c);
+
+  if (w > 2 && h > 7) {
+    const int r[4] = { 1, 1, w - 2, h - 2 };
+    fl_cached_box(gtk_thin_up_shade, x, y, w, h, c, 1, r);
+  } else {
+    gtk_thin_up_shade(x, y, w, h, c);
+  }
+}
+
+
 static void gtk_thin_down_frame(int x, int y, int w, int h, Fl_Color c) {
   gtk_color(fl_color_average(FL_BLACK, c, 0.4f));
   fl_xyline(x + 1, y, x + w - 2);
@@ -268,6 +268,38 @@ static void shade_round(int x, int y, int w, int h, const char *c, Fl_Color bc)
 }
 
 
+extern void fl_cached_box(Fl_Box_Draw_F *f, int x, int y, int w, int h, Fl_Color c, int n, const int *rects);
+
+// Draws the background of a rectangular box, drawn by f with shade_rect()
+// at X, Y, W, H relative to the box, through the box cache. With horizontal
+// shading, and if the top and bottom lines don't overlap (all patterns have
+// at most 15 colors), shade_rect() covers all pixels of its area plus one
+// row below, except the two top corners.
+static void cached_shade_rect(Fl_Box_Draw_F *f, int x, int y, int w, int h, Fl_Color c,
+                              int X, int Y, int W, int H) {
+  if (H < (W * 2) && H > 14) {
+    const int r[8] = { X, Y + 1, W, H,  X + 1, Y, W - 2, 1 };
+    fl_cached_box(f, x, y, w, h, c, 2, r);
+  } else {
+    f(x, y, w, h, c);
+  }
+}
+
+#ifndef USE_OLD_PLASTIC_BOX
+static void up_shade(int x, int y, int w, int h, Fl_Color c) {
+  shade_rect(x + 1, y + 1, w - 2, h - 3, "RVQNOPQRSTUVWVQ", c);
+}
+
+static void thin_up_shade(int x, int y, int w, int h, Fl_Color c) {
+  shade_rect(x + 1, y + 1, w - 2, h - 3, "RQOQSUWQ", c);
+}
+#endif // !USE_OLD_PLASTIC_BOX
+
+static void down_shade(int x, int y, int w, int h, Fl_Color c) {
+  shade_rect(x + 2, y + 2, w - 4, h - 5, "STUVWWWVT", c);
+}
+
+
 static void up_frame(int x, int y, int w, int h, Fl_Color c) {
   frame_rect(x, y, w, h - 1, "KLDIIJLM", c);
 }
@@ -296,7 +328,7 @@ static void thin_up_box(int x, int y, int w, int h, Fl_Color c) {
   up_frame(x, y, w, h, c);
 #else
   if (w > 4 && h > 4) {
-    shade_rect(x + 1, y + 1, w - 2, h - 3, "RQOQSUWQ", c);
+    cached_shade_rect(thin_up_shade, x, y, w, h, c, 1, 1, w - 2, h - 3);
     frame_rect(x, y, w, h - 1, "IJLM", c);
   } else {
     narrow_thin_box(x, y, w, h, c);
@@ -311,7 +343,7 @@ static void up_box(int x, int y, int w, int h, Fl_Color c) {
   up_frame(x, y, w, h, c);
 #else
   if (w > 8 && h > 8) {
-    shade_rect(x + 1, y + 1, w - 2, h - 3, "RVQNOPQRSTUVWVQ", c);
+    cached_shade_rect(up_shade, x, y, w, h, c, 1, 1, w - 2, h - 3);
     frame_rect(x, y, w, h - 1, "IJLM", c);
   } else {
     thin_up_box(x, y, w, h, c);
@@ -333,7 +365,7 @@ static void down_frame(int x, int y, int w, int h, Fl_Color c) {
 
 static void down_box(int x, int y, int w, int h, Fl_Color c) {
   if (w > 6 && h > 6) {
-    shade_rect(x + 2, y + 2, w - 4, h - 5, "STUVWWWVT", c);
+    cached_shade_rect(down_shade, x, y, w, h, c, 2, 2, w - 4, h - 5);
     down_frame(x, y, w, h, c);
   }
   else {
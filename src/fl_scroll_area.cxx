@@ -19,6 +19,8 @@
 // into the drawing area.
 
 #include "Fl_Window_Driver.H"
+#include <FL/Fl_Window.H>
+#include <FL/Fl_Device.H>
 #include <FL/fl_draw.H>
 
 // scroll a rectangle and redraw the newly exposed portions:
@@ -80,3 +82,45 @@ void fl_scroll(int X, int Y, int W, int H, int dx, int dy,
   if (dx) draw_area(data, clip_x, dest_y, clip_w, src_h);
   if (dy) draw_area(data, X, clip_y, W, clip_h);
 }
+
+/**
+  Scroll a rectangle by copying its pixels, if this gives the right result.
+  Widgets that can always draw the whole rectangle use this instead of
+  fl_scroll() to draw only what scrolling exposes, and draw the whole
+  rectangle themselves if it returns 0.
+
+  The function does nothing and returns 0 when the moved pixels would not
+  be correct: when drawing doesn't go to a window of the display, at a
+  non-integral scale factor, when the rectangle is not entirely inside the
+  window and the current clip region, or when \p dx or \p dy move all
+  contents out of the rectangle. Otherwise it calls fl_scroll() and
+  returns 1.
+
+  Everything drawn inside the rectangle must move with the scrolled
+  contents: e.g. the background must be a plain color.
+  \param[in] X,Y       position of top-left of rectangle
+  \param[in] W,H       size of rectangle
+  \param[in] dx,dy     pixel offsets for shifting rectangle
+  \param[in] draw_area callback function to draw rectangular areas
+  \param[in] data      pointer to user data for callback
+  \return 1 if the rectangle was scrolled, 0 if the caller must draw it.
+  \see fl_scroll()
+  \version 1.4.0
+  */
+int fl_scroll_by_copy(int X, int Y, int W, int H, int dx, int dy,
+                      void (*draw_area)(void*, int,int,int,int), void* data)
+{
+  if (!dx && !dy) return 1;
+  if (dx <= -W || dx >= W || dy <= -H || dy >= H) return 0;
+  Fl_Window *win = Fl_Window::current();
+  if (!win || Fl_Surface_Device::surface() != Fl_Display_Device::display_device())
+    return 0;
+  float s = fl_graphics_driver->scale();
+  if (s != int(s)) return 0;
+  if (X < 0 || Y < 0 || X + W > win->w() || Y + H > win->h()) return 0;
+  int cx, cy, cw, ch;
+  if (fl_clip_box(X, Y, W, H, cx, cy, cw, ch) || fl_not_clipped(X, Y, W, H) == 2)
+    return 0;
+  fl_scroll(X, Y, W, H, dx, dy, draw_area, data);
+  return 1;
+}
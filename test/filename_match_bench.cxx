@@ -0,0 +1,120 @@
+//
+// Filename pattern matching benchmark for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 1998-2021 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+// Matches generated file names against a few typical patterns, first
+// with fl_filename_match(), which interprets the pattern for every name,
+// then with an Fl_Filename_Matcher of the same pattern, and prints the
+// time of one match for both. It also counts the names that match, which
+// must be the same for both.
+//
+//   usage: filename_match_bench [-names n] [pattern ...]
+//
+//     -names n    number of file names to match (default 1000000)
+//
+// Without patterns, a built-in list of extension lists and general
+// patterns is used.
+
+#include <FL/filename.H>
+#include <FL/Fl_Filename_Matcher.H>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#  include <windows.h>  // GetTickCount()
+#else
+#  include <sys/time.h> // gettimeofday()
+#endif
+
+static const char *default_patterns[] = {
+  "*",
+  "*.{cxx|H|h}",
+  "*.{bmp|bw|gif|jpg|jpeg|pbm|pgm|png|ppm|rgb|sgi|svg|xbm|xpm}",
+  "*.tar.gz",
+  "*test*",
+  "[a-m]*.{c|cxx|h}",
+  "f??????.*"
+};
+
+static const char *extensions[] = {
+  "cxx", "H", "h", "png", "txt", "o", "tar.gz", "JPG", "c", "fl"
+};
+
+static double now() {
+#ifdef _WIN32
+  return GetTickCount() / 1000.0;
+#else
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+#endif
+}
+
+int main(int argc, char **argv) {
+  int num_names = 1000000;
+  int i = 1;
+  if (i + 1 < argc && !strcmp(argv[i], "-names")) {
+    num_names = atoi(argv[i + 1]);
+    i += 2;
+  }
+  if (num_names < 1 || (i < argc && argv[i][0] == '-')) {
+    fprintf(stderr, "usage: %s [-names n] [pattern ...]\n", argv[0]);
+    return 1;
+  }
+  const char **patterns = default_patterns;
+  int num_patterns = sizeof(default_patterns) / sizeof(default_patterns[0]);
+  if (i < argc) {
+    patterns = (const char **)(argv + i);
+    num_patterns = argc - i;
+  }
+
+  // names like "f123456.cxx" and "test_0042.png"
+  const int num_ext = sizeof(extensions) / sizeof(extensions[0]);
+  char **names = (char **)malloc(num_names * sizeof(char *));
+  srand(1);
+  for (i = 0; i < num_names; i++) {
+    char s[40];
+    if (rand() % 8)
+      sprintf(s, "%c%06d.%s", 'a' + rand() % 26, rand() % 1000000, extensions[rand() % num_ext]);
+    else
+      sprintf(s, "test_%04d.%s", rand() % 10000, extensions[rand() % num_ext]);
+    names[i] = (char *)malloc(strlen(s) + 1);
+    strcpy(names[i], s);
+  }
+
+  int errors = 0;
+  printf("%d names, ns per match:\n", num_names);
+  for (int p = 0; p < num_patterns; p++) {
+    int count1 = 0, count2 = 0;
+    double t1 = now();
+    for (i = 0; i < num_names; i++)
+      if (fl_filename_match(names[i], patterns[p])) count1++;
+    t1 = now() - t1;
+    double t2 = now();
+    Fl_Filename_Matcher matcher(patterns[p]);
+    for (i = 0; i < num_names; i++)
+      if (matcher.match(names[i])) count2++;
+    t2 = now() - t2;
+    printf("  %-40s %8.1f -> %6.1f  (%d matches)%s\n", patterns[p],
+           t1 * 1e9 / num_names, t2 * 1e9 / num_names, count1,
+           count1 == count2 ? "" : " MISMATCH");
+    if (count1 != count2) errors++;
+  }
+
+  for (i = 0; i < num_names; i++)
+    free(names[i]);
+  free(names);
+  return errors ? 1 : 0;
+}
@@ -0,0 +1,104 @@
+//
+// X11 image converter test program for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 1998-2021 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+// Compares the SSE2/SSSE3 image converters of the Xlib graphics driver
+// with their scalar versions for every line width modulo 16, every
+// alignment of the source data and every supported pixel size ("delta").
+// It doesn't need an X server and prints one line per converter.
+//
+//   usage: image_converters
+//
+// Each source line is allocated with exactly its size, so that reads
+// past its end are reported when built with -fsanitize=address.
+// The exit status is 1 if any output differs.
+
+#include <config.h>
+#include "../src/drivers/Xlib/Fl_Xlib_Image_Converters.H"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if FL_XLIB_SIMD_CONVERTERS
+
+typedef void (*Converter)(const uchar *from, uchar *to, int w, int delta);
+
+static const int max_width = 64;   // 4 times all widths modulo 16
+static const int guard = 16;       // bytes after the line that must not change
+
+static unsigned seed = 1;
+static uchar random_byte() {
+  seed = seed * 1103515245 + 12345;
+  return uchar(seed >> 16);
+}
+
+// Returns the number of (width, alignment) cases that differ.
+static int compare(const char *name, Converter simd, Converter scalar, int delta) {
+  int errors = 0;
+  for (int w = 0; w <= max_width; w++) {
+    for (int align = 0; align < 16; align++) {
+      int n = align + w * delta;
+      uchar *src = (uchar*)malloc(n ? n : 1);
+      for (int i = 0; i < n; i++) src[i] = random_byte();
+      // the driver writes to 8 byte aligned X image lines
+      STORETYPE out1[(4 * max_width + guard) / sizeof(STORETYPE)];
+      STORETYPE out2[(4 * max_width + guard) / sizeof(STORETYPE)];
+      memset(out1, 0xA5, sizeof(out1));
+      memset(out2, 0xA5, sizeof(out2));
+      simd(src + align, (uchar*)out1, w, delta);
+      scalar(src + align, (uchar*)out2, w, delta);
+      if (memcmp(out1, out2, 4 * w + guard)) {
+        if (!errors) printf("%s: delta %d width %d alignment %d differs\n", name, delta, w, align);
+        errors++;
+      }
+      free(src);
+    }
+  }
+  return errors;
+}
+
+static int test(const char *name, Converter simd, Converter scalar, int d1, int d2 = 0) {
+  int errors = compare(name, simd, scalar, d1);
+  if (d2) errors += compare(name, simd, scalar, d2);
+  printf("%-28s %s (%d differences)\n", name, errors ? "FAILED" : "ok", errors);
+  return errors;
+}
+
+int main() {
+  int errors = 0;
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2")) {
+    errors += test("xrrr_converter_sse2", xrrr_converter_sse2, xrrr_converter, 1, 2);
+    errors += test("argb_premul_converter_sse2", argb_premul_converter_sse2, argb_premul_converter, 4);
+  } else {
+    printf("SSE2 is not supported by this CPU\n");
+  }
+  if (__builtin_cpu_supports("ssse3")) {
+    errors += test("xrgb_converter_ssse3", xrgb_converter_ssse3, xrgb_converter, 3, 4);
+    errors += test("xbgr_converter_ssse3", xbgr_converter_ssse3, xbgr_converter, 3, 4);
+  } else {
+    printf("SSSE3 is not supported by this CPU\n");
+  }
+  return errors ? 1 : 0;
+}
+
+#else
+
+int main() {
+  printf("The image converters have no vectorized version on this platform.\n");
+  return 0;
+}
+
+#endif // FL_XLIB_SIMD_CONVERTERS
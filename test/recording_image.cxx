@@ -0,0 +1,180 @@
+//
+// Fl_Recording_Surface::image() test program for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 1998-2021 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+// Records text in several fonts, sizes and angles, lines, arcs, polygons
+// and clipped drawings, then draws the recording into images with
+// Fl_Recording_Surface::image(). For each tile size, the images drawn by
+// 2, 4, 8 and one thread per processor must be identical to the image
+// drawn by one thread. Without Pango, image() draws with an
+// Fl_Image_Surface, and its image must also be identical to drawing the
+// same graphics directly into an Fl_Image_Surface.
+//
+//   usage: recording_image [-time]
+//
+//     -time   also print the time taken by each image
+//
+// The exit status is 1 if any image differs. The program needs a display
+// to measure text and to create image surfaces.
+
+#include <config.h>
+#include <FL/Fl.H>
+#include <FL/Fl_Recording_Surface.H>
+#include <FL/Fl_Image_Surface.H>
+#include <FL/Fl_Image.H>
+#include <FL/fl_draw.H>
+#include <FL/platform.H> // fl_open_display()
+#include <stdio.h>
+#include <string.h>
+#ifdef _WIN32
+#  include <windows.h>  // GetTickCount()
+#else
+#  include <sys/time.h> // gettimeofday()
+#endif
+
+static const int W = 900, H = 700;
+
+static double now() {
+#ifdef _WIN32
+  return GetTickCount() / 1000.0;
+#else
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+#endif
+}
+
+// Draws the test graphics on the current surface
+static void draw_scene() {
+  int i;
+  fl_color(FL_WHITE);
+  fl_rectf(0, 0, W, H);
+  // text in the standard fonts and several sizes, across tile borders
+  for (i = 0; i < 16; i++) {
+    fl_color((Fl_Color)(FL_BLACK + i * 3));
+    fl_font((Fl_Font)i, 8 + i * 2);
+    fl_draw("The quick brown fox jumps over the lazy dog 0123456789", 5, 20 + i * 27);
+  }
+  fl_font(FL_HELVETICA, 18);
+  fl_color(FL_DARK_BLUE);
+  fl_draw("UTF-8: \xc3\xa9t\xc3\xa9, \xce\xb1\xce\xb2\xce\xb3, \xe2\x82\xac", 5, 470);
+  fl_rtl_draw("right to left", 13, 600, 500);
+  // rotated text around one point
+  for (i = 0; i < 360; i += 30) {
+    fl_color((Fl_Color)(FL_RED + i / 30));
+    fl_draw(i, "rotated text", 760, 150);
+  }
+  // lines of several widths and styles
+  for (i = 0; i < 8; i++) {
+    fl_color((Fl_Color)(FL_GREEN + i));
+    fl_line_style(i % 4 == 0 ? FL_SOLID : i % 4 == 1 ? FL_DASH : i % 4 == 2 ? FL_DOT : FL_DASHDOT, i);
+    fl_line(620, 300 + i * 12, 890, 260 + i * 20);
+  }
+  fl_line_style(0);
+  // arcs, pies and polygons
+  fl_color(FL_MAGENTA);
+  fl_arc(620, 450, 120, 90, 10, 300);
+  fl_pie(750, 450, 120, 120, 45, 270);
+  fl_color(FL_CYAN);
+  fl_polygon(620, 690, 700, 560, 780, 690);
+  fl_begin_complex_polygon();
+  fl_vertex(800, 560); fl_vertex(890, 600); fl_vertex(820, 690);
+  fl_gap();
+  fl_vertex(820, 600); fl_vertex(850, 610); fl_vertex(830, 640);
+  fl_end_complex_polygon();
+  // clipped drawings
+  for (i = 0; i < 10; i++) {
+    int x = 10 + i * 58, y = 520;
+    fl_push_clip(x, y, 50, 40 + i * 10);
+    fl_color((Fl_Color)(FL_YELLOW + i));
+    fl_pie(x - 20, y - 20, 90, 90, 0, 360);
+    fl_color(FL_BLACK);
+    fl_font(FL_TIMES_BOLD, 14);
+    fl_draw("clipped text", x - 10, y + 30);
+    fl_pop_clip();
+  }
+}
+
+// Compares two images and prints the result
+static int compare(Fl_RGB_Image *img, Fl_RGB_Image *ref, const char *what, double t, int timing) {
+  int diff = 0;
+  if (!img || !ref || img->w() != ref->w() || img->h() != ref->h() || img->d() != ref->d())
+    diff = -1;
+  else {
+    const uchar *a = img->array, *b = ref->array;
+    for (int i = 0; i < img->w() * img->h() * img->d(); i++)
+      if (a[i] != b[i]) diff++;
+  }
+  if (timing) printf("%-36s %8.3f s  ", what, t);
+  else printf("%-36s ", what);
+  if (diff < 0) printf("FAILED (no image or wrong size)\n");
+  else if (diff) printf("FAILED (%d bytes differ)\n", diff);
+  else printf("identical\n");
+  return diff != 0;
+}
+
+int main(int argc, char **argv) {
+  int timing = (argc > 1 && !strcmp(argv[1], "-time"));
+  if (argc > 2 || (argc == 2 && !timing)) {
+    fprintf(stderr, "usage: %s [-time]\n", argv[0]);
+    return 1;
+  }
+  fl_open_display();
+  Fl_Recording_Surface *rec = new Fl_Recording_Surface(W, H);
+  Fl_Surface_Device::push_current(rec);
+  draw_scene();
+  Fl_Surface_Device::pop_current();
+  printf("recording of %dx%d pixels, %d bytes\n", W, H, rec->size());
+
+  int errors = 0;
+  char what[80];
+  static const int tiles[] = { 64, 100, 256, 1000 };
+  static const int threads[] = { 2, 4, 8, 0 };
+  for (unsigned s = 0; s < sizeof(tiles) / sizeof(tiles[0]); s++) {
+    double t = now();
+    Fl_RGB_Image *ref = rec->image(1, tiles[s]);
+    t = now() - t;
+    sprintf(what, "tile %d, 1 thread", tiles[s]);
+    if (timing) printf("%-36s %8.3f s\n", what, t);
+    for (unsigned n = 0; n < sizeof(threads) / sizeof(threads[0]); n++) {
+      t = now();
+      Fl_RGB_Image *img = rec->image(threads[n], tiles[s]);
+      t = now() - t;
+      if (threads[n]) sprintf(what, "tile %d, %d threads", tiles[s], threads[n]);
+      else sprintf(what, "tile %d, a thread per processor", tiles[s]);
+      errors += compare(img, ref, what, t, timing);
+      delete img;
+    }
+    delete ref;
+  }
+
+#if !USE_PANGO
+  // image() replays the recording into an Fl_Image_Surface
+  Fl_Image_Surface *surf = new Fl_Image_Surface(W, H);
+  Fl_Surface_Device::push_current(surf);
+  draw_scene();
+  Fl_RGB_Image *direct = surf->image();
+  Fl_Surface_Device::pop_current();
+  delete surf;
+  Fl_RGB_Image *img = rec->image();
+  errors += compare(img, direct, "recording vs. direct drawing", 0, 0);
+  delete img;
+  delete direct;
+#endif
+
+  delete rec;
+  printf("%s\n", errors ? "FAILED" : "ok");
+  return errors ? 1 : 0;
+}
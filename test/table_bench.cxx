@@ -0,0 +1,141 @@
+//
+// Fl_Table drawing benchmark for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 1998-2021 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+// Redraws a table of 200 rows and 50 columns and prints the average
+// time of a frame. Each cell is drawn as a filled rectangle with grid
+// lines, so the frame time mostly depends on how fast the graphics
+// driver draws many small rectangles and lines.
+//
+//   usage: table_bench [-text] [-frames n] [fltk options]
+//
+//     -text       also draw the row and column number in each cell
+//     -frames n   number of frames to draw (default 200)
+//
+// The program exits when all frames are drawn, e.g. to run it on Xvfb:
+//
+//   xvfb-run ./table_bench -frames 500
+
+#include <FL/Fl.H>
+#include <FL/Fl_Double_Window.H>
+#include <FL/Fl_Table.H>
+#include <FL/fl_draw.H>
+#include <FL/platform.H>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#  include <sys/time.h> // gettimeofday()
+#endif
+
+static int draw_text = 0;
+static int frames = 200;
+
+class BenchTable : public Fl_Table {
+protected:
+  void draw_cell(TableContext context, int R, int C, int X, int Y, int W, int H) {
+    char s[20];
+    switch (context) {
+      case CONTEXT_STARTPAGE:
+        fl_font(FL_HELVETICA, 10);
+        return;
+      case CONTEXT_COL_HEADER:
+      case CONTEXT_ROW_HEADER:
+        fl_color(FL_LIGHT2);
+        fl_rectf(X, Y, W, H);
+        fl_color(FL_DARK3);
+        fl_xyline(X, Y + H - 1, X + W - 1);
+        fl_yxline(X + W - 1, Y, Y + H - 1);
+        return;
+      case CONTEXT_CELL:
+        fl_color((R + C) % 7 ? FL_WHITE : FL_YELLOW);
+        fl_rectf(X, Y, W, H);
+        fl_color(FL_GRAY);
+        fl_xyline(X, Y + H - 1, X + W - 1);
+        fl_yxline(X + W - 1, Y, Y + H - 1);
+        if (draw_text) {
+          sprintf(s, "%d,%d", R, C);
+          fl_color(FL_BLACK);
+          fl_draw(s, X + 2, Y + H - 3);
+        }
+        return;
+      default:
+        return;
+    }
+  }
+public:
+  BenchTable(int X, int Y, int W, int H) : Fl_Table(X, Y, W, H) {
+    rows(200);
+    cols(50);
+    row_height_all(12);
+    col_width_all(24);
+    row_header(1);
+    col_header(1);
+    end();
+  }
+};
+
+static double now() {
+#ifdef _WIN32
+  return GetTickCount() / 1000.0;
+#else
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+#endif
+}
+
+static int arg(int argc, char **argv, int &i) {
+  if (!strcmp(argv[i], "-text")) { draw_text = 1; i++; return 1; }
+  if (!strcmp(argv[i], "-frames") && i + 1 < argc) {
+    frames = atoi(argv[i + 1]);
+    i += 2;
+    return 2;
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  int i = 1;
+  if (!Fl::args(argc, argv, i, arg) || i < argc || frames < 1) {
+    fprintf(stderr, "usage: %s [-text] [-frames n] [fltk options]\n", argv[0]);
+    return 1;
+  }
+  Fl_Double_Window win(1230, 1000, "table_bench");
+  BenchTable table(0, 0, win.w(), win.h());
+  win.resizable(table);
+  win.end();
+  win.show(argc, argv);
+  win.wait_for_expose();
+  Fl::flush();
+
+  double total = 0, best = 1e9;
+  for (int f = 0; f < frames && win.shown(); f++) {
+    double t = now();
+    table.redraw();
+    Fl::flush();
+#if USE_X11
+    XSync(fl_display, False); // include the time the X server needs
+#endif
+    t = now() - t;
+    total += t;
+    if (t < best) best = t;
+    Fl::check();
+  }
+  printf("%d frames of %dx%d cells%s: %.3f ms/frame, best %.3f ms\n",
+         frames, table.rows(), table.cols(), draw_text ? " with text" : "",
+         total * 1000 / frames, best * 1000);
+  return 0;
+}
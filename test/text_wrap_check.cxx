@@ -0,0 +1,164 @@
+//
+// Fl_Text_Display wrapped line count test for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 1998-2021 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+// In continuous wrap mode, Fl_Text_Display counts again only the lines
+// changed by a buffer modification. This program makes random insertions,
+// deletions and replacements, appends lines and removes them from the
+// start of the buffer like Fl_Simple_Terminal. After each modification, it
+// compares the number of wrapped lines, the top line number and the first
+// character shown with those of a second display of the same buffer that
+// counts all lines again. It draws with Fl_Headless_Surface and needs no
+// display.
+//
+//   usage: text_wrap_check [-n modifications] [-seed n]
+//
+// The exit status is 1 if any count differs.
+
+#include <FL/Fl.H>
+#include <FL/Fl_Window.H>
+#include <FL/Fl_Text_Display.H>
+#include <FL/Fl_Text_Buffer.H>
+#include <FL/Fl_Headless_Surface.H>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Gives access to the line counts of the display
+class CheckedDisplay : public Fl_Text_Display {
+public:
+  CheckedDisplay(int X, int Y, int W, int H) : Fl_Text_Display(X, Y, W, H) {}
+  // Makes the display count all wrapped lines again at the next modification
+  void forget_counts() { mWrapCountWidth = -1; }
+  // Returns 0 if the counts are those of the reference display, else prints them
+  int check(CheckedDisplay *ref, int step, const char *what) {
+    if (mNBufferLines == ref->mNBufferLines && mTopLineNum == ref->mTopLineNum &&
+        mFirstChar == ref->mFirstChar)
+      return 0;
+    printf("step %d (%s): %d wrapped lines, top line %d at %d; full recount: %d, %d at %d\n",
+           step, what, mNBufferLines, mTopLineNum, mFirstChar,
+           ref->mNBufferLines, ref->mTopLineNum, ref->mFirstChar);
+    return 1;
+  }
+};
+
+static const char *words[] = {
+  "a", "wrap", "counting", "\n", "text ", "display", "\xc3\xa9t\xc3\xa9", // UTF-8
+  "very_long_word_that_needs_more_than_one_line_to_be_shown_completely",
+  "\n\n", "  ", "last"
+};
+
+static void random_text(char *s, int max) {
+  int n = rand() % 12, len = 0;
+  s[0] = 0;
+  for (int i = 0; i < n; i++) {
+    const char *w = words[rand() % (sizeof(words) / sizeof(words[0]))];
+    if (len + (int)strlen(w) + 1 >= max) break;
+    strcat(s, w);
+    strcat(s, " ");
+    len = (int)strlen(s);
+  }
+}
+
+// Returns a random position at the start of a UTF-8 character
+static int random_pos(Fl_Text_Buffer *buf) {
+  int len = buf->length();
+  return len ? buf->utf8_align(rand() % (len + 1)) : 0;
+}
+
+int main(int argc, char **argv) {
+  int steps = 5000;
+  unsigned seed = 1;
+  for (int i = 1; i < argc - 1; i += 2) {
+    if (!strcmp(argv[i], "-n")) steps = atoi(argv[i + 1]);
+    else if (!strcmp(argv[i], "-seed")) seed = (unsigned)atoi(argv[i + 1]);
+  }
+  srand(seed);
+
+  // all text is measured by the headless surface
+  Fl_Headless_Surface *surface = new Fl_Headless_Surface(800, 200);
+  Fl_Surface_Device::push_current(surface);
+  Fl_Window *win = new Fl_Window(500, 200);
+  CheckedDisplay *disp = new CheckedDisplay(0, 0, 250, 200);
+  CheckedDisplay *ref = new CheckedDisplay(250, 0, 250, 200);
+  win->end();
+  Fl_Text_Buffer *buf = new Fl_Text_Buffer();
+  disp->buffer(buf);
+  ref->buffer(buf);
+  disp->wrap_mode(Fl_Text_Display::WRAP_AT_BOUNDS, 0);
+  ref->wrap_mode(Fl_Text_Display::WRAP_AT_BOUNDS, 0);
+  surface->draw_window(win);
+
+  int errors = 0;
+  char text[200];
+  for (int step = 0; step < steps && errors < 10; step++) {
+    const char *what;
+    int pos = random_pos(buf);
+    ref->forget_counts();
+    switch (rand() % 6) {
+      case 0: // type at a random position
+        random_text(text, sizeof(text));
+        buf->insert(pos, text);
+        what = "insert";
+        break;
+      case 1: { // delete a random range
+        int end = buf->utf8_align(pos + rand() % 80);
+        if (end > buf->length()) end = buf->length();
+        buf->remove(pos, end);
+        what = "remove";
+        break;
+      }
+      case 2: { // replace a random range
+        int end = buf->utf8_align(pos + rand() % 40);
+        if (end > buf->length()) end = buf->length();
+        random_text(text, sizeof(text));
+        buf->replace(pos, end, text);
+        what = "replace";
+        break;
+      }
+      case 3: // append like a log console
+        random_text(text, sizeof(text) - 1);
+        strcat(text, "\n");
+        buf->append(text);
+        what = "append";
+        break;
+      case 4: { // remove the first lines like a log console
+        int end = buf->skip_lines(0, 1 + rand() % 3);
+        buf->remove(0, end);
+        what = "remove lines";
+        break;
+      }
+      default: { // scroll
+        int line = 1 + rand() % 100;
+        disp->scroll(line, 0);
+        ref->scroll(line, 0);
+        what = "scroll";
+        break;
+      }
+    }
+    errors += disp->check(ref, step, what);
+    if (step % 500 == 499) {
+      // also change the width now and then
+      int w = 100 + rand() % 300;
+      disp->size(w, 200);
+      ref->size(w, 200);
+      errors += disp->check(ref, step, "resize");
+    }
+  }
+  Fl_Surface_Device::pop_current();
+  printf("%d modifications, buffer of %d bytes: %s\n", steps, buf->length(),
+         errors ? "FAILED" : "ok");
+  return errors ? 1 : 0;
+}
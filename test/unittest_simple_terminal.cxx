@@ -16,6 +16,7 @@
 
 #include <time.h>
 #include <FL/Fl_Group.H>
+#include <FL/Fl_Button.H>
 #include <FL/Fl_Simple_Terminal.H>
 
 //
@@ -69,6 +70,28 @@ class SimpleTerminal : public Fl_Group {
     tty->printf("The time and date is now: %s", ctime(&lt));
     Fl::repeat_timeout(3.0, DateTimer_CB, data);
   }
+  // Append lines with a small and a large history: the time per line
+  // should not depend on the number of lines kept in the history
+  static double AppendLines(Fl_Simple_Terminal *tty, int history, int count) {
+    tty->history_lines(history);
+    clock_t t = clock();
+    for (int i = 0; i < count; i++)
+      tty->printf("Line %d of the speed test with a history of %d lines\n", i, history);
+    Fl::check();
+    return double(clock() - t) / CLOCKS_PER_SEC;
+  }
+  static void SpeedTest_CB(Fl_Widget*, void *data) {
+    Fl_Simple_Terminal *tty = (Fl_Simple_Terminal*)data;
+    int history = tty->history_lines();
+    const int count = 40000;
+    double t1 = AppendLines(tty, 1000, count);
+    double t2 = AppendLines(tty, 20000, count);
+    tty->history_lines(history);
+    tty->clear();
+    tty->printf("Appended %d lines: %.0f lines/sec with a history of 1000 lines,"
+                " %.0f lines/sec with 20000 lines\n", count,
+                t1 > 0 ? count / t1 : 0.0, t2 > 0 ? count / t2 : 0.0);
+  }
 public:
   static Fl_Widget *create() {
     return new SimpleTerminal(TESTAREA_X, TESTAREA_Y, TESTAREA_W, TESTAREA_H);
@@ -97,6 +120,9 @@ public:
     tty1 = new Fl_Simple_Terminal(x, tty_y1, w, tty_h,"Tty 1: ANSI off");
     tty1->ansi(false);
     Fl::add_timeout(0.5, DateTimer_CB, (void*)tty1);
+    Fl_Button *speed = new Fl_Button(x+w-100, y, 100, 18, "Speed test");
+    speed->labelsize(12);
+    speed->callback(SpeedTest_CB, (void*)tty1);
 
     // TTY2
     tty2 = new Fl_Simple_Terminal(x, tty_y2, w, tty_h,"Tty 2: ANSI on");